@@ -0,0 +1,158 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+// A* search time on large synthetic roadmaps: a random tree grown in the
+// free space of a robot without obstacles, densified by edges to the k
+// nearest neighbors of each node.
+
+#include <algorithm>
+#include <vector>
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/straight-path.hh>
+#include <hpp/core/weighed-distance.hh>
+#include "../src/astar.hh"
+#include "../src/basic-configuration-shooter.hh"
+#include "../src/random-generator.cc"
+#include "../src/node.cc"
+#include "../src/k-d-tree.cc"
+#include "../src/roadmap.cc"
+#include "../src/path.cc"
+#include "../src/path-vector.cc"
+#include "../src/straight-path.cc"
+#include "../src/constraint.cc"
+#include "../src/constraint-set.cc"
+#include "../src/config-projector.cc"
+#include "../src/weighed-distance.cc"
+#include "../src/statistics.cc"
+#include "benchmark.hh"
+
+using namespace hpp::core;
+using namespace hpp::core::benchmark;
+
+const std::size_t nbQueries = 20;
+const std::size_t k = 6;
+
+bool connected (const NodePtr_t& n1, const NodePtr_t& n2)
+{
+  const Edges_t& edges = n1->outEdges ();
+  for (Edges_t::const_iterator it = edges.begin (); it != edges.end ();
+       ++it) {
+    if ((*it)->to () == n2) return true;
+  }
+  return false;
+}
+
+void addEdges (const RoadmapPtr_t& roadmap, const DevicePtr_t& robot,
+	       const DistancePtr_t& distance, const NodePtr_t& n1,
+	       const NodePtr_t& n2)
+{
+  const Configuration_t& q1 = *(n1->configuration ());
+  const Configuration_t& q2 = *(n2->configuration ());
+  value_type d = (*distance) (q1, q2);
+  roadmap->addEdges (n1, n2, StraightPath::create (robot, q1, q2, d));
+}
+
+RoadmapPtr_t createRoadmap (const DevicePtr_t& robot,
+			    const DistancePtr_t& distance,
+			    std::size_t nbNodes)
+{
+  RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
+  BasicConfigurationShooter shooter (robot, RandomGenerator::create (seed));
+  roadmap->initNode (shooter.shoot ());
+  while (roadmap->nodes ().size () < nbNodes) {
+    ConfigurationPtr_t q = shooter.shoot ();
+    value_type d;
+    NodePtr_t near = roadmap->nearestNode (q, d);
+    PathPtr_t path = StraightPath::create (robot, *(near->configuration ()),
+					   *q, d);
+    roadmap->addNodeAndEdge (near, q, path);
+  }
+  // Copy the list of nodes since the roadmap is modified
+  std::vector <NodePtr_t> nodes (roadmap->nodes ().begin (),
+				 roadmap->nodes ().end ());
+  Nodes_t neighbors;
+  for (std::size_t i=0; i<nodes.size (); ++i) {
+    roadmap->nearestNodes (nodes [i]->configuration (),
+			   nodes [i]->connectedComponent (), k + 1,
+			   neighbors);
+    for (Nodes_t::const_iterator it = neighbors.begin ();
+	 it != neighbors.end (); ++it) {
+      if (*it != nodes [i] && !connected (nodes [i], *it)) {
+	addEdges (roadmap, robot, distance, nodes [i], *it);
+      }
+    }
+  }
+  return roadmap;
+}
+
+std::size_t randomIndex (const RandomGeneratorPtr_t& generator,
+			 std::size_t size)
+{
+  return std::min ((std::size_t) (generator->uniform () * size), size - 1);
+}
+
+void run (size_type dimension, std::size_t nbNodes)
+{
+  DevicePtr_t robot = createRobot (dimension);
+  DistancePtr_t distance = WeighedDistance::create (robot);
+  uint64_t start = Statistics::now ();
+  RoadmapPtr_t roadmap = createRoadmap (robot, distance, nbNodes);
+  Report ("Roadmap.build") ("dimension", dimension) ("nodes", nbNodes)
+    ("edges", roadmap->edges ().size ())
+    .print (nbNodes, Statistics::now () - start);
+
+  std::vector <NodePtr_t> nodes (roadmap->nodes ().begin (),
+				 roadmap->nodes ().end ());
+  RandomGeneratorPtr_t generator = RandomGenerator::create (seed);
+  uint64_t elapsed = 0;
+  std::size_t nbEdges = 0;
+  for (std::size_t i=0; i<nbQueries; ++i) {
+    NodePtr_t init = nodes [randomIndex (generator, nbNodes)];
+    NodePtr_t goal = nodes [randomIndex (generator, nbNodes)];
+    roadmap->initNode (init->configuration ());
+    roadmap->resetGoalNodes ();
+    roadmap->addGoalNode (goal->configuration ());
+    Astar::Edges_t edges;
+    start = Statistics::now ();
+    Astar (roadmap, distance).edges (edges);
+    elapsed += Statistics::now () - start;
+    nbEdges += edges.size ();
+  }
+  Report ("Astar.edges") ("dimension", dimension) ("nodes", nbNodes)
+    ("edges", roadmap->edges ().size ())
+    ("pathEdges", (double) nbEdges / nbQueries).print (nbQueries, elapsed);
+}
+
+int main ()
+{
+  run (3, 1000);
+  run (3, 10000);
+  run (3, 100000);
+  // Building the roadmap dominates in higher dimension
+  run (6, 1000);
+  run (6, 10000);
+  return 0;
+}
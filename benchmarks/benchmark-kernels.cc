@@ -0,0 +1,295 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+// Throughput of the kernels called in the inner loops of path planning:
+// sampling of configurations, distance between configurations, projection on constraints, evaluation
+// of constrained paths and path vectors and validation of paths by discretization.
+
+#include <cstdlib>
+#include <vector>
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/differentiable-function.hh>
+#include <hpp/core/discretized-collision-checking.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/straight-path.hh>
+#include <hpp/core/weighed-distance.hh>
+#include "../src/basic-configuration-shooter.hh"
+#include "../src/random-generator.cc"
+#include "../src/path.cc"
+#include "../src/path-vector.cc"
+#include "../src/straight-path.cc"
+#include "../src/constraint.cc"
+#include "../src/constraint-set.cc"
+#include "../src/config-projector.cc"
+#include "../src/weighed-distance.cc"
+#include "../src/discretized-collision-checking.cc"
+#include "../src/statistics.cc"
+#include "benchmark.hh"
+
+using namespace hpp::core;
+using namespace hpp::core::benchmark;
+
+// f (q) = A q + .1 sin (q_{0..m-1}) - b with random A and b
+class Function : public DifferentiableFunction
+{
+public:
+  Function (size_type nbDofs, size_type nbRows) :
+    DifferentiableFunction (nbDofs, nbDofs, nbRows, "function"),
+    A_ (matrix_t::Random (nbRows, nbDofs)), b_ (vector_t::Random (nbRows))
+  {
+    threadSafe (true);
+  }
+protected:
+  virtual void impl_compute (vectorOut_t result,
+			     ConfigurationIn_t argument) const
+  {
+    size_type m = outputSize ();
+    result = A_ * argument - b_;
+    result.array () += .1 * argument.head (m).array ().sin ();
+  }
+  virtual void impl_jacobian (matrixOut_t jacobian,
+			      ConfigurationIn_t argument) const
+  {
+    size_type m = outputSize ();
+    jacobian = A_;
+    jacobian.leftCols (m).diagonal ().array () +=
+      .1 * argument.head (m).array ().cos ();
+  }
+private:
+  matrix_t A_;
+  vector_t b_;
+}; // class Function
+
+std::vector <ConfigurationPtr_t> shoot (const DevicePtr_t& robot,
+					std::size_t nbConfigs)
+{
+  BasicConfigurationShooter shooter (robot, RandomGenerator::create (seed));
+  std::vector <ConfigurationPtr_t> configs;
+  for (std::size_t i=0; i<nbConfigs; ++i) {
+    configs.push_back (shooter.shoot ());
+  }
+  return configs;
+}
+
+// Shoot configurations of a robot with an SO3 joint one by one, in a
+// vector, or in the columns of a matrix.
+void shooting (size_type dimension)
+{
+  const size_type nbConfigs = 100000;
+  DevicePtr_t robot = createRobot (dimension);
+  robot->registerJoint (new JointSO3 (Transform3f ()));
+  BasicConfigurationShooter shooter (robot, RandomGenerator::create (seed));
+  Configuration_t q (robot->configSize ());
+  matrix_t configs (robot->configSize (), nbConfigs);
+  uint64_t start = Statistics::now ();
+  for (size_type i=0; i<nbConfigs; ++i) shooter.shoot ();
+  Report ("BasicConfigurationShooter.shoot") ("dimension", dimension)
+    .print (nbConfigs, Statistics::now () - start);
+  start = Statistics::now ();
+  for (size_type i=0; i<nbConfigs; ++i) shooter.shoot (q);
+  Report ("BasicConfigurationShooter.shootVector") ("dimension", dimension)
+    .print (nbConfigs, Statistics::now () - start);
+  start = Statistics::now ();
+  shooter.shootBatch (configs);
+  Report ("BasicConfigurationShooter.shootBatch") ("dimension", dimension)
+    .print (nbConfigs, Statistics::now () - start);
+}
+
+void distance (size_type dimension)
+{
+  const std::size_t nbConfigs = 1000, nbCalls = 1000000;
+  DevicePtr_t robot = createRobot (dimension);
+  WeighedDistancePtr_t distance = WeighedDistance::create (robot);
+  std::vector <ConfigurationPtr_t> configs = shoot (robot, nbConfigs);
+  value_type sum = 0;
+  uint64_t start = Statistics::now ();
+  for (std::size_t i=0; i<nbCalls; ++i) {
+    sum += (*distance) (*configs [i % nbConfigs],
+			*configs [(i + 1 + i / nbConfigs) % nbConfigs]);
+  }
+  uint64_t elapsed = Statistics::now () - start;
+  Report ("WeighedDistance") ("dimension", dimension) ("sum", sum)
+    .print (nbCalls, elapsed);
+}
+
+void projection (size_type dimension, size_type nbRows,
+		 ConfigProjector::LinearSolver_t solver, const char* name,
+		 ConfigProjector::Algorithm_t algorithm =
+		 ConfigProjector::NEWTON_RAPHSON,
+		 const char* algorithmName = "NEWTON_RAPHSON")
+{
+  const std::size_t nbConfigs = 1000;
+  DevicePtr_t robot = createRobot (dimension);
+  srand (seed);
+  DifferentiableFunctionPtr_t f (new Function (dimension, nbRows));
+  ConfigProjectorPtr_t projector =
+    ConfigProjector::create (robot, "projector", 1e-6, 40);
+  projector->addConstraint (f);
+  projector->linearSolver (solver);
+  projector->algorithm (algorithm);
+  std::vector <ConfigurationPtr_t> configs = shoot (robot, nbConfigs);
+  std::size_t nbSuccesses = 0;
+  std::size_t iterations = projector->numberIterations ();
+  uint64_t start = Statistics::now ();
+  for (std::size_t i=0; i<nbConfigs; ++i) {
+    if (projector->apply (*configs [i])) ++nbSuccesses;
+  }
+  uint64_t elapsed = Statistics::now () - start;
+  Report ("ConfigProjector.apply") ("dimension", dimension)
+    ("rows", nbRows) ("solver", name) ("algorithm", algorithmName)
+    ("successes", nbSuccesses)
+    ("newtonIterations", (double) (projector->numberIterations () -
+				   iterations) / nbConfigs)
+    .print (nbConfigs, elapsed);
+}
+
+// Evaluate a path vector of straight paths at increasing parameters, by
+// searching the sub-path at each evaluation or with an iterator.
+void pathVector (size_type dimension, std::size_t nbPaths, bool iterate)
+{
+  const std::size_t nbSamples = 100000;
+  DevicePtr_t robot = createRobot (dimension);
+  DistancePtr_t distance = WeighedDistance::create (robot);
+  std::vector <ConfigurationPtr_t> configs = shoot (robot, nbPaths + 1);
+  PathVectorPtr_t path = PathVector::create (robot->configSize ());
+  for (std::size_t i=0; i<nbPaths; ++i) {
+    path->appendPath (StraightPath::create
+		      (robot, *configs [i], *configs [i+1],
+		       (*distance) (*configs [i], *configs [i+1])));
+  }
+  const value_type length = path->timeRange ().second;
+  Configuration_t q (robot->configSize ());
+  PathVector::Iterator iterator (*path);
+  uint64_t start = Statistics::now ();
+  for (std::size_t i=0; i<nbSamples; ++i) {
+    if (iterate) iterator (q, length * i / nbSamples);
+    else (*path) (q, length * i / nbSamples);
+  }
+  uint64_t elapsed = Statistics::now () - start;
+  Report ("PathVector.evaluate") ("dimension", dimension)
+    ("paths", nbPaths) ("iterator", iterate ? "true" : "false")
+    .print (nbSamples, elapsed);
+}
+
+// Evaluate a constrained path at increasing parameters, projecting each
+// configuration from the straight interpolation or from the previous one.
+void warmStart (size_type dimension, size_type nbRows, bool warm)
+{
+  const std::size_t nbSamples = 1000;
+  DevicePtr_t robot = createRobot (dimension);
+  srand (seed);
+  DifferentiableFunctionPtr_t f (new Function (dimension, nbRows));
+  ConfigProjectorPtr_t projector =
+    ConfigProjector::create (robot, "projector", 1e-6, 40);
+  projector->addConstraint (f);
+  ConstraintSetPtr_t constraints =
+    ConstraintSet::create (robot, "constraints");
+  constraints->addConstraint (projector);
+  BasicConfigurationShooter shooter (robot, RandomGenerator::create (seed));
+  ConfigurationPtr_t q1, q2;
+  do {
+    q1 = shooter.shoot ();
+  } while (!constraints->apply (*q1));
+  do {
+    q2 = shooter.shoot ();
+    *q2 = *q1 + .1 * (*q2 - *q1);
+  } while (!constraints->apply (*q2));
+  PathPtr_t path = StraightPath::create (robot, *q1, *q2, 1);
+  path->constraints (constraints);
+  path->warmStart (warm);
+  std::size_t iterations = projector->numberIterations ();
+  uint64_t start = Statistics::now ();
+  for (std::size_t i=0; i<=nbSamples; ++i) {
+    (*path) ((value_type) i / nbSamples);
+  }
+  uint64_t elapsed = Statistics::now () - start;
+  Report ("StraightPath.evaluate") ("dimension", dimension)
+    ("rows", nbRows) ("warmStart", warm ? "true" : "false")
+    ("newtonIterations", (double) (projector->numberIterations () -
+				   iterations) / (nbSamples + 1))
+    .print (nbSamples + 1, elapsed);
+}
+
+// The synthetic robot has no body: validation measures the evaluation of
+// the path and the overhead of the collision checking loop.
+void validation (size_type dimension, value_type stepSize)
+{
+  const std::size_t nbPaths = 1000;
+  DevicePtr_t robot = createRobot (dimension);
+  DistancePtr_t distance = WeighedDistance::create (robot);
+  DiscretizedCollisionCheckingPtr_t validation =
+    DiscretizedCollisionChecking::create (robot, stepSize);
+  std::vector <ConfigurationPtr_t> configs = shoot (robot, nbPaths + 1);
+  std::vector <PathPtr_t> paths;
+  for (std::size_t i=0; i<nbPaths; ++i) {
+    paths.push_back (StraightPath::create
+		     (robot, *configs [i], *configs [i+1],
+		      (*distance) (*configs [i], *configs [i+1])));
+  }
+  std::size_t samples = validation->numberSamples ();
+  PathPtr_t validPart;
+  uint64_t start = Statistics::now ();
+  for (std::size_t i=0; i<nbPaths; ++i) {
+    validation->validate (paths [i], false, validPart);
+  }
+  uint64_t elapsed = Statistics::now () - start;
+  samples = validation->numberSamples () - samples;
+  Report ("DiscretizedCollisionChecking.validate") ("dimension", dimension)
+    ("stepSize", stepSize) ("samples", samples)
+    ("samplesPerSecond", elapsed ? 1e9 * samples / elapsed : 0.)
+    .print (nbPaths, elapsed);
+}
+
+int main ()
+{
+  const size_type dimensions [] = {3, 6, 12, 40};
+  for (std::size_t i=0; i<4; ++i) {
+    shooting (dimensions [i]);
+  }
+  for (std::size_t i=0; i<4; ++i) {
+    distance (dimensions [i]);
+  }
+  for (std::size_t i=0; i<4; ++i) {
+    size_type nbRows = dimensions [i] / 2;
+    projection (dimensions [i], nbRows, ConfigProjector::SVD, "SVD");
+    projection (dimensions [i], nbRows, ConfigProjector::QR, "QR");
+    projection (dimensions [i], nbRows, ConfigProjector::DAMPED_LDLT,
+		"DAMPED_LDLT");
+    projection (dimensions [i], nbRows, ConfigProjector::SVD, "SVD",
+		ConfigProjector::LEVENBERG_MARQUARDT, "LEVENBERG_MARQUARDT");
+  }
+  const std::size_t nbPaths [] = {10, 500, 5000};
+  for (std::size_t i=0; i<3; ++i) {
+    pathVector (3, nbPaths [i], false);
+    pathVector (3, nbPaths [i], true);
+  }
+  for (std::size_t i=0; i<4; ++i) {
+    warmStart (dimensions [i], dimensions [i] / 2, false);
+    warmStart (dimensions [i], dimensions [i] / 2, true);
+  }
+  for (std::size_t i=0; i<4; ++i) {
+    validation (dimensions [i], .05);
+  }
+  return 0;
+}
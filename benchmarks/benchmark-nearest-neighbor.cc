@@ -0,0 +1,149 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+// Insertion and search times of the nearest neighbor search structures
+// with respect to the number of nodes and to the dimension.
+
+#include <vector>
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/flat-k-d-tree.hh>
+#include <hpp/core/k-d-tree.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/weighed-distance.hh>
+#include "../src/basic-configuration-shooter.hh"
+#include "../src/random-generator.cc"
+#include "../src/node.cc"
+#include "../src/k-d-tree.cc"
+#include "../src/flat-k-d-tree.cc"
+#include "../src/weighed-distance.cc"
+#include "../src/statistics.cc"
+#include "benchmark.hh"
+
+using namespace hpp::core;
+using namespace hpp::core::benchmark;
+
+const std::size_t nbQueries = 1000;
+const std::size_t k = 10;
+
+NearestNeighborSearchPtr_t create (const std::string& name,
+				   const DevicePtr_t& robot,
+				   const DistancePtr_t& distance)
+{
+  if (name == "KDTree") {
+    return NearestNeighborSearchPtr_t (new KDTree (robot, distance, 30));
+  }
+  return FlatKDTree::create (robot, distance, 30);
+}
+
+void run (const std::string& name, size_type dimension, std::size_t nbNodes)
+{
+  DevicePtr_t robot = createRobot (dimension);
+  DistancePtr_t distance = WeighedDistance::create (robot);
+  BasicConfigurationShooter shooter (robot, RandomGenerator::create (seed));
+  NearestNeighborSearchPtr_t tree = create (name, robot, distance);
+  ConnectedComponentPtr_t cc = ConnectedComponent::create ();
+  std::vector <NodePtr_t> nodes;
+  nodes.reserve (nbNodes);
+  for (std::size_t i=0; i<nbNodes; ++i) {
+    nodes.push_back (new Node (shooter.shoot (), cc));
+    cc->addNode (nodes.back ());
+  }
+  std::vector <ConfigurationPtr_t> queries;
+  for (std::size_t i=0; i<nbQueries; ++i) {
+    queries.push_back (shooter.shoot ());
+  }
+
+  uint64_t start = Statistics::now ();
+  for (std::size_t i=0; i<nbNodes; ++i) {
+    tree->addNode (nodes [i]);
+  }
+  Report (name + ".addNode") ("dimension", dimension) ("nodes", nbNodes)
+    .print (nbNodes, Statistics::now () - start);
+
+  std::size_t visits = tree->numberVisits ();
+  std::size_t distances = tree->numberDistances ();
+  std::vector <value_type> exact (nbQueries);
+  start = Statistics::now ();
+  for (std::size_t i=0; i<nbQueries; ++i) {
+    tree->search (queries [i], cc, exact [i]);
+  }
+  uint64_t elapsed = Statistics::now () - start;
+  Report (name + ".search") ("dimension", dimension) ("nodes", nbNodes)
+    ("visits", (double) (tree->numberVisits () - visits) / nbQueries)
+    ("distances", (double) (tree->numberDistances () - distances) / nbQueries)
+    .print (nbQueries, elapsed);
+
+  // Approximate searches, error is the mean ratio of the distance to the
+  // returned node to the distance to the nearest node.
+  const value_type epsilons [] = {.2, .5, 1., 0.};
+  const std::size_t maxLeaves [] = {0, 0, 0, 4};
+  for (std::size_t j=0; j<4; ++j) {
+    tree->approximation (epsilons [j], maxLeaves [j]);
+    visits = tree->numberVisits ();
+    distances = tree->numberDistances ();
+    value_type error = 0;
+    start = Statistics::now ();
+    for (std::size_t i=0; i<nbQueries; ++i) {
+      value_type d;
+      tree->search (queries [i], cc, d);
+      error += d / exact [i];
+    }
+    elapsed = Statistics::now () - start;
+    Report (name + ".approximateSearch") ("dimension", dimension)
+      ("nodes", nbNodes) ("epsilon", epsilons [j])
+      ("maxLeaves", maxLeaves [j])
+      ("visits", (double) (tree->numberVisits () - visits) / nbQueries)
+      ("distances", (double) (tree->numberDistances () - distances) /
+       nbQueries)
+      ("error", error / nbQueries).print (nbQueries, elapsed);
+  }
+  tree->approximation (0, 0);
+
+  Nodes_t nearest;
+  start = Statistics::now ();
+  for (std::size_t i=0; i<nbQueries; ++i) {
+    tree->kNearest (queries [i], cc, k, nearest);
+  }
+  Report (name + ".kNearest") ("dimension", dimension) ("nodes", nbNodes)
+    ("k", k).print (nbQueries, Statistics::now () - start);
+
+  tree->clear ();
+  for (std::size_t i=0; i<nbNodes; ++i) {
+    delete nodes [i];
+  }
+}
+
+int main ()
+{
+  const char* names [] = {"KDTree", "FlatKDTree"};
+  const size_type dimensions [] = {3, 6, 12};
+  const std::size_t sizes [] = {1000, 10000, 100000};
+  for (std::size_t i=0; i<2; ++i) {
+    for (std::size_t j=0; j<3; ++j) {
+      for (std::size_t l=0; l<3; ++l) {
+	run (names [i], dimensions [j], sizes [l]);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,160 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+// Time of the bulk operations of roadmaps: growing a random tree,
+// releasing it, saving it to a file, loading it back and merging it into
+// another roadmap.
+
+#include <cstdio>
+#include <string>
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method-straight.hh>
+#include <hpp/core/straight-path.hh>
+#include <hpp/core/weighed-distance.hh>
+#include "../src/basic-configuration-shooter.hh"
+#include "../src/random-generator.cc"
+#include "../src/node.cc"
+#include "../src/k-d-tree.cc"
+#include "../src/roadmap.cc"
+#include "../src/path.cc"
+#include "../src/straight-path.cc"
+#include "../src/constraint.cc"
+#include "../src/constraint-set.cc"
+#include "../src/config-projector.cc"
+#include "../src/weighed-distance.cc"
+#include "../src/statistics.cc"
+#include "benchmark.hh"
+
+using namespace hpp::core;
+using namespace hpp::core::benchmark;
+
+// Grow a tree from the initial node by linking each new configuration to
+// its nearest node.
+void fill (const RoadmapPtr_t& roadmap, const DevicePtr_t& robot,
+	   std::size_t nbNodes, unsigned int fillSeed = seed)
+{
+  BasicConfigurationShooter shooter (robot,
+				     RandomGenerator::create (fillSeed));
+  roadmap->initNode (shooter.shoot ());
+  while (roadmap->nodes ().size () < nbNodes) {
+    ConfigurationPtr_t q = shooter.shoot ();
+    value_type d;
+    NodePtr_t near = roadmap->nearestNode (q, d);
+    PathPtr_t path = StraightPath::create (robot, *(near->configuration ()),
+					   *q, d);
+    roadmap->addNodeAndEdge (near, q, path);
+  }
+}
+
+// The second run fills the roadmap again after clear.
+void fillAndClear (size_type dimension, std::size_t nbNodes)
+{
+  DevicePtr_t robot = createRobot (dimension);
+  DistancePtr_t distance = WeighedDistance::create (robot);
+  RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
+  for (unsigned run=0; run<2; ++run) {
+    uint64_t start = Statistics::now ();
+    fill (roadmap, robot, nbNodes);
+    Report ("Roadmap.fill") ("dimension", dimension) ("nodes", nbNodes)
+      ("run", run).print (nbNodes, Statistics::now () - start);
+    start = Statistics::now ();
+    roadmap->clear ();
+    Report ("Roadmap.clear") ("dimension", dimension) ("nodes", nbNodes)
+      ("run", run).print (nbNodes, Statistics::now () - start);
+  }
+}
+
+// The first search after load builds the nearest neighbor structure.
+void saveAndLoad (size_type dimension, std::size_t nbNodes)
+{
+  DevicePtr_t robot = createRobot (dimension);
+  DistancePtr_t distance = WeighedDistance::create (robot);
+  SteeringMethodPtr_t sm (new SteeringMethodStraight (robot));
+  RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
+  fill (roadmap, robot, nbNodes);
+  const std::string filename ("benchmark-roadmap.bin");
+  uint64_t start = Statistics::now ();
+  roadmap->save (filename);
+  Report ("Roadmap.save") ("dimension", dimension) ("nodes", nbNodes)
+    .print (nbNodes, Statistics::now () - start);
+  RoadmapPtr_t loaded = Roadmap::create (distance, robot);
+  start = Statistics::now ();
+  loaded->load (filename, sm);
+  Report ("Roadmap.load") ("dimension", dimension) ("nodes", nbNodes)
+    .print (nbNodes, Statistics::now () - start);
+  std::remove (filename.c_str ());
+  ConfigurationPtr_t q (new Configuration_t (robot->configSize ()));
+  q->setZero ();
+  value_type d;
+  start = Statistics::now ();
+  loaded->nearestNode (q, d);
+  Report ("Roadmap.firstSearch") ("dimension", dimension)
+    ("nodes", nbNodes).print (1, Statistics::now () - start);
+}
+
+// Validation of paths in a world without obstacles
+class FreeValidation : public PathValidation
+{
+public:
+  virtual bool validate (const PathPtr_t& path, bool, PathPtr_t& validPart)
+  {
+    validPart = path;
+    return true;
+  }
+}; // class FreeValidation
+
+// Merge the file of a roadmap into a roadmap grown with another seed
+void merge (size_type dimension, std::size_t nbNodes)
+{
+  DevicePtr_t robot = createRobot (dimension);
+  DistancePtr_t distance = WeighedDistance::create (robot);
+  SteeringMethodPtr_t sm (new SteeringMethodStraight (robot));
+  PathValidationPtr_t validation (new FreeValidation);
+  RoadmapPtr_t source = Roadmap::create (distance, robot);
+  fill (source, robot, nbNodes, seed + 1);
+  const std::string filename ("benchmark-roadmap.bin");
+  source->save (filename);
+  RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
+  fill (roadmap, robot, nbNodes);
+  uint64_t start = Statistics::now ();
+  std::size_t nbConnections = roadmap->merge (filename, sm, validation);
+  Report ("Roadmap.merge") ("dimension", dimension) ("nodes", nbNodes)
+    ("connections", nbConnections)
+    .print (nbNodes, Statistics::now () - start);
+  std::remove (filename.c_str ());
+}
+
+int main ()
+{
+  fillAndClear (3, 1000);
+  fillAndClear (3, 20000);
+  fillAndClear (3, 100000);
+  saveAndLoad (3, 20000);
+  saveAndLoad (3, 100000);
+  merge (3, 2000);
+  merge (3, 20000);
+  return 0;
+}
@@ -0,0 +1,182 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+// Iterations of a diffusing planner to cross a narrow passage with each
+// configuration shooter. Obstacles are defined analytically in the plane
+// and paths are validated by discretization.
+
+#include <cmath>
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/diffusing-planner.hh>
+#include <hpp/core/gaussian-configuration-shooter.hh>
+#include <hpp/core/halton-configuration-shooter.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/roadmap.hh>
+#include "../src/basic-configuration-shooter.hh"
+#include "../src/random-generator.cc"
+#include "../src/halton-configuration-shooter.cc"
+#include "../src/gaussian-configuration-shooter.cc"
+#include "../src/node.cc"
+#include "../src/k-d-tree.cc"
+#include "../src/roadmap.cc"
+#include "../src/path.cc"
+#include "../src/path-vector.cc"
+#include "../src/straight-path.cc"
+#include "../src/constraint.cc"
+#include "../src/constraint-set.cc"
+#include "../src/config-projector.cc"
+#include "../src/weighed-distance.cc"
+#include "../src/discretized-collision-checking.cc"
+#include "../src/problem.cc"
+#include "../src/path-planner.cc"
+#include "../src/statistics.cc"
+#include "../src/diffusing-planner.cc"
+#include "benchmark.hh"
+
+using namespace hpp::core;
+using namespace hpp::core::benchmark;
+
+// Plane world of [-3,3]x[-3,3] cut in two halves by a wall with a narrow
+// passage around the origin.
+bool inNarrowPassage (ConfigurationIn_t q)
+{
+  return fabs (q [0]) < .5 && fabs (q [1]) > .1;
+}
+
+// Validation of paths by discretization in the plane world
+class PassageValidation : public PathValidation
+{
+public:
+  virtual bool validate (const PathPtr_t& path, bool reverse,
+			 PathPtr_t& validPart)
+  {
+    const value_type step = 1e-2;
+    interval_t range = path->timeRange ();
+    if (reverse) std::swap (range.first, range.second);
+    value_type sign = range.second > range.first ? 1 : -1;
+    value_type length = fabs (range.second - range.first);
+    value_type valid = range.first;
+    for (value_type s = 0; ; s += step) {
+      if (s > length) s = length;
+      value_type t = range.first + sign * s;
+      ++numberSamples_;
+      if (inNarrowPassage ((*path) (t))) {
+	if (reverse) {
+	  validPart = path->extract (interval_t (valid, range.first));
+	} else {
+	  validPart = path->extract (interval_t (range.first, valid));
+	}
+	return false;
+      }
+      valid = t;
+      if (s == length) break;
+    }
+    validPart = path;
+    return true;
+  }
+}; // class PassageValidation
+
+// Gaussian shooter checking collisions in the plane world
+class PassageGaussianShooter : public GaussianConfigurationShooter
+{
+public:
+  PassageGaussianShooter (const DevicePtr_t& robot,
+			  const DistancePtr_t& distance,
+			  value_type standardDeviation,
+			  const RandomGeneratorPtr_t& generator) :
+    GaussianConfigurationShooter (robot, distance, standardDeviation,
+				  generator)
+  {
+  }
+protected:
+  virtual bool collides (ConfigurationIn_t q) const
+  {
+    return inNarrowPassage (q);
+  }
+}; // class PassageGaussianShooter
+
+enum ShooterType {
+  BASIC,
+  HALTON,
+  GAUSSIAN,
+  BRIDGE
+};
+
+// Number of iterations of a diffusing planner to connect both sides of the
+// wall, 0 if not solved after a maximal number of iterations.
+std::size_t iterationsToSolution (ShooterType type, unsigned int runSeed)
+{
+  const std::size_t maxIterations = 5000;
+  DevicePtr_t robot = createRobot (2);
+  Problem problem (robot);
+  problem.randomGenerator ()->seed (runSeed);
+  problem.pathValidation (PathValidationPtr_t (new PassageValidation));
+  ConfigurationPtr_t qInit (new Configuration_t (2));
+  ConfigurationPtr_t qGoal (new Configuration_t (2));
+  *qInit << -2, 2;
+  *qGoal << 2, -2;
+  problem.initConfig (qInit);
+  problem.addGoalConfig (qGoal);
+  DiffusingPlannerPtr_t planner = DiffusingPlanner::create (problem);
+  RandomGeneratorPtr_t generator = problem.randomGenerator ()->split ();
+  if (type == HALTON) {
+    HaltonConfigurationShooterPtr_t shooter =
+      HaltonConfigurationShooter::create (robot);
+    shooter->index (1 + 1000 * runSeed);
+    planner->configurationShooter (shooter);
+  } else if (type == GAUSSIAN || type == BRIDGE) {
+    boost::shared_ptr <PassageGaussianShooter> shooter
+      (new PassageGaussianShooter (robot, problem.distance (), .3,
+				   generator));
+    shooter->bridgeTest (type == BRIDGE);
+    planner->configurationShooter (shooter);
+  }
+  planner->startSolve ();
+  for (std::size_t i=1; i <= maxIterations; ++i) {
+    planner->oneStep ();
+    if (planner->pathExists ()) return i;
+  }
+  return 0;
+}
+
+int main ()
+{
+  const char* names [] = {"basic", "halton", "gaussian", "bridge test"};
+  const unsigned int nbRuns = 20;
+  for (int type = BASIC; type <= BRIDGE; ++type) {
+    std::size_t total = 0, solved = 0;
+    uint64_t start = Statistics::now ();
+    for (unsigned int k = 0; k < nbRuns; ++k) {
+      std::size_t iterations = iterationsToSolution ((ShooterType) type,
+						     seed + k);
+      if (iterations > 0) ++solved;
+      total += iterations;
+    }
+    uint64_t elapsed = Statistics::now () - start;
+    Report ("DiffusingPlanner.narrowPassage") ("shooter", names [type])
+      ("solved", solved)
+      ("iterations", solved ? (double) total / solved : 0.)
+      .print (nbRuns, elapsed);
+  }
+  return 0;
+}
@@ -0,0 +1,195 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+// End-to-end resolution of canonical scenes by ProblemSolver::solve with
+// each path planner and path optimizer. Obstacles are defined analytically in the
+// configuration space of robots made of bounded translations and paths are
+// validated by discretization.
+
+#include <cmath>
+#include <string>
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/problem-solver.hh>
+#include <hpp/core/random-generator.hh>
+#include "../src/random-generator.cc"
+#include "../src/node.cc"
+#include "../src/k-d-tree.cc"
+#include "../src/flat-k-d-tree.cc"
+#include "../src/roadmap.cc"
+#include "../src/path.cc"
+#include "../src/path-vector.cc"
+#include "../src/straight-path.cc"
+#include "../src/constraint.cc"
+#include "../src/constraint-set.cc"
+#include "../src/config-projector.cc"
+#include "../src/weighed-distance.cc"
+#include "../src/discretized-collision-checking.cc"
+#include "../src/problem.cc"
+#include "../src/path-planner.cc"
+#include "../src/diffusing-planner.cc"
+#include "../src/parallel-diffusing-planner.cc"
+#include "../src/rrt-connect-planner.cc"
+#include "../src/lazy-prm-planner.cc"
+#include "../src/portfolio-planner.cc"
+#include "../src/plan-and-optimize.cc"
+#include "../src/solve-handle.cc"
+#include "../src/random-shortcut.cc"
+#include "../src/parallel-random-shortcut.cc"
+#include "../src/partial-shortcut.cc"
+#include "../src/problem-solver.cc"
+#include "../src/statistics.cc"
+#include "benchmark.hh"
+
+using namespace hpp::core;
+using namespace hpp::core::benchmark;
+
+typedef bool (*InCollision_t) (ConfigurationIn_t q);
+
+// Validation of paths by discretization against an analytical obstacle
+class SceneValidation : public PathValidation
+{
+public:
+  SceneValidation (InCollision_t inCollision) : inCollision_ (inCollision)
+  {
+  }
+  virtual bool validate (const PathPtr_t& path, bool reverse,
+			 PathPtr_t& validPart)
+  {
+    const value_type step = 1e-2;
+    interval_t range = path->timeRange ();
+    if (reverse) std::swap (range.first, range.second);
+    value_type sign = range.second > range.first ? 1 : -1;
+    value_type length = fabs (range.second - range.first);
+    value_type valid = range.first;
+    for (value_type s = 0; ; s += step) {
+      if (s > length) s = length;
+      value_type t = range.first + sign * s;
+      ++numberSamples_;
+      if (inCollision_ ((*path) (t))) {
+	if (reverse) {
+	  validPart = path->extract (interval_t (valid, range.first));
+	} else {
+	  validPart = path->extract (interval_t (range.first, valid));
+	}
+	return false;
+      }
+      valid = t;
+      if (s == length) break;
+    }
+    validPart = path;
+    return true;
+  }
+private:
+  InCollision_t inCollision_;
+}; // class SceneValidation
+
+bool free (ConfigurationIn_t)
+{
+  return false;
+}
+
+// Square obstacle in the middle of the plane
+bool box (ConfigurationIn_t q)
+{
+  return q.cwiseAbs ().maxCoeff () < 1;
+}
+
+// Two walls forming a zigzag between the initial and goal configurations
+bool zigzag (ConfigurationIn_t q)
+{
+  return (fabs (q [0] + 1) < .2 && q [1] > -2) ||
+    (fabs (q [0] - 1) < .2 && q [1] < 2);
+}
+
+// Wall orthogonal to the first axis with a small square window
+bool narrowPassage (ConfigurationIn_t q)
+{
+  return fabs (q [0]) < .1 && (fabs (q [1]) > .3 || fabs (q [2]) > .3);
+}
+
+struct Scene {
+  const char* name;
+  size_type dimension;
+  InCollision_t inCollision;
+  /// Initial and goal configurations, first dimension values are used
+  value_type init [6];
+  value_type goal [6];
+}; // struct Scene
+
+void run (const Scene& scene, const char* planner, const char* optimizer,
+	  unsigned int runSeed)
+{
+  DevicePtr_t robot = createRobot (scene.dimension);
+  ProblemSolver solver;
+  solver.robot (robot);
+  solver.resetProblem ();
+  solver.problem ()->randomGenerator ()->seed (runSeed);
+  PathValidationPtr_t validation (new SceneValidation (scene.inCollision));
+  solver.problem ()->pathValidation (validation);
+  ConfigurationPtr_t qInit (new Configuration_t (scene.dimension));
+  ConfigurationPtr_t qGoal (new Configuration_t (scene.dimension));
+  for (size_type i=0; i<scene.dimension; ++i) {
+    (*qInit) [i] = scene.init [i];
+    (*qGoal) [i] = scene.goal [i];
+  }
+  solver.initConfig (qInit);
+  solver.addGoalConfig (qGoal);
+  solver.pathPlannerType (planner);
+  solver.pathOptimizerType (optimizer);
+  uint64_t start = Statistics::now ();
+  solver.solve ();
+  uint64_t elapsed = Statistics::now () - start;
+  Report ("ProblemSolver.solve") ("scene", scene.name) ("planner", planner)
+    ("optimizer", optimizer) ("seed", runSeed)
+    ("nodes", solver.roadmap ()->nodes ().size ())
+    ("length", solver.paths ().back ()->length ())
+    ("samples", validation->numberSamples ())
+    (solver.statistics ()).print (1, elapsed);
+}
+
+int main ()
+{
+  const Scene scenes [] = {
+    {"free-6d", 6, free, {-2.5, -2.5, -2.5, -2.5, -2.5, -2.5},
+     {2.5, 2.5, 2.5, 2.5, 2.5, 2.5}},
+    {"box-2d", 2, box, {-2.5, -2.5}, {2.5, 2.5}},
+    {"zigzag-2d", 2, zigzag, {-2.5, 2.5}, {2.5, -2.5}},
+    {"narrow-passage-3d", 3, narrowPassage, {-2.5, 2., 2.}, {2.5, 2., -2.}}
+  };
+  const char* planners [] = {
+    "DiffusingPlanner", "RrtConnectPlanner", "LazyPrmPlanner"
+  };
+  const char* optimizers [] = {"RandomShortcut", "PartialShortcut"};
+  const std::size_t nbRuns = 3;
+  for (std::size_t i=0; i<4; ++i) {
+    for (std::size_t j=0; j<3; ++j) {
+      for (std::size_t l=0; l<2; ++l) {
+	for (std::size_t k=0; k<nbRuns; ++k) {
+	  run (scenes [i], planners [j], optimizers [l], seed + k);
+	}
+      }
+    }
+  }
+  return 0;
+}
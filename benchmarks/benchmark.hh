@@ -0,0 +1,125 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_BENCHMARK_HH
+# define HPP_CORE_BENCHMARK_HH
+
+# include <iostream>
+# include <sstream>
+# include <string>
+# include <stdint.h>
+
+# include <hpp/model/device.hh>
+# include <hpp/model/joint.hh>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/statistics.hh>
+
+namespace hpp {
+  namespace core {
+    namespace benchmark {
+      using model::Device;
+      using model::JointPtr_t;
+      using model::JointTranslation;
+      using model::Transform3f;
+
+      /// Seed of the random generators of all the benchmarks
+      const unsigned int seed = 1;
+
+      /// Build a robot with nbDofs translations bounded by [-3,3]
+      inline DevicePtr_t createRobot (size_type nbDofs)
+      {
+	DevicePtr_t robot = Device::create("robot");
+	for (size_type i=0; i<nbDofs; ++i) {
+	  JointPtr_t joint = new JointTranslation(Transform3f());
+	  joint->isBounded(0,1);
+	  joint->lowerBound(0,-3.);
+	  joint->upperBound(0,3.);
+	  if (i == 0) robot->rootJoint(joint);
+	  else robot->registerJoint(joint);
+	}
+	return robot;
+      }
+
+      /// One line of JSON describing a measure
+      ///
+      /// \code
+      /// Report ("kdTree.search") ("nodes", n) ("dimension", d)
+      ///   .print (nbSearches, elapsed);
+      /// \endcode
+      /// prints
+      /// \code
+      /// {"benchmark": "kdTree.search", "nodes": 1000, "dimension": 3,
+      ///  "iterations": 10000, "ns": 4.2e+06, "ns_per_iteration": 420}
+      /// \endcode
+      /// on a single line of the standard output.
+      class Report
+      {
+      public:
+	explicit Report (const std::string& name)
+	{
+	  fields_ << "{\"benchmark\": \"" << name << "\"";
+	}
+
+	/// Add a numerical field
+	template <typename T> Report& operator () (const std::string& key,
+						   const T& value)
+	{
+	  fields_ << ", \"" << key << "\": " << value;
+	  return *this;
+	}
+
+	/// Add a string field
+	Report& operator () (const std::string& key, const char* value)
+	{
+	  fields_ << ", \"" << key << "\": \"" << value << "\"";
+	  return *this;
+	}
+
+	/// Add the phases and counters of a resolution
+	Report& operator () (const Statistics& statistics)
+	{
+	  for (std::size_t i=0; i<Statistics::NB_PHASES; ++i) {
+	    Statistics::Phase phase = (Statistics::Phase) i;
+	    (*this) (std::string (Statistics::name (phase)) + " ns",
+		     statistics.nanoseconds (phase));
+	  }
+	  for (std::size_t i=0; i<Statistics::NB_COUNTERS; ++i) {
+	    Statistics::Counter counter = (Statistics::Counter) i;
+	    (*this) (Statistics::name (counter), statistics.count (counter));
+	  }
+	  return *this;
+	}
+
+	/// Print the line with the duration of the measure
+	/// \param iterations number of measured iterations,
+	/// \param nanoseconds duration of the iterations.
+	void print (std::size_t iterations, uint64_t nanoseconds)
+	{
+	  double total = (double) nanoseconds;
+	  (*this) ("iterations", iterations) ("ns", total)
+	    ("ns_per_iteration", iterations ? total / iterations : 0.);
+	  std::cout << fields_.str () << "}" << std::endl;
+	}
+
+      private:
+	std::ostringstream fields_;
+      }; // class Report
+    } // namespace benchmark
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_BENCHMARK_HH
@@ -9,5 +9,5 @@ Name: ${PROJECT_NAME}
 Description: Core classes of Humanoid Path Planner
 Version: ${PROJECT_VERSION}
 Requires: ${PACKAGE_REQUIREMENTS}
-Libs: ${LIBDIR_KW}${install_pkg_libdir} ${${PROJECT_NAME}_LDFLAGS}
+Libs: ${LIBDIR_KW}${install_pkg_libdir} ${${PROJECT_NAME}_LDFLAGS} ${HPP_CORE_DEPENDENCY_LIBS}
 Cflags: -I${install_pkg_include_dir} ${${PROJECT_NAME}_CXXFLAGS}
@@ -19,6 +19,10 @@
 #ifndef HPP_CORE_CONFIG_PROJECTOR_HH
 # define HPP_CORE_CONFIG_PROJECTOR_HH
 
+# include <algorithm>
+# include <Eigen/SVD>
+# include <Eigen/QR>
+# include <Eigen/Cholesky>
 # include <roboptim/core/differentiable-function.hh>
 # include <hpp/core/config.hh>
 # include <hpp/core/constraint.hh>
@@ -30,9 +34,65 @@ namespace hpp {
     /// Defined by a list of vector-valued functions and solved numerically
     /// by Newton Raphson like method.
     /// Store locked degrees of freedom for performance optimisation.
+    ///
+    /// Several configurations can be projected concurrently by projectBatch.
+    ///
+    /// The linear systems of the Newton iterations and of the projection on
+    /// the kernel of the Jacobian are solved by a selectable decomposition.
+    /// Decompositions and working vectors are allocated when constraints or
+    /// locked degrees of freedom are added, not during the resolution.
+    ///
+    /// Constraints are solved either by Newton Raphson iterations with an
+    /// increasing step, or by Levenberg Marquardt iterations with adaptive
+    /// damping (see Algorithm_t). The outcome of each projection is recorded
+    /// (see lastProjection and numberProjections).
     class HPP_CORE_DLLAPI ConfigProjector : public Constraint
     {
     public:
+      /// Decomposition used to invert the reduced Jacobian J
+      enum LinearSolver_t {
+	/// Singular value decomposition of J
+	SVD,
+	/// Column pivoting QR decomposition of J^T. Linearly dependent rows
+	/// of J are ignored.
+	QR,
+	/// Cholesky decomposition of J J^T + damping I
+	DAMPED_LDLT
+      };
+
+      /// Algorithm used to solve the constraints
+      enum Algorithm_t {
+	/// Newton Raphson iterations q_{i+1} = q_i - alpha_i J^{+} f (q_i),
+	/// alpha_i increasing from .2 towards .95. Fails if the error does not
+	/// decrease during 3 iterations.
+	NEWTON_RAPHSON,
+	/// Levenberg Marquardt iterations
+	/// q_{i+1} = q_i - J^T (J J^T + lambda_i I)^{-1} f (q_i). A step is
+	/// accepted only if it decreases the error, lambda_i decreases after
+	/// accepted steps and increases after rejected ones. Fails if lambda_i
+	/// becomes too large. Always uses a Cholesky decomposition.
+	LEVENBERG_MARQUARDT
+      };
+
+      /// Outcome of a projection
+      enum Status_t {
+	/// The error is below the threshold
+	SUCCESS,
+	/// The maximal number of iterations was reached
+	MAX_ITERATIONS,
+	/// The error stopped decreasing
+	NO_DECREASE
+      };
+
+      /// Report of a projection
+      struct Report_t {
+	Status_t status;
+	/// Number of iterations, including rejected Levenberg Marquardt steps
+	size_type iterations;
+	/// Norm of the value of the constraint at the returned configuration
+	value_type residual;
+      }; // struct Report_t
+
       /// Return shared pointer to new object
       /// \param robot robot the constraint applies to.
       /// \param errorThreshold norm of the value of the constraint under which
@@ -65,6 +125,115 @@ namespace hpp {
       void projectOnKernel (ConfigurationIn_t from,
 			    ConfigurationIn_t to, ConfigurationOut_t result);
 
+      /// State of the projection of the previous configuration of a
+      /// sequence of close configurations
+      struct WarmStart_t {
+	WarmStart_t () : valid (false), input (), output (), alpha (0)
+	{
+	}
+	/// Whether the previous projection succeeded
+	bool valid;
+	/// Previous configuration before and after projection
+	Configuration_t input;
+	Configuration_t output;
+	/// Step reached by the previous projection
+	value_type alpha;
+      }; // struct WarmStart_t
+
+      using Constraint::apply;
+      /// Project the next configuration of a sequence of close
+      /// configurations
+      ///
+      /// \param configuration configuration to project and result,
+      /// \param warmStart state of the previous projection of the sequence,
+      ///        updated.
+      /// \return whether projection succeeded.
+      ///
+      /// Newton iterations start from the previous result moved as the
+      /// configuration moved from the previous input, with the step reached
+      /// by the previous projection. If they fail, the configuration is
+      /// projected as by apply (ConfigurationOut_t).
+      bool apply (ConfigurationOut_t configuration, WarmStart_t& warmStart);
+
+      /// Project configurations stored in the columns of a matrix
+      ///
+      /// \param configurations configurations to project, stored column-wise,
+      ///        and projected configurations,
+      /// \retval success whether each projection succeeded,
+      /// \param nbThreads number of threads; 0 means one per hardware
+      ///        thread.
+      /// \return whether all projections succeeded.
+      ///
+      /// Each thread uses its own working memory, so that configurations
+      /// are projected concurrently. Configurations are projected by the
+      /// calling thread only if a function does not declare that it
+      /// supports concurrent evaluations (see threadSafe).
+      bool projectBatch (matrixOut_t configurations,
+			 std::vector <bool>& success, std::size_t nbThreads = 1);
+
+      /// Whether all the functions support concurrent evaluations
+      ///
+      /// See DifferentiableFunction::threadSafe.
+      bool threadSafe () const;
+
+      /// Set decomposition used to invert the Jacobian
+      ///
+      /// SVD by default. QR and DAMPED_LDLT are faster but do not handle
+      /// singular Jacobians the same way.
+      void linearSolver (LinearSolver_t solver)
+      {
+	linearSolver_ = solver;
+      }
+      /// Get decomposition used to invert the Jacobian
+      LinearSolver_t linearSolver () const
+      {
+	return linearSolver_;
+      }
+      /// Set damping of DAMPED_LDLT linear solver
+      void damping (value_type damping)
+      {
+	damping_ = damping;
+      }
+      /// Get damping of DAMPED_LDLT linear solver
+      value_type damping () const
+      {
+	return damping_;
+      }
+      /// Set algorithm used to solve the constraints
+      void algorithm (Algorithm_t algorithm)
+      {
+	algorithm_ = algorithm;
+      }
+      /// Get algorithm used to solve the constraints
+      Algorithm_t algorithm () const
+      {
+	return algorithm_;
+      }
+
+      /// Number of Newton iterations since creation
+      std::size_t numberIterations () const
+      {
+	return workspace_.iterations;
+      }
+      /// Number of projections that did not converge since creation
+      std::size_t numberFailures () const
+      {
+	return workspace_.failures;
+      }
+      /// Number of projections with the given outcome since creation
+      std::size_t numberProjections (Status_t status) const
+      {
+	return workspace_.statuses [status];
+      }
+      /// Report of the last projection computed by apply
+      ///
+      /// Projections of projectBatch are only counted by numberIterations,
+      /// numberFailures and numberProjections.
+      const Report_t& lastProjection () const
+      {
+	return workspace_.report;
+      }
+
     protected:
       /// Constructor
       /// \param robot robot the constraint applies to.
@@ -83,28 +252,104 @@ namespace hpp {
       /// Numerically solve constraint
       virtual bool impl_compute (ConfigurationOut_t configuration);
       /// Set locked degrees of freedom to their locked values
-      void computeLockedDofs (ConfigurationOut_t configuration);
+      void computeLockedDofs (ConfigurationOut_t configuration) const;
 
     private:
       virtual std::ostream& print (std::ostream& os) const;
       virtual void addToConstraintSet (const ConstraintSetPtr_t& constraintSet);
-      void smallToNormal (vectorIn_t small, vectorOut_t normal);
-      void normalToSmall (vectorIn_t normal, vectorOut_t small);
-      struct FunctionValueAndJacobian_t {
-	FunctionValueAndJacobian_t (DifferentiableFunctionPtr_t f,
-				    vector_t v, matrix_t j): function (f),
-							     value (v),
-							     jacobian (j) {}
+      void smallToNormal (vectorIn_t small, vectorOut_t normal) const;
+      void normalToSmall (vectorIn_t normal, vectorOut_t small) const;
+      /// Block of columns of the Jacobian of a function copied into the
+      /// reduced Jacobian
+      struct JacobianBlock_t {
+	size_type col;
+	size_type reducedCol;
+	size_type nbCols;
+      }; // struct JacobianBlock_t
+      typedef std::vector <JacobianBlock_t> JacobianBlocks_t;
+      struct NumericalConstraint_t {
+	NumericalConstraint_t (DifferentiableFunctionPtr_t f): function (f)
+	{
+	}
 
 	DifferentiableFunctionPtr_t function;
+	/// Columns the function depends on that are not locked
+	JacobianBlocks_t blocks;
+      }; // struct NumericalConstraint_t
+      typedef std::vector < NumericalConstraint_t > NumericalConstraints_t;
+      /// Working memory of a projection
+      ///
+      /// apply and projectOnKernel use workspace_, each thread of
+      /// projectBatch uses an element of workspaces_.
+      struct Workspace_t {
+	Workspace_t () : iterations (0), failures (0)
+	{
+	  report.status = SUCCESS;
+	  report.iterations = 0;
+	  report.residual = 0;
+	  std::fill (statuses, statuses + 3, 0);
+	}
+	/// Value and Jacobian of each function
+	std::vector <vector_t> values;
+	std::vector <matrix_t> jacobians;
 	vector_t value;
-	matrix_t jacobian;
-      }; // struct FunctionValueAndJacobian_t
-      typedef std::vector < FunctionValueAndJacobian_t > NumericalConstraints_t;
+	/// Jacobian without locked degrees of freedom
+	matrix_t reducedJacobian;
+	Eigen::JacobiSVD <matrix_t> svd;
+	Eigen::ColPivHouseholderQR <matrix_t> qr;
+	Eigen::LDLT <matrix_t> ldlt;
+	/// Working memory of the linear solvers
+	matrix_t jacobianTranspose;
+	matrix_t squareJacobian;
+	vector_t rhs;
+	vector_t dq;
+	vector_t dqSmall;
+	/// State before a Levenberg Marquardt step, restored if the step is
+	/// rejected
+	Configuration_t savedConfiguration;
+	vector_t savedValue;
+	matrix_t savedJacobian;
+	/// Number of Newton iterations and of failed projections
+	std::size_t iterations;
+	std::size_t failures;
+	/// Report of the last projection and number of projections by outcome
+	Report_t report;
+	std::size_t statuses [3];
+      }; // struct Workspace_t
+      typedef std::vector <Workspace_t> Workspaces_t;
+      /// Initial step of Newton iterations
+      static const value_type initialStep;
       void resize ();
-      void computeValueAndJacobian (ConfigurationIn_t configuration);
+      /// Allocate working memory for the current constraints
+      void resize (Workspace_t& ws) const;
+      /// Numerically solve constraint using given working memory
+      /// \param alpha initial step and step reached by the last iteration,
+      ///        used by Newton Raphson iterations only.
+      bool project (ConfigurationOut_t configuration, Workspace_t& ws,
+		    value_type& alpha) const;
+      /// Newton Raphson iterations, fill ws.report
+      void newtonRaphson (ConfigurationOut_t configuration, Workspace_t& ws,
+			  value_type& alpha) const;
+      /// Levenberg Marquardt iterations, fill ws.report
+      void levenbergMarquardt (ConfigurationOut_t configuration,
+			       Workspace_t& ws) const;
+      /// Project columns begin to end - 1 of configurations
+      void projectRange (matrixOut_t configurations,
+			 std::vector <char>& success, std::size_t begin,
+			 std::size_t end, Workspace_t& ws) const;
+      void computeValueAndJacobian (ConfigurationIn_t configuration,
+				    Workspace_t& ws) const;
+      /// Decompose reduced Jacobian with the selected linear solver
+      void decomposeJacobian (Workspace_t& ws) const;
+      /// Compute dqSmall = J^{+} value from the decomposition
+      void solveJacobian (Workspace_t& ws) const;
+      /// Compute result = (I - J^{+}J) v from the decomposition
+      void projectOnJacobianKernel (Workspace_t& ws, vectorIn_t v,
+				    vectorOut_t result) const;
       virtual void addLockedDof (const LockedDofPtr_t& lockedDof);
       void computeIntervals ();
+      /// Intersect active columns of each function with intervals_
+      void computeJacobianBlocks ();
       typedef std::list <LockedDofPtr_t> LockedDofs_t;
       typedef std::vector < std::pair <size_type, size_type> >Intervals_t;
       DevicePtr_t robot_;
@@ -114,16 +359,17 @@ namespace hpp {
       Intervals_t  intervals_;
       value_type squareErrorThreshold_;
       size_type maxIterations_;
-      mutable vector_t value_;
-      /// Jacobian without locked degrees of freedom
-      mutable matrix_t reducedJacobian_;
-      mutable matrix_t reducedProjector_;
+      LinearSolver_t linearSolver_;
+      value_type damping_;
+      Algorithm_t algorithm_;
+      Workspace_t workspace_;
+      Workspaces_t workspaces_;
       mutable vector_t toMinusFrom_;
       mutable vector_t toMinusFromSmall_;
       mutable vector_t projMinusFrom_;
       mutable vector_t projMinusFromSmall_;
-      mutable vector_t dq_;
-      mutable vector_t dqSmall_;
+      /// Difference between consecutive inputs of a warm started projection
+      vector_t warmStartStep_;
       size_type nbNonLockedDofs_;
       ConfigProjectorWkPtr_t weak_;
     }; // class ConfigProjector
@@ -19,6 +19,9 @@
 #ifndef HPP_CORE_CONFIGURATION_SHOOTER_HH
 # define HPP_CORE_CONFIGURATION_SHOOTER_HH
 
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
 namespace hpp {
   namespace core {
     /// Abstraction of configuration shooter
@@ -33,6 +36,27 @@ namespace hpp {
 	}
       /// Shoot a random configuration
       virtual ConfigurationPtr_t shoot () const = 0;
+
+      /// Shoot a random configuration in a given vector
+      ///
+      /// Default implementation copies the result of shoot (). Derived
+      /// classes should write in the vector without allocating memory.
+      virtual void shoot (ConfigurationOut_t configuration) const
+      {
+	configuration = *shoot ();
+      }
+
+      /// Shoot random configurations in the columns of a matrix
+      ///
+      /// Default implementation calls shoot (ConfigurationOut_t) for each
+      /// column. Derived classes may sample each degree of freedom for all
+      /// columns at once.
+      virtual void shootBatch (matrixOut_t configurations) const
+      {
+	for (size_type i=0; i < configurations.cols (); ++i) {
+	  shoot (configurations.col (i));
+	}
+      }
     }; // class
   } //   namespace core
 } // namespace hpp
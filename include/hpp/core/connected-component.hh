@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_CONNECTED_COMPONENT_HH
 # define HPP_CORE_CONNECTED_COMPONENT_HH
 
+# include <algorithm>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
 # include <hpp/core/node.hh>
@@ -28,6 +29,18 @@ namespace hpp {
     /// Connected component
     ///
     /// Set of nodes reachable from one another.
+    ///
+    /// Connected components form a disjoint-set forest: merging two
+    /// connected components links the roots of their trees (union by rank)
+    /// and splices the lists of nodes. Nodes keep a pointer to the
+    /// connected component they were created in and get their current
+    /// connected component by calling representative, that follows the
+    /// path to the root without modifying the forest. Paths are compressed
+    /// by merge. Merging is thus independent of the number of nodes.
+    ///
+    /// \note merge rewrites the forest without synchronization: concurrent
+    ///       calls to representative are only safe while no merge runs,
+    ///       that is under the mutex of Roadmap.
     class HPP_CORE_DLLAPI ConnectedComponent {
     public:
       typedef std::list <NodePtr_t> Nodes_t;
@@ -41,16 +54,28 @@ namespace hpp {
       /// Merge two connected components.
       ///
       /// \param other connected component to merge into this one.
-      /// \note other will be empty after calling this method.
+      /// \note other will be empty after calling this method and this
+      ///       connected component becomes the representative of other.
       void merge (const ConnectedComponentPtr_t& other)
       {
-	for (Nodes_t::iterator itNode = other->nodes_.begin ();
-	     itNode != other->nodes_.end (); itNode++) {
-	  (*itNode)->connectedComponent (weak_.lock ());
+	ConnectedComponent* root1 = compress ();
+	ConnectedComponent* root2 = other->compress ();
+	if (root1 != root2) {
+	  if (root1->rank_ < root2->rank_) std::swap (root1, root2);
+	  root2->parent_ = root1->weak_.lock ();
+	  if (root1->rank_ == root2->rank_) ++root1->rank_;
+	  root1->representative_ = weak_;
 	}
-
 	nodes_.splice (nodes_.end (), other->nodes_);
       }
+      /// Get connected component this one has been merged into
+      ///
+      /// \return this object if it has not been merged into another
+      ///         connected component.
+      ConnectedComponentPtr_t representative () const
+      {
+	return root ()->representative_.lock ();
+      }
       /// Add node in connected component
       /// \param node node to add.
       void addNode (const NodePtr_t& node)
@@ -64,15 +89,48 @@ namespace hpp {
       }
     protected:
       /// Constructor
-      ConnectedComponent () : nodes_ (), weak_ ()
+      ConnectedComponent () : nodes_ (), weak_ (), parent_ (), rank_ (0),
+			      representative_ ()
       {
       }
       void init (const ConnectedComponentPtr_t& shPtr){
 	weak_ = shPtr;
+	representative_ = shPtr;
       }
     private:
+      /// Root of the tree in the disjoint-set forest
+      ///
+      /// Union by rank keeps the depth of trees logarithmic in the number
+      /// of merged connected components.
+      ConnectedComponent* root () const
+      {
+	const ConnectedComponent* cc = this;
+	while (cc->parent_) cc = cc->parent_.get ();
+	return const_cast <ConnectedComponent*> (cc);
+      }
+      /// Link this connected component and its ancestors to the root
+      ///
+      /// 
+eturn the root.
+      ConnectedComponent* compress ()
+      {
+	ConnectedComponent* r = root ();
+	ConnectedComponent* cc = this;
+	while (cc->parent_ && cc->parent_.get () != r) {
+	  ConnectedComponentPtr_t parent = cc->parent_;
+	  cc->parent_ = r->weak_.lock ();
+	  cc = parent.get ();
+	}
+	return r;
+      }
        Nodes_t nodes_;
        ConnectedComponentWkPtr_t weak_;
+       /// Parent in the disjoint-set forest, NULL for roots
+       ConnectedComponentPtr_t parent_;
+       /// Upper bound of the height of the tree, roots only
+       std::size_t rank_;
+       /// Connected component representing the tree, roots only
+       ConnectedComponentWkPtr_t representative_;
     }; // class ConnectedComponent
   } //   namespace core
 } // namespace hpp
@@ -21,6 +21,7 @@
 
 # include <deque>
 # include <hpp/core/constraint.hh>
+# include <hpp/core/config-projector.hh>
 
 namespace hpp {
   namespace core {
@@ -48,6 +49,28 @@ namespace hpp {
 	constraint->addToConstraintSet (weak_.lock ());
       }
 
+      using Constraint::apply;
+      /// Apply constraints to the next configuration of a sequence of close
+      /// configurations
+      ///
+      /// The numerical constraints are solved by
+      /// ConfigProjector::apply (ConfigurationOut_t, WarmStart_t&).
+      bool apply (ConfigurationOut_t configuration,
+		  ConfigProjector::WarmStart_t& warmStart);
+
+      /// Apply constraints to configurations stored in the columns of a
+      /// matrix
+      ///
+      /// \param configurations configurations stored column-wise and result,
+      /// \retval success whether constraints applied successfully to each
+      ///         configuration,
+      /// \param nbThreads number of threads used to project configurations
+      ///        on numerical constraints, see ConfigProjector::projectBatch.
+      /// \return whether constraints applied successfully to all
+      ///         configurations.
+      bool applyBatch (matrixOut_t configurations,
+		       std::vector <bool>& success, std::size_t nbThreads = 1);
+
       /// Whether constraint set contains constraints of type LockedDof.
       bool hasLockedDofs () const
       {
@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_CONTINUOUS_COLLISION_CHECKING_HH
+# define HPP_CORE_CONTINUOUS_COLLISION_CHECKING_HH
+
+# include <hpp/core/path-validation.hh>
+
+namespace hpp {
+  namespace core {
+    /// Validation of path by distance computation at adaptive parameter
+    /// values
+    ///
+    /// At each sample, the distance between the robot and the obstacles is
+    /// computed. Along a StraightPath, the displacement of the robot bodies
+    /// is estimated by the sum over joints of joint distance weighed by the
+    /// weights of WeighedDistance. The next sample is taken at the farthest
+    /// parameter the robot cannot reach the obstacles before.
+    ///
+    /// A configuration is considered as invalid if the distance to the
+    /// obstacles is less than a given tolerance, or if collisionTest fails.
+    ///
+    /// \warning The weights computed by WeighedDistance::create are
+    ///          the singular values of the joint Jacobians at the joint
+    ///          origins: they do not account for the extent of the bodies.
+    ///          The validation is conservative only if the weights of the
+    ///          distance bound the displacement of every point of the
+    ///          bodies, which is left to the user.
+    ///
+    /// \note Only obstacles registered for distance computation (see
+    ///       Problem::addObstacle) are taken into account between samples.
+    ///       Paths that are not instances of StraightPath, paths
+    ///       subject to constraints, and paths of a robot without any
+    ///       distance computation are validated by
+    ///       DiscretizedCollisionChecking.
+    class HPP_CORE_DLLAPI ContinuousCollisionChecking : public PathValidation
+    {
+    public:
+      /// Create an instance
+      /// \param robot the robot for which collision checking is performed,
+      /// \param distance weighed distance providing the joint lengths,
+      /// \param tolerance distance to obstacles below which configurations
+      ///        are considered as in collision, should be positive since
+      ///        it bounds from below the distance between samples,
+      /// \param stepSize step of discretized collision checking for paths
+      ///        that cannot be validated continuously.
+      static ContinuousCollisionCheckingPtr_t
+      create (const DevicePtr_t& robot, const WeighedDistancePtr_t& distance,
+	      const value_type& tolerance, const value_type& stepSize);
+      virtual bool validate (const PathPtr_t& path, bool reverse,
+			     PathPtr_t& validPart);
+      virtual PathValidationPtr_t clone (const DevicePtr_t& robot) const;
+      /// Forget the collision status remembered by the discretized
+      /// collision checking of paths that are not validated continuously
+      virtual void obstaclesChanged ();
+    protected:
+      ContinuousCollisionChecking (const DevicePtr_t& robot,
+				   const WeighedDistancePtr_t& distance,
+				   const value_type& tolerance,
+				   const value_type& stepSize);
+    private:
+      /// Upper bound of the displacement of the robot bodies per unit of
+      /// parameter along a straight path
+      value_type maximalVelocity (const PathPtr_t& path);
+      /// Compute distance to obstacles at a configuration
+      /// \return distance to obstacles, 0 if the robot is in collision,
+      ///         infinity if no distance is computed.
+      value_type distanceToObstacles (ConfigurationIn_t q);
+
+      DevicePtr_t robot_;
+      WeighedDistancePtr_t distance_;
+      value_type tolerance_;
+      value_type stepSize_;
+      DiscretizedCollisionCheckingPtr_t discretized_;
+      Configuration_t q_;
+    }; // class ContinuousCollisionChecking
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_CONTINUOUS_COLLISION_CHECKING_HH
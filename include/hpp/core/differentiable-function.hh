@@ -44,6 +44,8 @@ namespace hpp {
       ///
       /// \retval jacobian jacobian will be stored in this argument
       /// \param argument point at which the jacobian will be computed
+      /// \note columns that are not in activeDerivativeIntervals are zero
+      ///       and might not be written.
       void jacobian (matrixOut_t jacobian, ConfigurationIn_t argument) const
       {
 	assert (argument.size () == inputSize ());
@@ -52,6 +54,26 @@ namespace hpp {
 	impl_jacobian (jacobian, argument);
       }
 
+      /// Get intervals of velocity indices the function depends on
+      ///
+      /// Columns of the jacobian outside these intervals are zero. By
+      /// default, the function depends on all the velocity indices.
+      const SizeIntervals_t& activeDerivativeIntervals () const
+      {
+	return activeDerivativeIntervals_;
+      }
+
+      /// Whether the function may be evaluated by several threads at once
+      ///
+      /// False by default, since functions usually compute the forward
+      /// kinematics of a robot they share with other functions. Functions
+      /// that are not thread safe are evaluated by one thread at a time by
+      /// ConfigProjector::projectBatch.
+      bool threadSafe () const
+      {
+	return threadSafe_;
+      }
+
       /// Get dimension of input vector
       size_type inputSize () const
       {
@@ -108,8 +130,29 @@ namespace hpp {
 			      size_type outputSize,
 			      std::string name = std::string ()) :
 	inputSize_ (inputSize), inputDerivativeSize_ (inputDerivativeSize),
-	outputSize_ (outputSize), name_ (name)
+	outputSize_ (outputSize), name_ (name),
+	activeDerivativeIntervals_ (1, std::make_pair ((size_type) 0,
+						       inputDerivativeSize)),
+	threadSafe_ (false)
+      {
+      }
+
+      /// Declare whether impl_compute and impl_jacobian may be called
+      /// concurrently by several threads
+      void threadSafe (bool threadSafe)
+      {
+	threadSafe_ = threadSafe;
+      }
+
+      /// Set intervals of velocity indices the function depends on
+      ///
+      /// \param intervals sorted disjoint intervals stored as
+      ///        (first index, number of indices).
+      /// impl_jacobian does not need to write columns outside these
+      /// intervals.
+      void activeDerivativeIntervals (const SizeIntervals_t& intervals)
       {
+	activeDerivativeIntervals_ = intervals;
       }
 
       /// User implementation of function evaluation
@@ -127,6 +170,9 @@ namespace hpp {
       /// Dimension of output vector
       size_type outputSize_;
       std::string name_;
+      /// Intervals of velocity indices the function depends on
+      SizeIntervals_t activeDerivativeIntervals_;
+      bool threadSafe_;
     }; // class DifferentiableFunction
     inline std::ostream&
     operator<< (std::ostream& os, const DifferentiableFunction& f)
@@ -52,6 +52,8 @@ namespace hpp {
     private:
       ConfigurationShooterPtr_t configurationShooter_;
       mutable Configuration_t qProj_;
+      /// Random configuration, filled by the shooter at each step
+      ConfigurationPtr_t qRand_;
     };
   } // namespace core
 } // namespace hpp
@@ -19,12 +19,32 @@
 #ifndef HPP_CORE_DISCRETIZED_COLLISION_CHECKING
 # define HPP_CORE_DISCRETIZED_COLLISION_CHECKING
 
+# include <deque>
+# include <map>
+# include <vector>
 # include <hpp/core/path-validation.hh>
 
 namespace hpp {
   namespace core {
     /// Validation of path by collision checking at discretized parameter values
     ///
+    /// validate checks parameters sequentially, isValid checks the middle
+    /// of the path first, then the middles of both halves, and so on.
+    ///
+    /// If enabled (see collisionHints), the pairs of objects found in
+    /// collision last are tested first at each configuration: consecutive
+    /// configurations and shortcuts of a path often collide on the same
+    /// pair, which is then found without testing all the pairs of the
+    /// robot.
+    ///
+    /// In incremental mode (see incrementalKinematics), only the moving part
+    /// of the robot is updated between consecutive configurations of a
+    /// path.
+    ///
+    /// Results of collision tests may be remembered for configurations
+    /// checked again, like the ends of paths between roadmap nodes (see
+    /// validityCache).
+    ///
     /// Should be replaced soon by a better algorithm
     class HPP_CORE_DLLAPI DiscretizedCollisionChecking : public PathValidation
     {
@@ -33,12 +53,175 @@ namespace hpp {
       create (const DevicePtr_t& robot, const value_type& stepSize);
       virtual bool validate (const PathPtr_t& path, bool reverse,
 			     PathPtr_t& validPart);
+      virtual bool isValid (const PathPtr_t& path);
+      virtual PathValidationPtr_t clone (const DevicePtr_t& robot) const;
+      /// Set number of threads used to project configurations
+      ///
+      /// If different from 1, configurations along paths subject to
+      /// numerical constraints are computed by batches with Path::eval,
+      /// the projections of a batch being shared between nbThreads threads
+      /// (0 means one per hardware thread) if the functions of the
+      /// constraints are thread safe (see ConfigProjector::projectBatch).
+      void projectionThreads (std::size_t nbThreads)
+      {
+	projectionThreads_ = nbThreads;
+      }
+      /// Get number of threads used to project configurations
+      std::size_t projectionThreads () const
+      {
+	return projectionThreads_;
+      }
+      /// Set number of colliding pairs remembered, 0 to disable
+      ///
+      /// If not 0, pairs of objects are tested one by one instead of by
+      /// Device::collisionTest, so that the colliding pair is known. By
+      /// default no pair is remembered.
+      void collisionHints (std::size_t nbPairs)
+      {
+	hintCapacity_ = nbPairs;
+	if (hints_.size () > nbPairs) hints_.resize (nbPairs);
+      }
+      /// Get number of colliding pairs remembered
+      std::size_t collisionHints () const
+      {
+	return hintCapacity_;
+      }
+      /// Number of configurations for which remembered pairs were tested
+      std::size_t numberHintTests () const
+      {
+	return numberHintTests_;
+      }
+      /// Number of configurations found in collision by a remembered pair
+      std::size_t numberHintHits () const
+      {
+	return numberHintHits_;
+      }
+      /// Set whether only the moving part of the robot is updated
+      ///
+      /// If true, each configuration along a path is compared to the
+      /// previous configuration checked on the same path, that was
+      /// collision-free. Only the positions of the joints the configuration
+      /// of which changed and of their descendants are computed again, and
+      /// only the pairs of objects one of which is attached to these joints
+      /// are tested: other pairs did not move. The first configuration of
+      /// each path is checked in full.
+      ///
+      /// Paths subject to numerical constraints are always checked in full,
+      /// their projection computing the forward kinematics of the robot.
+      void incrementalKinematics (bool incremental)
+      {
+	incremental_ = incremental;
+      }
+      /// Get whether only the moving part of the robot is updated
+      bool incrementalKinematics () const
+      {
+	return incremental_;
+      }
+      /// Number of configurations checked in incremental mode
+      std::size_t numberIncrementalSamples () const
+      {
+	return numberIncrementalSamples_;
+      }
+      /// Set number of configurations the collision status of which is
+      /// remembered, 0 to disable
+      ///
+      /// Configurations are compared exactly. The oldest configuration is
+      /// forgotten first. Configurations found in the cache are not counted
+      /// by numberSamples. By default the 1000 latest configurations are
+      /// remembered.
+      void validityCache (std::size_t capacity);
+      /// Get number of configurations the collision status of which is
+      /// remembered
+      std::size_t validityCache () const
+      {
+	return cacheCapacity_;
+      }
+      /// Number of configurations found in the cache
+      std::size_t numberCacheHits () const
+      {
+	return numberCacheHits_;
+      }
+      /// Forget the remembered collision status of configurations
+      virtual void obstaclesChanged ();
     protected:
       DiscretizedCollisionChecking (const DevicePtr_t& robot,
 				    const value_type& stepSize);
     private:
+      /// Index in times_ of the first configuration in collision, size of
+      /// times_ if there is none
+      std::size_t firstCollision (const PathPtr_t& path);
+      /// Whether a configuration is in collision, looked up in the cache
+      /// first
+      /// \param incremental whether the configuration follows the last
+      ///        configuration checked on the same path in incremental mode.
+      bool collides (ConfigurationIn_t q, bool incremental);
+      /// Whether a configuration is in collision, without cache
+      bool testCollision (ConfigurationIn_t q, bool incremental);
+      /// Pair of objects found in collision
+      struct CollisionHint {
+	model::BodyPtr_t body;
+	CollisionObjectPtr_t inner;
+	CollisionObjectPtr_t outer;
+      }; // struct CollisionHint
+      /// Whether a remembered pair collides in the current configuration,
+      /// move it first if so
+      bool hintCollides ();
+      /// Test the pairs of objects as Device::collisionTest
+      /// \retval pair the first pair found in collision,
+      /// \return whether a pair is in collision.
+      bool findCollision (CollisionHint& pair);
+      /// Remember a pair found in collision
+      void remember (const CollisionHint& hint);
+      /// Forget the configuration of the previous path, in incremental mode
+      void startIncremental ();
+      /// Whether a configuration is in collision, given that qValid_ is
+      /// collision-free and that the positions of the joints are computed
+      /// for qValid_
+      bool collidesIncrementally (ConfigurationIn_t q);
+      /// Compute the pairs of objects moved_ changes the relative position
+      /// of
+      void computeMovingPairs ();
+      static const std::size_t npos;
       DevicePtr_t robot_;
       value_type stepSize_;
+      std::size_t projectionThreads_;
+      /// Parameters to check
+      std::vector <value_type> times_;
+      /// Configuration along the path
+      Configuration_t q_;
+      /// Parameters and configurations of a batch
+      std::vector <value_type> batchTimes_;
+      matrix_t configurations_;
+      /// Pairs found in collision, the most recent first
+      std::vector <CollisionHint> hints_;
+      std::size_t hintCapacity_;
+      std::size_t numberHintTests_;
+      std::size_t numberHintHits_;
+      /// Incremental mode
+      bool incremental_;
+      std::size_t numberIncrementalSamples_;
+      /// Index in the joint vector of the parent of each joint, npos for
+      /// root joints, and joint vector the indices were computed for
+      std::vector <std::size_t> parents_;
+      JointVector_t joints_;
+      /// Whether qValid_ is the last configuration checked on the current
+      /// path, that the positions of the joints are computed for
+      bool hasReference_;
+      Configuration_t qValid_;
+      /// Whether each joint moved since qValid_, and moving joints the
+      /// pairs of movingPairs_ were computed for
+      std::vector <bool> moved_;
+      std::vector <bool> movingJoints_;
+      std::vector <CollisionHint> movingPairs_;
+      /// Collision status of configurations and order of insertion in the
+      /// cache
+      typedef std::map <std::vector <value_type>, bool> Validity_t;
+      Validity_t cache_;
+      std::deque <Validity_t::iterator> cacheOrder_;
+      std::size_t cacheCapacity_;
+      std::size_t numberCacheHits_;
+      /// Key of the configuration looked up in the cache
+      std::vector <value_type> key_;
     }; // class DiscretizedCollisionChecking
   } // namespace core
 } // namespace hpp
@@ -34,6 +34,41 @@ namespace hpp {
 	return impl_distance (q1, q2);
       }
 
+      /// Square of the distance between two configurations
+      value_type squaredDistance (ConfigurationIn_t q1, ConfigurationIn_t q2)
+      {
+	return impl_squaredDistance (q1, q2);
+      }
+
+      /// Distance between two configurations if not greater than a bound
+      /// \param bound upper bound of the distance,
+      /// \retval distance distance between the configurations if the
+      ///         function returns true, undefined otherwise.
+      /// \return whether the distance is less than or equal to bound.
+      ///
+      /// Derived classes may stop the computation as soon as the bound is
+      /// exceeded.
+      bool distanceBelow (ConfigurationIn_t q1, ConfigurationIn_t q2,
+			  value_type bound, value_type& distance)
+      {
+	return impl_distanceBelow (q1, q2, bound, distance);
+      }
+
+      /// Distances between a configuration and a block of configurations
+      /// \param q configuration,
+      /// \param configurations configurations stored column by column,
+      /// \retval distances distance between q and each column, of size the
+      ///         number of columns.
+      ///
+      /// Evaluates the distances of a whole block with one virtual call.
+      /// Derived classes should give the same values as operator ().
+      void distances (ConfigurationIn_t q, matrixIn_t configurations,
+		      vectorOut_t distances)
+      {
+	assert (distances.size () == configurations.cols ());
+	impl_distances (q, configurations, distances);
+      }
+
       virtual DistancePtr_t clone () const = 0;
       
     protected:
@@ -44,6 +79,33 @@ namespace hpp {
       /// Derived class should implement this function
       virtual value_type impl_distance (ConfigurationIn_t q1,
 				    ConfigurationIn_t q2) = 0;
+
+      /// Default implementation squares impl_distance
+      virtual value_type impl_squaredDistance (ConfigurationIn_t q1,
+					       ConfigurationIn_t q2)
+      {
+	value_type distance = impl_distance (q1, q2);
+	return distance * distance;
+      }
+
+      /// Default implementation compares impl_distance with the bound
+      virtual bool impl_distanceBelow (ConfigurationIn_t q1,
+				       ConfigurationIn_t q2, value_type bound,
+				       value_type& distance)
+      {
+	distance = impl_distance (q1, q2);
+	return distance <= bound;
+      }
+
+      /// Default implementation calls impl_distance for each column
+      virtual void impl_distances (ConfigurationIn_t q,
+				   matrixIn_t configurations,
+				   vectorOut_t distances)
+      {
+	for (size_type j=0; j < configurations.cols (); ++j) {
+	  distances [j] = impl_distance (q, configurations.col (j));
+	}
+      }
     }; // class Distance
   } //   namespace core
 } // namespace hpp
@@ -21,6 +21,7 @@
 
 # include <hpp/core/config.hh>
 # include <hpp/core/fwd.hh>
+# include <hpp/core/path.hh>
 
 namespace hpp {
   namespace core {
@@ -28,11 +29,34 @@ namespace hpp {
     ///
     /// Links two nodes and stores a path linking the configurations stored in
     /// the nodes the edge links.
+    ///
+    /// Edges added by lazy planners store a path that has not been validated
+    /// yet. Only valid edges link the connected components of their nodes.
+    ///
+    /// A reverse edge shares the path of the edge it reverses and extracts
+    /// the reversed path only when it is requested, so that a pair of edges
+    /// stores one path.
     class HPP_CORE_DLLAPI Edge
     {
     public:
+      /// Validation status of the path of an edge
+      enum Status {
+	VALID,
+	UNKNOWN,
+	INVALID
+      };
       Edge (NodePtr_t n1, NodePtr_t n2, const PathPtr_t& path) :
-	n1_ (n1), n2_ (n2), path_ (path)
+	n1_ (n1), n2_ (n2), path_ (path), cost_ (path->length ()),
+	status_ (VALID), reversed_ (false)
+      {
+      }
+      /// Create the reverse edge of an edge
+      ///
+      /// The status is copied.
+      explicit Edge (EdgePtr_t edge) :
+	n1_ (edge->n2_), n2_ (edge->n1_), path_ (edge->path_),
+	cost_ (edge->cost_), status_ (edge->status_),
+	reversed_ (!edge->reversed_)
       {
       }
       NodePtr_t from () const
@@ -43,14 +67,45 @@ namespace hpp {
       {
 	return n2_;
       }
+      /// Path from the configuration of from () to the one of to ()
+      ///
+      /// Reverse edges build a new path at each call.
       PathPtr_t path () const
       {
-	return path_;
+	if (!reversed_) return path_;
+	interval_t timeRange = path_->timeRange ();
+	return path_->extract (interval_t (timeRange.second, timeRange.first));
+      }
+      /// Whether the edge shares the path of the edge it reverses
+      bool reversed () const
+      {
+	return reversed_;
+      }
+      /// Cost of the edge for graph search: length of the path
+      value_type cost () const
+      {
+	return cost_;
+      }
+      /// Get validation status of the path
+      Status status () const
+      {
+	return status_;
+      }
+      /// Set validation status of the path
+      ///
+      /// Use Roadmap::edgeStatus to update the connected components of the
+      /// roadmap accordingly.
+      void status (Status status)
+      {
+	status_ = status;
       }
     private:
       NodePtr_t n1_;
       NodePtr_t n2_;
       PathPtr_t path_;
+      value_type cost_;
+      Status status_;
+      bool reversed_;
     }; // class Edge
   } // namespace core
 } // namespace hpp
@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_FLAT_K_D_TREE_HH
+# define HPP_CORE_FLAT_K_D_TREE_HH
+
+# include <vector>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+# include <hpp/core/nearest-neighbor-search.hh>
+
+namespace hpp {
+  namespace core {
+    /// k-d tree stored in contiguous arrays
+    ///
+    /// Same algorithm as KDTree, but cells are stored in a single vector and
+    /// refer to each other by index. Inner cells only store the split
+    /// dimension and the split value, bounds of a cell are recomputed while
+    /// going down the tree. Leaf cells store the configurations of their
+    /// nodes as columns of a matrix, so that the distances to the nodes of
+    /// a leaf are computed by one call to Distance::distances, without
+    /// dereferencing the nodes.
+    class HPP_CORE_DLLAPI FlatKDTree : public NearestNeighborSearch
+    {
+    public:
+      /// Return shared pointer to new object
+      /// \param robot robot the configurations of which are stored,
+      /// \param distance distance used to compare configurations,
+      /// \param bucketSize maximal number of nodes in a leaf.
+      static FlatKDTreePtr_t create (const DevicePtr_t& robot,
+				     const DistancePtr_t& distance,
+				     size_type bucketSize);
+
+      virtual ~FlatKDTree ()
+      {
+      }
+
+      virtual void addNode (const NodePtr_t& node);
+
+      virtual void clear ();
+
+      virtual NodePtr_t search (const ConfigurationPtr_t& configuration,
+				const ConnectedComponentPtr_t&
+				connectedComponent,
+				value_type& minDistance);
+
+      virtual void search (const ConfigurationPtr_t& configuration,
+			   const ConnectedComponents_t& connectedComponents,
+			   NearestNodes_t& nearest);
+
+      virtual void kNearest (const ConfigurationPtr_t& configuration,
+			     const ConnectedComponentPtr_t& connectedComponent,
+			     std::size_t k, Nodes_t& nodes);
+
+      virtual void withinRadius
+      (const ConfigurationPtr_t& configuration,
+       const ConnectedComponentPtr_t& connectedComponent, value_type radius,
+       Nodes_t& nodes);
+
+      virtual NodePtr_t nearestWithinRadius
+      (const ConfigurationPtr_t& configuration,
+       const ConnectedComponentPtr_t& connectedComponent, value_type radius,
+       value_type& minDistance);
+
+      virtual void merge (ConnectedComponentPtr_t cc1,
+			  ConnectedComponentPtr_t cc2);
+
+      /// Number of cells of the tree
+      std::size_t numberCells () const
+      {
+	return cells_.size ();
+      }
+
+    protected:
+      FlatKDTree (const DevicePtr_t& robot, const DistancePtr_t& distance,
+		  size_type bucketSize);
+
+    private:
+      struct Cell {
+	/// Split dimension and value, meaningless for leaves
+	size_type splitDim;
+	value_type splitValue;
+	/// Children indices in cells_, inner cells only
+	std::size_t infChild;
+	std::size_t supChild;
+	/// Index in leaves_, npos for inner cells
+	std::size_t leaf;
+	/// Sorted list of connected components present in the cell
+	Components_t components;
+      }; // struct Cell
+      struct Leaf {
+	/// Configurations of the nodes stored column by column
+	matrix_t configurations;
+	std::vector <NodePtr_t> nodes;
+	/// Connected component of each node
+	Components_t components;
+      }; // struct Leaf
+      typedef std::vector <Cell> Cells_t;
+      typedef std::vector <Leaf> Leaves_t;
+      static const std::size_t npos;
+
+      /// Create a leaf cell and return its index
+      std::size_t newLeafCell ();
+      /// Split a full leaf cell with given bounds
+      /// \return whether the cell could be split
+      bool split (std::size_t cell, vectorIn_t lower, vectorIn_t upper);
+      /// Add a node at the end of a leaf
+      void pushBack (Leaf& leaf, ConfigurationIn_t q, const NodePtr_t& node,
+		     ConnectedComponent* cc);
+      /// Store in leafDistances_ the distances between a configuration and
+      /// the nodes of a leaf, computed in one call to Distance::distances
+      void leafDistances (const Leaf& leaf, ConfigurationIn_t q);
+      /// Lower bound of the distance between a configuration and the
+      /// side of a split not containing it
+      value_type planeDistance (ConfigurationIn_t q, size_type dim,
+				value_type value);
+      /// Search nearest node closer than minDistance, in all connected
+      /// components if cc is NULL
+      void search (std::size_t cell, value_type boxDistance,
+		   ConfigurationIn_t q, ConnectedComponent* cc,
+		   value_type& minDistance, NodePtr_t& nearest);
+      /// Search nearest node of each connected component in requested_
+      void search (std::size_t cell, value_type boxDistance,
+		   ConfigurationIn_t q);
+      void kNearest (std::size_t cell, value_type boxDistance,
+		     ConfigurationIn_t q, ConnectedComponent* cc,
+		     std::size_t k, NodeQueue_t& queue);
+      void withinRadius (std::size_t cell, value_type boxDistance,
+			 ConfigurationIn_t q, ConnectedComponent* cc,
+			 value_type radius, Nodes_t& nodes);
+      /// Throw if the configuration is not in the root box and initialize
+      /// working memory for a search
+      void initSearch (ConfigurationIn_t q);
+      /// Index of a connected component in requested_, npos if absent
+      std::size_t requestedIndex (ConnectedComponent* cc) const;
+      void merge (std::size_t cell, ConnectedComponent* cc1,
+		  ConnectedComponent* cc2);
+
+      DevicePtr_t robot_;
+      DistancePtr_t distance_;
+      size_type bucketSize_;
+      size_type dim_;
+      /// Bounds of the root cell
+      vector_t lowerBounds_;
+      vector_t upperBounds_;
+      /// type of each dimension as in KDTree
+      std::vector <int> typeDims_;
+      Cells_t cells_;
+      Leaves_t leaves_;
+      /// Working memory
+      vector_t cellLower_;
+      vector_t cellUpper_;
+      vector_t offsets_;
+      Configuration_t qBox_;
+      vector_t leafDistances_;
+      /// Sorted connected components of a multiple search request with
+      /// nearest node and distance for each of them
+      Components_t requested_;
+      std::vector <NodePtr_t> requestedNodes_;
+      std::vector <value_type> requestedDistances_;
+    }; // class FlatKDTree
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_FLAT_K_D_TREE_HH
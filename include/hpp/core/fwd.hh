@@ -23,6 +23,7 @@
 # include <vector>
 # include <deque>
 # include <list>
+# include <map>
 # include <hpp/util/pointer.hh>
 # include <roboptim/core/function.hh>
 # include <hpp/model/fwd.hh>
@@ -38,6 +39,7 @@ namespace hpp {
     HPP_PREDEF_CLASS (ConfigProjector);
     HPP_PREDEF_CLASS (ConnectedComponent);
     HPP_PREDEF_CLASS (Constraint);
+    HPP_PREDEF_CLASS (ContinuousCollisionChecking);
     HPP_PREDEF_CLASS (ConstraintSet);
     HPP_PREDEF_CLASS (DifferentiableFunction);
     HPP_PREDEF_CLASS (DiffusingPlanner);
@@ -45,18 +47,32 @@ namespace hpp {
     HPP_PREDEF_CLASS (DiscretizedCollisionChecking);
     class Edge;
     HPP_PREDEF_CLASS (ExtractedPath);
+    HPP_PREDEF_CLASS (FlatKDTree);
+    HPP_PREDEF_CLASS (GaussianConfigurationShooter);
+    HPP_PREDEF_CLASS (HaltonConfigurationShooter);
+    HPP_PREDEF_CLASS (LazyPrmPlanner);
     HPP_PREDEF_CLASS (LockedDof);
+    HPP_PREDEF_CLASS (NearestNeighborSearch);
     class Node;
+    HPP_PREDEF_CLASS (ParallelDiffusingPlanner);
+    HPP_PREDEF_CLASS (ParallelDiscretizedCollisionChecking);
+    HPP_PREDEF_CLASS (ParallelRandomShortcut);
+    HPP_PREDEF_CLASS (PartialShortcut);
     HPP_PREDEF_CLASS (Path);
     HPP_PREDEF_CLASS (PathOptimizer);
     HPP_PREDEF_CLASS (PathPlanner);
     HPP_PREDEF_CLASS (PathVector);
     HPP_PREDEF_CLASS (PathValidation);
     HPP_PREDEF_CLASS (PlanAndOptimize);
+    HPP_PREDEF_CLASS (PortfolioPlanner);
     HPP_PREDEF_CLASS (Problem);
     class ProblemSolver;
+    HPP_PREDEF_CLASS (RandomGenerator);
     HPP_PREDEF_CLASS (RandomShortcut);
     HPP_PREDEF_CLASS (Roadmap);
+    HPP_PREDEF_CLASS (RrtConnectPlanner);
+    HPP_PREDEF_CLASS (SolveHandle);
+    class Statistics;
     HPP_PREDEF_CLASS (SteeringMethod);
     HPP_PREDEF_CLASS (SteeringMethodStraight);
     HPP_PREDEF_CLASS (StraightPath);
@@ -85,6 +101,8 @@ namespace hpp {
     typedef std::list <ConnectedComponentPtr_t> ConnectedComponents_t;
     typedef boost::shared_ptr <Constraint> ConstraintPtr_t;
     typedef boost::shared_ptr <ConstraintSet> ConstraintSetPtr_t;
+    typedef boost::shared_ptr <ContinuousCollisionChecking>
+    ContinuousCollisionCheckingPtr_t;
     typedef model::Device Device_t;
     typedef model::DevicePtr_t DevicePtr_t;
     typedef model::DeviceWkPtr_t DeviceWkPtr_t;
@@ -98,27 +116,49 @@ namespace hpp {
     typedef Edge* EdgePtr_t;
     typedef std::list <Edge*> Edges_t;
     typedef boost::shared_ptr <ExtractedPath> ExtractedPathPtr_t;
+    typedef boost::shared_ptr <FlatKDTree> FlatKDTreePtr_t;
+    typedef boost::shared_ptr <GaussianConfigurationShooter>
+    GaussianConfigurationShooterPtr_t;
+    typedef boost::shared_ptr <HaltonConfigurationShooter>
+    HaltonConfigurationShooterPtr_t;
     typedef model::JointJacobian_t JointJacobian_t;
     typedef model::HalfJointJacobian_t HalfJointJacobian_t;
+    typedef model::JointPtr_t JointPtr_t;
     typedef model::JointVector_t JointVector_t;
+    typedef boost::shared_ptr <LazyPrmPlanner> LazyPrmPlannerPtr_t;
     typedef boost::shared_ptr <LockedDof> LockedDofPtr_t;
     typedef model::matrix_t matrix_t;
     typedef Eigen::Ref <const matrix_t> matrixIn_t;
     typedef Eigen::Ref <matrix_t> matrixOut_t;
+    typedef boost::shared_ptr <NearestNeighborSearch>
+    NearestNeighborSearchPtr_t;
     typedef std::list <Node*> Nodes_t;
     typedef std::list <Node*> Nodes_t;
     typedef Node* NodePtr_t;
+    typedef std::map <ConnectedComponentPtr_t,
+		      std::pair <NodePtr_t, value_type> > NearestNodes_t;
     typedef model::ObjectVector_t ObjectVector_t;
+    typedef boost::shared_ptr <ParallelDiffusingPlanner>
+    ParallelDiffusingPlannerPtr_t;
+    typedef boost::shared_ptr <ParallelDiscretizedCollisionChecking>
+    ParallelDiscretizedCollisionCheckingPtr_t;
+    typedef boost::shared_ptr <ParallelRandomShortcut>
+    ParallelRandomShortcutPtr_t;
+    typedef boost::shared_ptr <PartialShortcut> PartialShortcutPtr_t;
     typedef boost::shared_ptr <Path> PathPtr_t;
     typedef boost::shared_ptr <PathOptimizer> PathOptimizerPtr_t;
     typedef boost::shared_ptr <PathPlanner> PathPlannerPtr_t;
     typedef boost::shared_ptr <PathValidation> PathValidationPtr_t;
     typedef boost::shared_ptr <PathVector> PathVectorPtr_t;
     typedef boost::shared_ptr <PlanAndOptimize> PlanAndOptimizePtr_t;
+    typedef boost::shared_ptr <PortfolioPlanner> PortfolioPlannerPtr_t;
     typedef Problem* ProblemPtr_t;
     typedef ProblemSolver* ProblemSolverPtr_t;
+    typedef boost::shared_ptr <RandomGenerator> RandomGeneratorPtr_t;
     typedef boost::shared_ptr <RandomShortcut> RandomShortcutPtr_t;
     typedef boost::shared_ptr <Roadmap> RoadmapPtr_t;
+    typedef boost::shared_ptr <RrtConnectPlanner> RrtConnectPlannerPtr_t;
+    typedef boost::shared_ptr <SolveHandle> SolveHandlePtr_t;
     typedef boost::shared_ptr <StraightPath> StraightPathPtr_t;
     typedef boost::shared_ptr <SteeringMethod> SteeringMethodPtr_t;
     typedef boost::shared_ptr <SteeringMethodStraight>
@@ -126,6 +166,8 @@ namespace hpp {
     typedef roboptim::StableTimePoint StableTimePoint_t;
     typedef std::vector <PathPtr_t> Paths_t;
     typedef std::vector <PathVectorPtr_t> PathVectors_t;
+    /// Intervals of indices stored as (first index, number of indices)
+    typedef std::vector <std::pair <size_type, size_type> > SizeIntervals_t;
     typedef model::vector_t vector_t;
     typedef model::vectorIn_t vectorIn_t;
     typedef model::vectorOut_t vectorOut_t;
@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_GAUSSIAN_CONFIGURATION_SHOOTER_HH
+# define HPP_CORE_GAUSSIAN_CONFIGURATION_SHOOTER_HH
+
+# include <hpp/core/configuration-shooter.hh>
+
+namespace hpp {
+  namespace core {
+    /// Sampling of configurations close to obstacles
+    ///
+    /// A uniformly sampled configuration q1 is paired with a configuration
+    /// q2 at a distance that follows a normal distribution of given
+    /// standard deviation, in a uniformly sampled direction.
+    /// \li In Gaussian mode, if exactly one of q1 and q2 is in collision,
+    ///     the other one is returned,
+    /// \li in bridge test mode, if q1 and q2 are both in collision and the
+    ///     configuration in the middle is not, the latter is returned.
+    ///
+    /// Otherwise, a new pair is drawn. After a maximal number of trials, a
+    /// uniformly sampled configuration is returned, so that the shooter
+    /// still covers free space far from obstacles.
+    class HPP_CORE_DLLAPI GaussianConfigurationShooter :
+      public ConfigurationShooter
+    {
+    public:
+      /// Create a shooter
+      /// \param robot robot the configurations of which are sampled,
+      /// \param distance distance used to scale the pairs of configurations,
+      /// \param standardDeviation standard deviation of the distance
+      ///        between the configurations of a pair,
+      /// \param generator random generator of the shooter.
+      static GaussianConfigurationShooterPtr_t create
+	(const DevicePtr_t& robot, const DistancePtr_t& distance,
+	 value_type standardDeviation, const RandomGeneratorPtr_t& generator);
+
+      virtual ConfigurationPtr_t shoot () const;
+
+      virtual void shoot (ConfigurationOut_t configuration) const;
+
+      /// Set whether the shooter performs bridge tests
+      void bridgeTest (bool bridgeTest)
+      {
+	bridgeTest_ = bridgeTest;
+      }
+
+      /// Get whether the shooter performs bridge tests
+      bool bridgeTest () const
+      {
+	return bridgeTest_;
+      }
+
+      /// Set the maximal number of pairs drawn before a uniform sample is
+      /// returned
+      void maxTrials (std::size_t maxTrials)
+      {
+	maxTrials_ = maxTrials;
+      }
+
+      /// Get the maximal number of pairs drawn before a uniform sample is
+      /// returned
+      std::size_t maxTrials () const
+      {
+	return maxTrials_;
+      }
+
+    protected:
+      GaussianConfigurationShooter (const DevicePtr_t& robot,
+				    const DistancePtr_t& distance,
+				    value_type standardDeviation,
+				    const RandomGeneratorPtr_t& generator);
+
+      /// Whether a configuration is in collision
+      ///
+      /// Uses the collision test of the robot.
+      virtual bool collides (ConfigurationIn_t configuration) const;
+
+    private:
+      /// Interpolate joint by joint between two configurations
+      void interpolate (ConfigurationIn_t q1, ConfigurationIn_t q2,
+			value_type u, ConfigurationOut_t result) const;
+
+      DevicePtr_t robot_;
+      DistancePtr_t distance_;
+      value_type standardDeviation_;
+      RandomGeneratorPtr_t generator_;
+      ConfigurationShooterPtr_t uniform_;
+      bool bridgeTest_;
+      std::size_t maxTrials_;
+      /// Working memory
+      mutable Configuration_t q1_;
+      mutable Configuration_t q2_;
+    }; // class GaussianConfigurationShooter
+  } //   namespace core
+} // namespace hpp
+#endif // HPP_CORE_GAUSSIAN_CONFIGURATION_SHOOTER_HH
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_HALTON_CONFIGURATION_SHOOTER_HH
+# define HPP_CORE_HALTON_CONFIGURATION_SHOOTER_HH
+
+# include <vector>
+# include <hpp/core/configuration-shooter.hh>
+
+namespace hpp {
+  namespace core {
+    /// Deterministic low-dispersion sampling of the configuration space
+    ///
+    /// The n-th configuration is built from the n-th point of the Halton
+    /// sequence, with one prime base per sampled coordinate. Degrees of
+    /// freedom of translations and rotations are mapped to the same bounds
+    /// as KDTree, SO3 joints use three coordinates mapped to a unit
+    /// quaternion. Other joints are sampled by their joint configuration.
+    ///
+    /// Successive configurations cover the configuration space more evenly
+    /// than uniform random samples, and two shooters created for the same
+    /// robot shoot the same sequence.
+    class HPP_CORE_DLLAPI HaltonConfigurationShooter :
+      public ConfigurationShooter
+    {
+    public:
+      /// Create a shooter starting at the beginning of the sequence
+      static HaltonConfigurationShooterPtr_t create (const DevicePtr_t& robot);
+
+      virtual ConfigurationPtr_t shoot () const;
+
+      virtual void shoot (ConfigurationOut_t configuration) const;
+
+      /// Index in the Halton sequence of the next configuration
+      std::size_t index () const
+      {
+	return index_;
+      }
+
+      /// Set index in the Halton sequence of the next configuration
+      ///
+      /// Index 0 maps to the lower bounds of all the coordinates and is
+      /// skipped by default.
+      void index (std::size_t index)
+      {
+	index_ = index;
+      }
+
+      /// Number of coordinates of the Halton sequence
+      std::size_t dimension () const
+      {
+	return bases_.size ();
+      }
+
+    protected:
+      HaltonConfigurationShooter (const DevicePtr_t& robot);
+
+    private:
+      /// Radical inverse of an index in a base
+      static value_type radicalInverse (std::size_t index, std::size_t base);
+
+      DevicePtr_t robot_;
+      /// Prime base of each coordinate
+      std::vector <std::size_t> bases_;
+      mutable std::size_t index_;
+    }; // class HaltonConfigurationShooter
+  } //   namespace core
+} // namespace hpp
+#endif // HPP_CORE_HALTON_CONFIGURATION_SHOOTER_HH
@@ -19,17 +19,19 @@
 #ifndef HPP_CORE_K_D_TREE_HH
 # define HPP_CORE_K_D_TREE_HH
 
+# include <vector>
 # include <hpp/core/distance.hh>
 # include <hpp/core/node.hh>
 # include <hpp/model/joint.hh>
 # include <hpp/model/joint-configuration.hh>
 # include <hpp/model/device.hh>
 # include <hpp/core/fwd.hh>
+# include <hpp/core/nearest-neighbor-search.hh>
 
 namespace hpp {
   namespace core {
     // Built an k-dimentional tree for the nearest neighbour research
-    class KDTree
+    class KDTree : public NearestNeighborSearch
     {
       // typedef KDTree* KDTreePtr_t;
     public:
@@ -40,29 +42,70 @@ namespace hpp {
 	     int bucketSize);
 
       //destructor
-      ~KDTree();
+      virtual ~KDTree();
 
       // add a configuration in the KDTree
-      void addNode(const NodePtr_t& node);
+      virtual void addNode(const NodePtr_t& node);
+
+      // add several configurations and build the KDTree again with all
+      // the nodes, so that it is balanced
+      virtual void addNodes(const Nodes_t& nodes);
 
       // Clear all the nodes in the KDTree
-      void clear();
+      virtual void clear();
 
       // search nearest node
-      NodePtr_t search(const ConfigurationPtr_t& configuration,
-		       const ConnectedComponentPtr_t& connectedComponent,
-		       value_type& minDistance);
+      virtual NodePtr_t search(const ConfigurationPtr_t& configuration,
+			       const ConnectedComponentPtr_t& connectedComponent,
+			       value_type& minDistance);
+
+      // search nearest node in each connected component in one traversal
+      virtual void search(const ConfigurationPtr_t& configuration,
+			  const ConnectedComponents_t& connectedComponents,
+			  NearestNodes_t& nearest);
+
+      // search k nearest nodes
+      virtual void kNearest(const ConfigurationPtr_t& configuration,
+			    const ConnectedComponentPtr_t& connectedComponent,
+			    std::size_t k, Nodes_t& nodes);
+
+      // search nodes within a ball
+      virtual void withinRadius(const ConfigurationPtr_t& configuration,
+				const ConnectedComponentPtr_t&
+				connectedComponent,
+				value_type radius, Nodes_t& nodes);
+
+      // search nearest node closer than a radius
+      virtual NodePtr_t nearestWithinRadius
+      (const ConfigurationPtr_t& configuration,
+       const ConnectedComponentPtr_t& connectedComponent, value_type radius,
+       value_type& minDistance);
 
       // merge two connected components in the whole tree
-      void merge(ConnectedComponentPtr_t cc1, ConnectedComponentPtr_t cc2);
+      virtual void merge(ConnectedComponentPtr_t cc1,
+			 ConnectedComponentPtr_t cc2);
+
+      // depth of the deepest leaf, 0 if the root is a leaf
+      unsigned int depth() const;
+
+      // number of subtrees rebuilt to be balanced again
+      std::size_t numberRebuilds() const
+      {
+	return numberRebuilds_;
+      }
 
     private:
+      typedef std::vector <NodePtr_t> NodeVector_t;
+
       DevicePtr_t robot_;
       int dim_;
 
       DistancePtr_t distance_;
       typedef std::map <ConnectedComponentPtr_t, Nodes_t> NodesMap_t;
+      // nodes of the leaf by connected component, empty for inner cells
       NodesMap_t nodesMap_;
+      // connected components present in the cell
+      Components_t components_;
       unsigned int bucketSize_;
       unsigned int bucket_;
 
@@ -71,7 +114,7 @@ namespace hpp {
       vector_t upperBounds_;
       vector_t lowerBounds_;
 
-      // type of each dimention
+      // root only: type of each dimention
       //	0 => bounded dimention
       //	1 => looped dimention
       //	2 => quaternion
@@ -80,27 +123,105 @@ namespace hpp {
       KDTreePtr_t supChild_;
       KDTreePtr_t infChild_;
 
-      // Split the node into two subnodes
-      void split();
+      // root of the tree, holds the search counters
+      KDTreePtr_t root_;
+
+      // depth of the cell, 0 for the root
+      unsigned int depth_;
+      // number of nodes in the subtree
+      std::size_t size_;
+
+      // root only: rank of the joint of each dimension, first dimension of
+      // this joint and number of rebuilds
+      std::vector <std::size_t> jointRanks_;
+      std::vector <int> firstDims_;
+      std::size_t numberRebuilds_;
+      // root only: working memory of the box distances
+      Configuration_t qBox_;
+
+      // insert a node in the leaf containing it, split the leaf if full
+      // retval path cells from the root to the leaf
+      void insert(const NodePtr_t& node, std::vector <KDTreePtr_t>& path);
+
+      // Split a full leaf into two subnodes, return false if the nodes
+      // cannot be separated
+      bool split();
 
-      // find the leaf of the KDtree for the configuration/node.
-      // starts the research at KDTree then go down the tree.
-      // also add connectedComopnent of node along the path from tree
-      // root to tree leaf
-      KDTreePtr_t findLeaf(const NodePtr_t& node);
+      // choose the split dimension and value of a set of nodes: the
+      // dimension of largest weighed spread and the median of the nodes
+      // along this dimension. Return false if all the nodes have the same
+      // configuration.
+      bool chooseSplit(NodeVector_t::iterator begin,
+		       NodeVector_t::iterator end,
+		       int& splitDim, value_type& splitValue) const;
+
+      // create the children of an empty leaf and distribute the nodes
+      void divide(NodeVector_t::iterator begin, NodeVector_t::iterator end,
+		  int splitDim, value_type splitValue);
+
+      // build a balanced subtree with the nodes in an empty leaf
+      void build(NodeVector_t::iterator begin, NodeVector_t::iterator end);
+
+      // append the nodes of the subtree
+      void collect(NodeVector_t& nodes) const;
+
+      // rebuild the subtree of the deepest unbalanced cell of a path if
+      // the path is too long (scapegoat tree)
+      void rebalance(const std::vector <KDTreePtr_t>& path);
+
+      // build the subtree again with the same nodes
+      void rebuild();
 
       // find bounds on each dimention
       void findDeviceBounds();
 
-      // distance to the nearest bound on the splited dimention
+      // lower bound of the distance to the box along the splited
+      // dimention, or along the quaternion it belongs to
       value_type distanceToBox(const ConfigurationPtr_t& configuration);
 
+      // lower bound of the distance to the box of the quaternion
+      // containing the splited dimention
+      value_type distanceToQuaternionBox(const Configuration_t& q);
+
+      // distances to the boxes of the children, one of them is zero when
+      // boxDistance is zero
+      void distanceToChildren(const ConfigurationPtr_t& configuration,
+			      value_type boxDistance,
+			      value_type& distanceToInfChild,
+			      value_type& distanceToSupChild);
+
       // search nearest node
       void search(value_type boxDistance, value_type& minDistance,
 		  const ConfigurationPtr_t& configuration,
 		  const ConnectedComponentPtr_t& connectedComponent,
 		  NodePtr_t& nearest);
 
+      // search nearest node in each connected component
+      void search(value_type boxDistance,
+		  const ConfigurationPtr_t& configuration,
+		  NearestNodes_t& nearest);
+
+      // search k nearest nodes
+      void kNearest(value_type boxDistance,
+		    const ConfigurationPtr_t& configuration,
+		    const ConnectedComponentPtr_t& connectedComponent,
+		    std::size_t k, NodeQueue_t& queue);
+
+      // search nodes within a ball
+      void withinRadius(value_type boxDistance,
+			const ConfigurationPtr_t& configuration,
+			const ConnectedComponentPtr_t& connectedComponent,
+			value_type radius, Nodes_t& nodes);
+
+      // search nearest node closer than minDistance, in all connected
+      // components if connectedComponent is NULL
+      void nearestWithinRadius(value_type boxDistance, value_type& minDistance,
+			       const ConfigurationPtr_t& configuration,
+			       const ConnectedComponentPtr_t&
+			       connectedComponent, NodePtr_t& nearest);
+
+      // throw if the configuration is not in the root box
+      void checkRootBox(const ConfigurationPtr_t& configuration) const;
 
     };
   }
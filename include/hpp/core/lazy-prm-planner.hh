@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_LAZY_PRM_PLANNER_HH
+# define HPP_CORE_LAZY_PRM_PLANNER_HH
+
+# include <hpp/core/edge.hh>
+# include <hpp/core/path-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// Lazy probabilistic roadmap
+    ///
+    /// Each step adds a valid random configuration to the roadmap, linked to
+    /// the nearest nodes of the roadmap, whatever their connected component,
+    /// by edges the paths of which are not validated (see
+    /// Roadmap::addLazyEdge). The nodes are found by one k nearest
+    /// neighbor query over all the nodes, since lazy edges do not merge
+    /// connected components and most components contain one node. A* then
+    /// searches
+    /// a path through valid and unvalidated edges from the initial node to
+    /// a goal node. Only the paths of the edges of this candidate path are
+    /// validated, invalid edges are ignored by the following searches, until
+    /// a fully valid path is found or no candidate is left.
+    ///
+    /// Most paths of the roadmap are thus never validated, which is worth
+    /// when path validation is much more expensive than graph search.
+    class HPP_CORE_DLLAPI LazyPrmPlanner : public PathPlanner
+    {
+    public:
+      /// Return shared pointer to new object.
+      static LazyPrmPlannerPtr_t createWithRoadmap
+	(const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Return shared pointer to new object.
+      static LazyPrmPlannerPtr_t create (const Problem& problem);
+      /// Add a node and validate candidate paths
+      virtual void oneStep ();
+      /// Do nothing.
+      virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
+
+      /// Set configuration shooter.
+      void configurationShooter (const ConfigurationShooterPtr_t& shooter);
+
+      /// Set number of nearest nodes a new node is linked to
+      void numberNeighbors (std::size_t k)
+      {
+	numberNeighbors_ = k;
+      }
+      /// Get number of nearest nodes a new node is linked to
+      std::size_t numberNeighbors () const
+      {
+	return numberNeighbors_;
+      }
+    protected:
+      /// Constructor
+      LazyPrmPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Constructor with roadmap
+      LazyPrmPlanner (const Problem& problem);
+      /// Whether a configuration is valid
+      ///
+      /// Validates the path of length 0 the steering method returns.
+      virtual bool isValid (const ConfigurationPtr_t& configuration);
+    private:
+      /// Validate the edges of candidate paths until a valid path is found
+      /// or no candidate is left
+      void validateCandidates ();
+      /// Set the status of an edge and of the reverse edge
+      void edgeStatus (const EdgePtr_t& edge, Edge::Status status);
+
+      ConfigurationShooterPtr_t configurationShooter_;
+      std::size_t numberNeighbors_;
+    }; // class LazyPrmPlanner
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_LAZY_PRM_PLANNER_HH
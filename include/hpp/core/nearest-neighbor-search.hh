@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_NEAREST_NEIGHBOR_SEARCH_HH
+# define HPP_CORE_NEAREST_NEIGHBOR_SEARCH_HH
+
+# include <algorithm>
+# include <limits>
+# include <queue>
+# include <vector>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// Abstraction of nearest neighbor search in a roadmap
+    ///
+    /// Stores the nodes of a roadmap sorted by connected component and
+    /// answers nearest node requests restricted to one connected component.
+    /// KDTree and FlatKDTree are the available implementations.
+    class HPP_CORE_DLLAPI NearestNeighborSearch
+    {
+    public:
+      virtual ~NearestNeighborSearch ()
+      {
+      }
+      /// Add a node
+      virtual void addNode (const NodePtr_t& node) = 0;
+
+      /// Add several nodes
+      ///
+      /// Default implementation calls addNode for each node. Derived classes
+      /// may build the data-structure at once.
+      virtual void addNodes (const Nodes_t& nodes)
+      {
+	for (Nodes_t::const_iterator itNode = nodes.begin ();
+	     itNode != nodes.end (); ++itNode) {
+	  addNode (*itNode);
+	}
+      }
+
+      /// Remove all the nodes
+      virtual void clear () = 0;
+
+      /// Get nearest node to a configuration in a connected component
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component
+      /// \retval minDistance distance to the nearest node.
+      /// \return nearest node or NULL if the connected component is empty.
+      virtual NodePtr_t search (const ConfigurationPtr_t& configuration,
+				const ConnectedComponentPtr_t&
+				connectedComponent,
+				value_type& minDistance) = 0;
+
+      /// Get nearest node to a configuration in each connected component
+      /// \param configuration configuration
+      /// \param connectedComponents connected components to search in
+      /// \retval nearest for each connected component, nearest node and
+      ///         distance to this node.
+      ///
+      /// Default implementation calls search for each connected component.
+      /// Derived classes should answer the request in one traversal of
+      /// the data-structure.
+      virtual void search (const ConfigurationPtr_t& configuration,
+			   const ConnectedComponents_t& connectedComponents,
+			   NearestNodes_t& nearest)
+      {
+	nearest.clear ();
+	for (ConnectedComponents_t::const_iterator itcc =
+	       connectedComponents.begin ();
+	     itcc != connectedComponents.end (); ++itcc) {
+	  std::pair <NodePtr_t, value_type>& result (nearest [*itcc]);
+	  result.first = search (configuration, *itcc, result.second);
+	}
+      }
+
+      /// Get the k nearest nodes to a configuration in a connected component
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component, NULL to search
+      ///        all the nodes,
+      /// \param k number of nodes,
+      /// \retval nodes nearest nodes sorted by increasing distance. Less than
+      ///         k nodes are returned if the connected component is smaller.
+      virtual void kNearest (const ConfigurationPtr_t& configuration,
+			     const ConnectedComponentPtr_t& connectedComponent,
+			     std::size_t k, Nodes_t& nodes) = 0;
+
+      /// Get nodes of a connected component within a given distance
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component
+      /// \param radius maximal distance to the configuration,
+      /// \retval nodes nodes at distance less than or equal to radius, in no
+      ///         particular order.
+      virtual void withinRadius
+      (const ConfigurationPtr_t& configuration,
+       const ConnectedComponentPtr_t& connectedComponent, value_type radius,
+       Nodes_t& nodes) = 0;
+
+      /// Get nearest node to a configuration closer than a given distance
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component, NULL to search
+      ///        all the nodes,
+      /// \param radius maximal distance to the configuration,
+      /// \retval minDistance distance to the nearest node, radius if none.
+      /// \return nearest node at distance less than radius, NULL if none.
+      ///
+      /// The radius bounds the search from the beginning of the traversal,
+      /// so that small radii are much cheaper than a nearest node search.
+      /// Used to detect duplicate nodes.
+      virtual NodePtr_t nearestWithinRadius
+      (const ConfigurationPtr_t& configuration,
+       const ConnectedComponentPtr_t& connectedComponent, value_type radius,
+       value_type& minDistance) = 0;
+
+      /// Merge two connected components
+      ///
+      /// \param cc1 connected component that receives the nodes,
+      /// \param cc2 connected component that disappears.
+      virtual void merge (ConnectedComponentPtr_t cc1,
+			  ConnectedComponentPtr_t cc2) = 0;
+
+      /// Set approximation of the nearest node searches
+      /// \param epsilon search and kNearest return nodes at distance at
+      ///        most (1 + epsilon) times the distance of the exact result,
+      /// \param maxLeaves maximal number of leaves visited by a search, 0
+      ///        for no limit.
+      ///
+      /// Cells that cannot improve the result by more than (1 + epsilon)
+      /// are not explored, which saves most of the visits in high
+      /// dimension. Limiting the number of leaves bounds the time of a
+      /// search but gives no guarantee on the result. withinRadius and
+      /// nearestWithinRadius are always exact. By default searches are exact.
+      void approximation (value_type epsilon, std::size_t maxLeaves)
+      {
+	epsilon_ = epsilon;
+	maxLeaves_ = maxLeaves;
+      }
+
+      /// Approximation factor of the nearest node searches
+      value_type epsilon () const
+      {
+	return epsilon_;
+      }
+
+      /// Maximal number of leaves visited by a search, 0 for no limit
+      std::size_t maxLeaves () const
+      {
+	return maxLeaves_;
+      }
+
+      /// Number of cells visited by the searches since creation
+      std::size_t numberVisits () const
+      {
+	return numberVisits_;
+      }
+
+      /// Number of distances to nodes evaluated by the searches since
+      /// creation
+      std::size_t numberDistances () const
+      {
+	return numberDistances_;
+      }
+    protected:
+      /// Sorted vector of connected components, used by cells of the
+      /// derived classes to tell which connected components they contain
+      typedef std::vector <ConnectedComponent*> Components_t;
+      /// Priority queue of nodes, the farthest node is on top
+      typedef std::priority_queue <std::pair <value_type, NodePtr_t> >
+	NodeQueue_t;
+
+      NearestNeighborSearch () : numberVisits_ (0), numberDistances_ (0),
+				 epsilon_ (0), maxLeaves_ (0), pruneFactor_ (1),
+				 leafBudget_ (0)
+      {
+      }
+
+      /// Initialize pruneFactor_ and leafBudget_ for a search
+      /// \param approximate whether the search may be approximated
+      void startSearch (bool approximate)
+      {
+	if (approximate) {
+	  pruneFactor_ = (1 + epsilon_) * (1 + epsilon_);
+	  leafBudget_ = maxLeaves_ == 0 ?
+	    std::numeric_limits <std::size_t>::max () : maxLeaves_;
+	} else {
+	  pruneFactor_ = 1;
+	  leafBudget_ = std::numeric_limits <std::size_t>::max ();
+	}
+      }
+
+      /// Insert a node in a queue bounded to k elements
+      static void push (NodeQueue_t& queue, std::size_t k, value_type distance,
+			const NodePtr_t& node)
+      {
+	if (queue.size () < k) {
+	  queue.push (std::make_pair (distance, node));
+	} else if (distance < queue.top ().first) {
+	  queue.pop ();
+	  queue.push (std::make_pair (distance, node));
+	}
+      }
+
+      /// Distance of the farthest node of a queue bounded to k elements,
+      /// infinity if the queue is not full
+      static value_type bound (const NodeQueue_t& queue, std::size_t k)
+      {
+	if (queue.size () < k) {
+	  return std::numeric_limits <value_type>::infinity ();
+	}
+	return queue.top ().first;
+      }
+
+      /// Insert a connected component in a sorted vector if not already
+      /// present
+      static void insertComponent (Components_t& components,
+				   ConnectedComponent* cc)
+      {
+	Components_t::iterator it =
+	  std::lower_bound (components.begin (), components.end (), cc);
+	if (it == components.end () || *it != cc) {
+	  components.insert (it, cc);
+	}
+      }
+
+      /// Whether a sorted vector contains a connected component
+      static bool hasComponent (const Components_t& components,
+				ConnectedComponent* cc)
+      {
+	return std::binary_search (components.begin (), components.end (),
+				   cc);
+      }
+
+      /// Empty a queue into a list of nodes sorted by increasing distance
+      static void sort (NodeQueue_t& queue, Nodes_t& nodes)
+      {
+	nodes.clear ();
+	while (!queue.empty ()) {
+	  nodes.push_front (queue.top ().second);
+	  queue.pop ();
+	}
+      }
+
+      /// Counters incremented by derived classes
+      std::size_t numberVisits_;
+      std::size_t numberDistances_;
+      /// Approximation parameters
+      value_type epsilon_;
+      std::size_t maxLeaves_;
+      /// Working memory of a search: squared distances of cells are
+      /// multiplied by pruneFactor_ before being compared to the current
+      /// result, leafBudget_ is the number of leaves that may still be
+      /// visited.
+      value_type pruneFactor_;
+      std::size_t leafBudget_;
+    }; // class NearestNeighborSearch
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_NEAREST_NEIGHBOR_SEARCH_HH
@@ -43,19 +43,66 @@ namespace hpp {
 	    ConnectedComponentPtr_t connectedComponent);
       void addOutEdge (EdgePtr_t edge);
       void addInEdge (EdgePtr_t edge);
+      /// Remove an edge starting from the node
+      void removeOutEdge (EdgePtr_t edge);
+      /// Remove an edge ending at the node
+      void removeInEdge (EdgePtr_t edge);
       /// Store the connected component the node belongs to
       void connectedComponent (const ConnectedComponentPtr_t& cc);
+      /// Get the connected component the node belongs to
+      ///
+      /// Connected components the stored one has been merged into are
+      /// taken into account.
       ConnectedComponentPtr_t connectedComponent () const;
       /// Access to outEdges
       const Edges_t& outEdges () const;
       /// Access to inEdges
       const Edges_t& inEdges () const;
       ConfigurationPtr_t configuration () const;
+      /// Rank of the node in the roadmap
+      ///
+      /// Used by graph search algorithms to store data about nodes in
+      /// vectors.
+      std::size_t index () const
+      {
+	return index_;
+      }
+      /// Set rank of the node in the roadmap
+      void index (std::size_t index)
+      {
+	index_ = index;
+      }
+      /// \name Cached distance to goal nodes
+      /// \{
+
+      /// Get cached distance to the nearest goal node
+      /// \param revision current goal revision of the roadmap,
+      /// \retval distance cached distance if any.
+      /// \return whether the cached distance was computed for this revision.
+      bool cachedDistanceToGoal (std::size_t revision, value_type& distance)
+	const
+      {
+	if (goalRevision_ != revision) return false;
+	distance = distanceToGoal_;
+	return true;
+      }
+      /// Store distance to the nearest goal node
+      /// \param revision current goal revision of the roadmap,
+      /// \param distance distance to store.
+      void cacheDistanceToGoal (std::size_t revision, value_type distance)
+      {
+	goalRevision_ = revision;
+	distanceToGoal_ = distance;
+      }
+      /// \}
     private:
       ConfigurationPtr_t configuration_;
       Edges_t outEdges_;
       Edges_t inEdges_;
       ConnectedComponentPtr_t connectedComponent_;
+      std::size_t index_;
+      value_type distanceToGoal_;
+      std::size_t goalRevision_;
     }; // class Node
   } //   namespace core
 } // namespace hpp
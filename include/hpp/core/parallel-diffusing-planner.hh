@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_PARALLEL_DIFFUSING_PLANNER_HH
+# define HPP_CORE_PARALLEL_DIFFUSING_PLANNER_HH
+
+# include <string>
+# include <vector>
+# include <boost/thread/mutex.hpp>
+# include <hpp/core/path-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// Multi-threaded implementation of RRT algorithm
+    ///
+    /// Same extension step as DiffusingPlanner, performed concurrently by
+    /// a pool of worker threads inserting nodes in the same roadmap. Each
+    /// worker owns a copy of the robot, a configuration shooter and a path
+    /// validation created by PathValidation::clone for the copy of the
+    /// robot. solve returns as soon as a worker connects the initial
+    /// node to a goal node or when the budget of the resolution is
+    /// exhausted.
+    ///
+    /// \note If the path validation of the problem cannot be cloned, or if
+    ///       the steering method is subject to numerical constraints,
+    ///       extension and validation of paths are performed one at a time.
+    class HPP_CORE_DLLAPI ParallelDiffusingPlanner : public PathPlanner
+    {
+    public:
+      /// Return shared pointer to new object.
+      /// \param problem the path planning problem,
+      /// \param nbThreads number of threads, if 0 use the number of hardware
+      ///        threads.
+      static ParallelDiffusingPlannerPtr_t create (const Problem& problem,
+						   std::size_t nbThreads = 0);
+      /// Return shared pointer to new object.
+      static ParallelDiffusingPlannerPtr_t createWithRoadmap
+	(const Problem& problem, const RoadmapPtr_t& roadmap,
+	 std::size_t nbThreads = 0);
+      /// Initialize the problem resolution and the workers
+      virtual void startSolve ();
+      /// One step of extension performed by the first worker
+      virtual void oneStep ();
+      /// Do nothing.
+      virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
+      /// Number of worker threads
+      std::size_t numberThreads () const
+      {
+	return workers_.size ();
+      }
+      /// Statistics of the resolution summed over the workers
+      virtual const Statistics& statistics () const;
+    protected:
+      /// Constructor
+      ParallelDiffusingPlanner (const Problem& problem,
+				const RoadmapPtr_t& roadmap,
+				std::size_t nbThreads);
+      /// Constructor with roadmap
+      ParallelDiffusingPlanner (const Problem& problem,
+				std::size_t nbThreads);
+      /// Run worker threads until a path is found or the budget is
+      /// exhausted
+      ///
+      /// Steps of all the workers count in the iteration budget.
+      /// \throw std::runtime_error if a worker failed.
+      virtual Status plan (PathVectorPtr_t& path);
+    private:
+      /// Data owned by a worker thread
+      struct Worker {
+	DevicePtr_t robot;
+	ConfigurationShooterPtr_t configurationShooter;
+	PathValidationPtr_t pathValidation;
+	/// Whether extension and validation need to lock sharedMutex_
+	bool shared;
+	Configuration_t qProj;
+	/// Random configuration, filled by the shooter at each step
+	ConfigurationPtr_t qRand;
+	/// Phases timed by the worker
+	Statistics statistics;
+      }; // struct Worker
+      typedef std::vector <Worker> Workers_t;
+
+      /// Copy the robot and create shooters and path validations
+      void initWorkers ();
+      /// Main loop of thread of given rank
+      void work (std::size_t rank);
+      /// One step of extension with objects of a worker
+      void step (Worker& worker);
+      /// Extend a node in the direction of a configuration
+      PathPtr_t extend (Worker& worker, const NodePtr_t& near,
+			ConfigurationIn_t target);
+      /// Validate a path with the path validation of a worker
+      bool validate (Worker& worker, const PathPtr_t& path,
+		     PathPtr_t& validPart);
+      /// Whether workers should return
+      ///
+      /// True if a worker stopped the resolution or if the planner is
+      /// interrupted (see PathPlanner::interrupt).
+      bool stopped ();
+
+      Workers_t workers_;
+      /// Serializes extension and validation of workers that share objects
+      /// of the problem
+      boost::mutex sharedMutex_;
+      /// Protects the members below
+      boost::mutex mutex_;
+      bool stop_;
+      /// Steps started by the workers since the beginning of solve
+      std::size_t iterations_;
+      /// Status of the resolution if workers stopped on budget
+      Status status_;
+      /// Message of the first exception thrown by a worker
+      std::string error_;
+      mutable Statistics statistics_;
+    }; // class ParallelDiffusingPlanner
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_PARALLEL_DIFFUSING_PLANNER_HH
@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PARALLEL_DISCRETIZED_COLLISION_CHECKING_HH
+# define HPP_CORE_PARALLEL_DISCRETIZED_COLLISION_CHECKING_HH
+
+# include <vector>
+# include <boost/thread/thread.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/condition_variable.hpp>
+# include <hpp/core/path-validation.hh>
+
+namespace hpp {
+  namespace core {
+    /// Multi-threaded validation of path by collision checking at
+    /// discretized parameter values
+    ///
+    /// Parameter values are the same as in DiscretizedCollisionChecking and
+    /// so is the valid part returned by validate. Samples are distributed in
+    /// increasing order among a pool of threads, each thread owning a copy of
+    /// the robot. Threads stop as soon as a collision is found at a parameter
+    /// preceding all the samples not yet checked.
+    ///
+    /// Copies of the robot are created at construction and again when
+    /// obstacles change (see obstaclesChanged).
+    class HPP_CORE_DLLAPI ParallelDiscretizedCollisionChecking :
+      public PathValidation
+    {
+    public:
+      /// Create an instance
+      /// \param robot the robot for which collision checking is performed,
+      /// \param stepSize distance between consecutive samples,
+      /// \param nbThreads number of threads, if 0 use the number of hardware
+      ///        threads.
+      static ParallelDiscretizedCollisionCheckingPtr_t
+      create (const DevicePtr_t& robot, const value_type& stepSize,
+	      std::size_t nbThreads = 0);
+
+      virtual ~ParallelDiscretizedCollisionChecking ();
+
+      virtual bool validate (const PathPtr_t& path, bool reverse,
+			     PathPtr_t& validPart);
+
+      /// Check parameters in the same order as
+      /// DiscretizedCollisionChecking::isValid
+      virtual bool isValid (const PathPtr_t& path);
+
+      /// Create a DiscretizedCollisionChecking instance with the same step
+      ///
+      /// Callers of clone already run several threads.
+      virtual PathValidationPtr_t clone (const DevicePtr_t& robot) const;
+
+      /// Copy the robot again for each thread
+      void updateDevices ();
+
+      /// Copy the robot again for each thread, with its new obstacles
+      virtual void obstaclesChanged ();
+
+      /// Number of threads
+      std::size_t numberThreads () const
+      {
+	return devices_.size ();
+      }
+    protected:
+      ParallelDiscretizedCollisionChecking (const DevicePtr_t& robot,
+					    const value_type& stepSize,
+					    std::size_t nbThreads);
+    private:
+      /// Main loop of thread of given rank
+      void work (std::size_t rank);
+      /// Check parameters of times_ along path and set firstInvalid_
+      ///
+      /// \pre mutex_ is locked.
+      void check (const PathPtr_t& path, boost::mutex::scoped_lock& lock);
+
+      DevicePtr_t robot_;
+      value_type stepSize_;
+      /// Copy of the robot for each thread
+      Devices_t devices_;
+      boost::thread_group threads_;
+      /// Protects the members below
+      boost::mutex mutex_;
+      /// Serializes path evaluation when the path is subject to numerical
+      /// constraints
+      boost::mutex constraintMutex_;
+      boost::condition_variable jobCondition_;
+      boost::condition_variable doneCondition_;
+      /// Path being validated and parameters to check
+      PathPtr_t path_;
+      std::vector <value_type> times_;
+      /// Index of the next sample to check
+      std::size_t next_;
+      /// Index of the first sample in collision, size of times_ if none
+      std::size_t firstInvalid_;
+      /// Number of threads working on current path
+      std::size_t running_;
+      /// Incremented for each new path
+      std::size_t job_;
+      bool stop_;
+    }; // class ParallelDiscretizedCollisionChecking
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_PARALLEL_DISCRETIZED_COLLISION_CHECKING_HH
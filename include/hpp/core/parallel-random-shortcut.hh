@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_PARALLEL_RANDOM_SHORTCUT_HH
+# define HPP_CORE_PARALLEL_RANDOM_SHORTCUT_HH
+
+# include <hpp/core/random-shortcut.hh>
+
+namespace hpp {
+  namespace core {
+    /// Multi-threaded random shortcut
+    ///
+    /// Same optimization as RandomShortcut, except that each iteration
+    /// samples one pair of parameters per thread and validates the
+    /// resulting shortcuts concurrently. The candidate yielding the shortest
+    /// path is applied. Optimization stops after 10 iterations without
+    /// improvement.
+    ///
+    /// A part of a candidate lying inside one element of the current path
+    /// is a part of a path already validated: it is kept without calling
+    /// the steering method and the path validation again. Validity of other
+    /// shortcuts is memoized as in RandomShortcut and shared between
+    /// threads at the end of each iteration.
+    ///
+    /// \note As RandomShortcut, the optimizer assumes that the input path
+    ///       is a vector of optimal paths for the distance function.
+    /// \note If the path validation cannot be cloned or if the problem is
+    ///       subject to numerical constraints, candidates are validated one
+    ///       after the other.
+    class HPP_CORE_DLLAPI ParallelRandomShortcut : public RandomShortcut
+    {
+    public:
+      /// Return shared pointer to new object.
+      /// \param problem the problem the paths of which are optimized,
+      /// \param nbThreads number of threads, if 0 use the number of hardware
+      ///        threads.
+      static ParallelRandomShortcutPtr_t create (const Problem& problem,
+						 std::size_t nbThreads = 0);
+
+      /// Optimize path
+      virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path) const;
+
+      /// Number of threads, and of candidates per iteration
+      std::size_t numberThreads () const
+      {
+	return nbThreads_;
+      }
+    protected:
+      ParallelRandomShortcut (const Problem& problem, std::size_t nbThreads);
+    private:
+      struct Candidate;
+      /// Build the path of a candidate shortcut and compute its length
+      void evaluate (const PathValidationPtr_t& pathValidation,
+		     const PathVectorPtr_t& path, const Validity_t& validity,
+		     Candidate& candidate) const;
+
+      std::size_t nbThreads_;
+    }; // class ParallelRandomShortcut
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_PARALLEL_RANDOM_SHORTCUT_HH
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PARTIAL_SHORTCUT_HH
+# define HPP_CORE_PARTIAL_SHORTCUT_HH
+
+# include <vector>
+# include <hpp/core/random-shortcut.hh>
+
+namespace hpp {
+  namespace core {
+    /// Waypoint pruning and partial shortcuts
+    ///
+    /// Path optimizer that works on the waypoints of a path vector, the
+    /// end configurations of its elements.
+    ///
+    /// A first linear pass removes redundant waypoints: a waypoint is
+    /// removed if the path computed by the steering method between the
+    /// last waypoint kept and the next waypoint is valid.
+    ///
+    /// Partial shortcuts are then tried between two random configurations
+    /// along the path: the configurations of a random subset of the joints
+    /// are interpolated between the two configurations, proportionally to
+    /// the distance along the path, while the other joints keep their
+    /// values at the waypoints in between. A partial shortcut is applied if
+    /// it shortens the path by more than 0.1% and if the paths between the
+    /// new waypoints are valid, the waypoints around the shortcut are then
+    /// pruned. Optimization stops after a number of consecutive partial
+    /// shortcuts that are not applied, and the waypoints are pruned again.
+    ///
+    /// Validity of the paths between waypoints is memoized as in
+    /// RandomShortcut. If the problem is subject to constraints, the new
+    /// waypoints are projected on the constraints.
+    ///
+    /// \note As RandomShortcut, the optimizer assumes that the input path
+    ///       is a vector of optimal paths for the distance function.
+    class HPP_CORE_DLLAPI PartialShortcut : public RandomShortcut
+    {
+    public:
+      /// Return shared pointer to new object.
+      static PartialShortcutPtr_t create (const Problem& problem);
+
+      /// Optimize path
+      virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path) const;
+
+      /// Set the number of consecutive failed partial shortcuts after which
+      /// optimization stops
+      void maxFailures (std::size_t maxFailures)
+      {
+	maxFailures_ = maxFailures;
+      }
+      /// Get the number of consecutive failed partial shortcuts after which
+      /// optimization stops
+      std::size_t maxFailures () const
+      {
+	return maxFailures_;
+      }
+    protected:
+      PartialShortcut (const Problem& problem);
+    private:
+      typedef std::vector <Configuration_t> Waypoints_t;
+      typedef std::vector <PathPtr_t> Paths_t;
+
+      /// Compute the path between two configurations by the steering
+      /// method and check its validity, memoized in validity
+      bool isValid (ConfigurationIn_t q1, ConfigurationIn_t q2,
+		    Validity_t& validity, PathPtr_t& path) const;
+      /// Remove the redundant waypoints in one pass
+      /// \param waypoints waypoints, one more than paths,
+      /// \param paths paths between consecutive waypoints,
+      /// \param first, last waypoints strictly between first and last may
+      ///        be removed.
+      void prune (Waypoints_t& waypoints, Paths_t& paths,
+		  Validity_t& validity, std::size_t first,
+		  std::size_t last) const;
+      /// Try one random partial shortcut
+      /// \return whether the path was shortened
+      bool partialShortcut (Waypoints_t& waypoints, Paths_t& paths,
+			    Validity_t& validity) const;
+
+      /// Minimal decrease of the length of the path by a partial shortcut,
+      /// relatively to the length of the path
+      static const value_type minGain;
+      /// Joints with degrees of freedom the configuration of which is
+      /// interpolated by partial shortcuts
+      JointVector_t joints_;
+      std::size_t maxFailures_;
+    }; // class PartialShortcut
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_PARTIAL_SHORTCUT_HH
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_PATH_OPTIMIZER_HH
 # define HPP_CORE_PATH_OPTIMIZER_HH
 
+# include <boost/function.hpp>
 # include <hpp/core/config.hh>
 # include <hpp/core/fwd.hh>
 
@@ -29,6 +30,7 @@ namespace hpp {
     class HPP_CORE_DLLAPI PathOptimizer
     {
     public:
+      typedef boost::function <bool ()> StopCondition_t;
       /// Get problem
       const Problem& problem () const
       {
@@ -36,12 +38,28 @@ namespace hpp {
       }
       /// Optimize path
       virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path) const = 0;
+      /// Set function polled by optimize between its iterations
+      ///
+      /// When the function returns true, optimize stops and returns the
+      /// best path found so far. Used by PlanAndOptimize to enforce the
+      /// deadline of a resolution. An empty function never stops.
+      void stopCondition (const StopCondition_t& condition)
+      {
+	stopCondition_ = condition;
+      }
     protected:
-      PathOptimizer (const Problem& problem) : problem_ (problem)
+      PathOptimizer (const Problem& problem) : problem_ (problem),
+	stopCondition_ ()
 	{
 	}
+      /// Whether optimize should stop
+      bool stopRequested () const
+      {
+	return stopCondition_ && stopCondition_ ();
+      }
     private:
       const Problem& problem_;
+      StopCondition_t stopCondition_;
     }; // class PathOptimizer;
   } // namespace core
 } // namespace hpp
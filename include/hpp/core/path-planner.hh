@@ -19,8 +19,10 @@
 #ifndef HPP_CORE_PATH_PLANNER_HH
 # define HPP_CORE_PATH_PLANNER_HH
 
+# include <boost/thread/mutex.hpp>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
+# include <hpp/core/statistics.hh>
 
 namespace hpp {
   namespace core {
@@ -30,6 +32,17 @@ namespace hpp {
     /// set of goal configurations.
     class HPP_CORE_DLLAPI PathPlanner {
     public:
+      /// Outcome of a resolution within a budget
+      enum Status {
+	/// A path was found
+	SUCCESS,
+	/// The maximal duration elapsed before a path was found
+	TIMEOUT,
+	/// The maximal number of steps was reached before a path was found
+	MAX_ITERATIONS,
+	/// interrupt was called before a path was found
+	INTERRUPTED
+      };
       /// Get roadmap
       const RoadmapPtr_t& roadmap () const;
       /// Get problem
@@ -46,18 +59,43 @@ namespace hpp {
       /// \li findPath,
       /// \li finishSolve.
       /// Users can implement themselves the loop to avoid being trapped
-      /// in an infinite loop when no solution is found.
+      /// in an infinite loop when no solution is found, or call solve with
+      /// a budget.
+      /// \throw std::runtime_error if interrupted.
       virtual PathVectorPtr_t solve ();
+      /// Solve within a budget
+      ///
+      /// \param timeout maximal duration of the resolution in seconds,
+      ///        infinity for none,
+      /// \param maxIterations maximal number of steps, 0 for none,
+      /// \retval path the path found, NULL if status is not SUCCESS.
+      /// \return status of the resolution.
+      ///
+      /// The budget is checked after each step. Time left after a path is
+      /// found may be used by finishSolve to improve it, see
+      /// PlanAndOptimize. An interruption received before the call is kept
+      /// and stops the resolution at once, the interruption is cleared when
+      /// solve returns.
+      Status solve (value_type timeout, std::size_t maxIterations,
+		    PathVectorPtr_t& path);
       /// User implementation of one step of resolution
       virtual void oneStep () = 0;
       /// Post processing of the resulting path
       virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path) = 0;
       /// Interrupt path planning
-      void interrupt ();
+      ///
+      /// May be called from another thread than the one solving.
+      virtual void interrupt ();
       /// Check that a path exists between the initial node and one goal node.
       bool pathExists () const;
       /// Find a path in the roadmap and transform it in trajectory
       PathVectorPtr_t computePath () const;
+      /// Get statistics of the resolution since the last call to startSolve
+      ///
+      /// Time spent in each phase, and counters of the nearest neighbor
+      /// search of the roadmap, of the config projector and of the path
+      /// validation of the problem since startSolve.
+      virtual const Statistics& statistics () const;
     protected:
       /// Constructor
       ///
@@ -67,12 +105,59 @@ namespace hpp {
       ///
       /// Store a given roadmap.
       PathPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Statistics the phases of the resolution are timed in
+      Statistics& timers ()
+      {
+	return timers_;
+      }
+      /// Run the resolution with the budget of the current call to solve
+      ///
+      /// Call startSolve, oneStep until a path exists or the budget is
+      /// exhausted, computePath and finishSolve. Derived classes that do
+      /// not rely on oneStep override this method.
+      /// \retval path the path found, NULL if status is not SUCCESS.
+      virtual Status plan (PathVectorPtr_t& path);
+      /// Check the budget of the current call to solve
+      /// \param iterations number of steps performed since startSolve,
+      /// \return TIMEOUT or MAX_ITERATIONS if the budget is exhausted,
+      ///         SUCCESS otherwise.
+      Status checkBudget (std::size_t iterations) const;
+      /// Whether the deadline of the current call to solve is not passed
+      ///
+      /// Always true if solve was called without timeout.
+      bool timeLeft () const;
+      /// Whether the current call to solve has a timeout
+      bool hasDeadline () const;
+      /// Time left before the deadline of the current call to solve in
+      /// seconds, infinity if solve was called without timeout
+      value_type remainingTime () const;
+      /// Maximal number of steps of the current call to solve, 0 for none
+      std::size_t maxIterations () const
+      {
+	return maxIterations_;
+      }
+      /// Whether interrupt was called since the end of the previous call
+      /// to solve
+      bool interrupted () const;
     private:
+      /// Counters of the roadmap and problem since their creation
+      void counters (Statistics& statistics) const;
+
       /// Reference to the problem
       const Problem& problem_;
       /// Pointer to the roadmap.
       const RoadmapPtr_t roadmap_;
+      /// Protects interrupt_, written by the thread calling interrupt
+      mutable boost::mutex interruptMutex_;
       bool interrupt_;
+      /// Budget of the current call to solve, deadline in nanoseconds as
+      /// returned by Statistics::now
+      uint64_t deadline_;
+      std::size_t maxIterations_;
+      mutable Statistics timers_;
+      /// Counters at the last call to startSolve
+      Statistics initialCounters_;
+      mutable Statistics statistics_;
     }; // class PathPlanner
   } //   namespace core
 } // namespace hpp
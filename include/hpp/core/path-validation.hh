@@ -40,10 +40,58 @@ namespace hpp {
       /// \return whether the whole path is valid.
       virtual bool validate (const PathPtr_t& path, bool reverse,
 			     PathPtr_t& validPart) = 0;
+
+      /// Check whether a whole path is valid
+      ///
+      /// \param path the path to check for validity,
+      /// \return whether the whole path is valid.
+      ///
+      /// Use this method when the valid part of an invalid path is of no
+      /// use. Derived classes may then check the path in an order that finds
+      /// invalid configurations faster. Default implementation calls
+      /// validate.
+      virtual bool isValid (const PathPtr_t& path)
+      {
+	PathPtr_t validPart;
+	return validate (path, false, validPart);
+      }
+
+      /// Create a path validation of the same type for another robot
+      ///
+      /// \param robot copy of the robot, owned by the caller.
+      /// \return the new path validation, NULL if the type of path
+      ///         validation does not support it.
+      ///
+      /// Used by multi-threaded algorithms to validate paths in several
+      /// threads with a copy of the robot each. Default implementation
+      /// returns NULL, paths are then validated one at a time.
+      virtual PathValidationPtr_t clone (const DevicePtr_t& robot) const
+      {
+	(void) robot;
+	return PathValidationPtr_t ();
+      }
+
+      /// Notify that the obstacles of the robot changed
+      ///
+      /// Called by Problem when obstacles are added or replaced. Derived
+      /// classes that remember results of collision tests should forget
+      /// them. Default implementation does nothing.
+      virtual void obstaclesChanged ()
+      {
+      }
+
+      /// Number of configurations tested since creation
+      std::size_t numberSamples () const
+      {
+	return numberSamples_;
+      }
     protected:
-      PathValidation ()
+      PathValidation () : numberSamples_ (0)
       {
       }
+
+      /// Counter incremented by derived classes
+      std::size_t numberSamples_;
     }; // class PathValidation
   } // namespace core
 } // namespace hpp
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_PATH_VECTOR_HH
 # define HPP_CORE_PATH_VECTOR_HH
 
+# include <vector>
 # include <hpp/model/device.hh>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/path.hh>
@@ -26,10 +27,47 @@
 namespace hpp {
   namespace core {
     /// Concatenation of several paths
+    ///
+    /// The end parameter of each sub-path is stored, so that the sub-path
+    /// at a given parameter is found by binary search.
+    ///
+    /// concatenate and extract keep path vectors flat: sub-paths that are
+    /// path vectors without constraints are replaced by their own sub-paths,
+    /// so that the cost of an evaluation does not depend on the number of
+    /// extractions and concatenations the path results from.
     class HPP_CORE_DLLAPI PathVector : public Path
     {
     public:
       typedef Path parent_t;
+
+      /// Sequential evaluation of a path vector
+      ///
+      /// Stores the rank of the sub-path of the last evaluation. Evaluating
+      /// the path at increasing parameters costs an amortized constant time
+      /// whatever the number of sub-paths.
+      class HPP_CORE_DLLAPI Iterator
+      {
+      public:
+	/// Constructor
+	/// \param path path vector to evaluate. The path vector should not be
+	///        modified while the iterator is in use.
+	Iterator (const PathVector& path) : path_ (path), rank_ (0)
+	{
+	}
+	/// Evaluate the path vector at a parameter
+	///
+	/// Same result as PathVector::operator () (result, t). Constraints of
+	/// the path vector are applied without warm start.
+	void operator () (ConfigurationOut_t result, const value_type& t);
+	/// Rank of the sub-path of the last evaluation
+	std::size_t rank () const
+	{
+	  return rank_;
+	}
+      private:
+	const PathVector& path_;
+	std::size_t rank_;
+      }; // class Iterator
       /// \name Construction, destruction, copy
       /// \{
 
@@ -81,10 +119,26 @@ namespace hpp {
       /// \return rank of direct path in vector
       std::size_t rankAtParam (const value_type& param, value_type& localParam) const;
 
+      /// Get rank of direct path in vector at param starting from a guess
+      ///
+      /// \param param parameter in interval of definition,
+      /// \param hint rank of the sub-path of a smaller parameter,
+      /// \retval localParam parameter on sub-path
+      /// \return rank of direct path in vector, same as
+      ///         rankAtParam (param, localParam).
+      ///
+      /// Sub-paths are scanned forward from hint, binary search is used if
+      /// param is before the sub-path of rank hint.
+      std::size_t rankAtParam (const value_type& param, value_type& localParam,
+			       std::size_t hint) const;
+
       /// Append a path at the end of the vector
       void appendPath (const PathPtr_t& path);
 
       /// Concatenate two vectors of path
+      ///
+      /// Sub-paths of path are copied, unconstrained path vectors among them
+      /// are flattened.
       void concatenate (const PathVector& path);
 
       /// Extraction of a sub-path
@@ -107,12 +161,12 @@ namespace hpp {
       /// Constructor
       PathVector (std::size_t outputSize) : parent_t (std::make_pair (0, 0),
 						      outputSize),
-	paths_ ()
+	paths_ (), ends_ ()
 	  {
 	  }
       ///Copy constructor
       PathVector (const PathVector& path) : parent_t (path),
-	paths_ ()
+	paths_ (), ends_ (path.ends_)
 	  {
 	    timeRange_ = path.timeRange_;
 	    for (Paths_t::const_iterator it = path.paths_.begin ();
@@ -129,7 +183,15 @@ namespace hpp {
       virtual void impl_compute (ConfigurationOut_t result, value_type t) const;
 
     private:
+      /// Append a path, or its sub-paths if it is a path vector without
+      /// constraints
+      void appendFlat (const PathPtr_t& path);
+      /// Compute local parameter on sub-path of given rank
+      value_type localParameter (std::size_t rank, value_type param) const;
+
       Paths_t paths_;
+      /// End parameter of each sub-path in the path vector
+      std::vector <value_type> ends_;
       PathVectorWkPtr_t weak_;
     }; // class PathVector
   } //   namespace core
@@ -72,7 +72,7 @@ namespace hpp {
 	Configuration_t result (outputSize ());
 	impl_compute (result, t);
 	if (constraints_)
-	  constraints_->apply (result);
+	  applyConstraints (result);
 	return result;
       }
 
@@ -81,9 +81,19 @@ namespace hpp {
       {
 	impl_compute (result, t);
 	if (constraints_)
-	  constraints_->apply (result);
+	  applyConstraints (result);
       }
 
+      /// Evaluate the path at several parameters
+      ///
+      /// \param times parameters,
+      /// \retval result configurations stored column-wise,
+      /// \param nbThreads number of threads used to apply the constraints,
+      ///        see ConstraintSet::applyBatch.
+      /// \return whether constraints applied successfully at all parameters.
+      bool eval (const std::vector <value_type>& times, matrixOut_t result,
+		 std::size_t nbThreads = 1) const;
+
       /// \name Constraints
       /// \{
 
@@ -97,6 +107,22 @@ namespace hpp {
       {
 	constraints_ = constraints;
       }
+      /// Set whether projections start from the previous evaluation
+      ///
+      /// If true, the numerical constraints are solved starting from the
+      /// result of the previous evaluation, see
+      /// ConfigProjector::apply (ConfigurationOut_t, WarmStart_t&).
+      /// Evaluating the path at a sequence of close parameters, increasing
+      /// or decreasing, is then faster. The result of an evaluation depends
+      /// on the previous evaluation.
+      /// \warning a path with warm start should not be evaluated
+      ///          concurrently.
+      void warmStart (bool warmStart);
+      /// Get whether projections start from the previous evaluation
+      bool warmStart () const
+      {
+	return warmStart_.get () != 0;
+      }
       /// \}
 
       /// Get size of configuration space
@@ -121,7 +147,8 @@ namespace hpp {
 
       /// Protected constructor
       Path (const interval_t& interval, size_type outputSize) :
-	timeRange_ (interval), outputSize_ (outputSize), constraints_ ()
+	timeRange_ (interval), outputSize_ (outputSize), constraints_ (),
+	warmStart_ ()
 	{
 	}
 
@@ -129,15 +156,18 @@ namespace hpp {
       Path (const interval_t& interval, size_type outputSize,
 	    const ConstraintSetPtr_t& constraints) :
 	timeRange_ (interval), outputSize_ (outputSize),
-	constraints_ (constraints)
+	constraints_ (constraints), warmStart_ ()
 	{
 	}
 
       /// Protected constructor
+      ///
+      /// The copy does not share the state of warm started projections.
       Path (const Path& path) :
 	timeRange_ (path.timeRange_), outputSize_ (path.outputSize_),
-	constraints_ (path.constraints_)
+	constraints_ (path.constraints_), warmStart_ ()
 	  {
+	    warmStart (path.warmStart ());
 	  }
 
       /// Store weak pointer to itself
@@ -155,10 +185,22 @@ namespace hpp {
       /// Interval of definition
       interval_t timeRange_;
     private:
+      /// Apply constraints to a configuration, starting from the previous
+      /// result if warm start is active
+      void applyConstraints (ConfigurationOut_t configuration) const
+      {
+	if (warmStart_)
+	  constraints_->apply (configuration, *warmStart_);
+	else
+	  constraints_->apply (configuration);
+      }
+
       /// Size of the configuration space
       size_type outputSize_;
       /// Constraints that apply to the robot
       ConstraintSetPtr_t constraints_;
+      /// State of warm started projections, NULL if warm start is not active
+      boost::shared_ptr <ConfigProjector::WarmStart_t> warmStart_;
       /// Weak pointer to itself
       PathWkPtr_t weak_;
       friend std::ostream& operator<< (std::ostream& os, const Path& path);
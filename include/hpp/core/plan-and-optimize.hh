@@ -20,6 +20,7 @@
 # define HPP_CORE_PLAN_AND_OPTIMIZE_HH
 
 # include <vector>
+# include <boost/function.hpp>
 # include <hpp/core/config.hh>
 # include <hpp/core/path-planner.hh>
 
@@ -29,22 +30,54 @@ namespace hpp {
     ///
     /// Plans a path and iteratively applies a series of optimizer on
     /// the result.
+    ///
+    /// When solved with a timeout, the series of optimizers is applied
+    /// again as long as time is left and the path gets shorter, and the
+    /// shortest path found when the deadline passes is returned. The
+    /// running optimizer is stopped at its next iteration (see
+    /// PathOptimizer::stopCondition), so that the deadline is overshot by
+    /// at most one iteration of the optimizer. The planned path and each
+    /// improvement are published to the path callback as soon as they are
+    /// found.
     class HPP_CORE_DLLAPI PlanAndOptimize : public PathPlanner
     {
     public:
+      typedef boost::function <void (const PathVectorPtr_t&)> PathCallback_t;
       /// Return shared pointer to new object.
       static PlanAndOptimizePtr_t create (const PathPlannerPtr_t& pathPlanner);
+      /// Initialize the problem resolution and the path planner
+      virtual void startSolve ();
       /// One iteration of path planning or path optimization
       virtual void oneStep ();
       /// Optimize planned path
       virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
       void addPathOptimizer (const PathOptimizerPtr_t& optimizer);
+      /// Set function called by finishSolve with the planned path and
+      /// with each optimized path it keeps
+      void pathCallback (const PathCallback_t& callback)
+      {
+	pathCallback_ = callback;
+      }
+      /// Interrupt the path planner, or the current optimizer at its next
+      /// iteration
+      virtual void interrupt ();
+      /// Statistics of the path planner and time of the optimization
+      virtual const Statistics& statistics () const;
     protected:
       PlanAndOptimize (const PathPlannerPtr_t& pathPlanner);
+      /// Solve with the path planner within the budget, then optimize
+      ///
+      /// The path planner runs its own resolution loop, so that
+      /// multi-threaded planners keep their threads.
+      virtual Status plan (PathVectorPtr_t& path);
     private:
       typedef std::vector <PathOptimizerPtr_t> Optimizers_t;
+      /// Stop condition of the optimizers: deadline passed or interruption
+      bool stopOptimization () const;
       const PathPlannerPtr_t pathPlanner_;
       Optimizers_t optimizers_;
+      PathCallback_t pathCallback_;
+      mutable Statistics statistics_;
     }; // class PlanAndOptimize
   } // namespace core
 } // namespace hpp
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_PORTFOLIO_PLANNER_HH
+# define HPP_CORE_PORTFOLIO_PLANNER_HH
+
+# include <string>
+# include <vector>
+# include <boost/function.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/mutex.hpp>
+# include <hpp/core/path-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// Race several path planners and return the first solution
+    ///
+    /// Instances of path planners are created at each call to solve, each
+    /// with an empty roadmap, and run in separate threads by calling
+    /// PathPlanner::oneStep until the initial and a goal configurations are
+    /// connected. As soon as one of them solves the problem, the others are
+    /// stopped. Each thread
+    /// works on a copy of the problem with a copy of the robot and a path
+    /// validation obtained by PathValidation::clone. Each copy draws its
+    /// random numbers from a generator split from the one of the problem.
+    ///
+    /// Instances fill private roadmaps: the roadmap of this planner, and
+    /// thus the one of ProblemSolver, stays empty after a resolution.
+    ///
+    /// If the path validation cannot be cloned or if the problem is
+    /// subject to numerical constraints, instances are run in the calling
+    /// thread, one step of each in turn.
+    class HPP_CORE_DLLAPI PortfolioPlanner : public PathPlanner
+    {
+    public:
+      typedef boost::function < PathPlannerPtr_t (const Problem&,
+						  const RoadmapPtr_t&) >
+	PathPlannerBuilder_t;
+      /// Return shared pointer to new object.
+      ///
+      /// \note If no path planner is added before solving, as many
+      ///       instances of DiffusingPlanner as hardware threads are run.
+      static PortfolioPlannerPtr_t create (const Problem& problem,
+					   const RoadmapPtr_t& roadmap);
+      /// Add a path planner to the portfolio
+      /// \param builder function creating an instance of the path planner.
+      void addPathPlanner (const PathPlannerBuilder_t& builder);
+      /// One step of each instance
+      ///
+      /// Instances are created by startSolve. Set winner if an instance
+      /// solved the problem.
+      virtual void oneStep ();
+      /// Create instances and initialize them
+      virtual void startSolve ();
+      /// Do nothing.
+      virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
+      /// Instance that returned the solution of the last call to solve,
+      /// NULL if none
+      const PathPlannerPtr_t& winner () const
+      {
+	return winner_;
+      }
+      /// Statistics of the resolution summed over the instances
+      virtual const Statistics& statistics () const;
+    protected:
+      PortfolioPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Run instances until one of them returns a path or the budget is
+      /// exhausted
+      ///
+      /// Steps of all the instances count in the iteration budget.
+      /// \throw std::runtime_error if all instances failed.
+      virtual Status plan (PathVectorPtr_t& path);
+    private:
+      /// Instance of path planner with the problem it solves
+      ///
+      /// The problem is destroyed after the planner.
+      struct Instance {
+	boost::shared_ptr <Problem> problem;
+	PathPlannerPtr_t planner;
+      }; // struct Instance
+      typedef std::vector <Instance> Instances_t;
+      typedef std::vector <PathPlannerBuilder_t> Builders_t;
+
+      /// Create a copy of the problem with a copy of the robot
+      boost::shared_ptr <Problem> copyProblem () const;
+      /// Main function of thread of given rank
+      void run (std::size_t rank);
+
+      Builders_t builders_;
+      Instances_t instances_;
+      /// Whether instances run in separate threads
+      bool concurrent_;
+      PathPlannerPtr_t winner_;
+      /// Protects the members below, and instances_ and winner_ while
+      /// threads are running
+      boost::mutex mutex_;
+      /// Steps started by the instances since the beginning of solve
+      std::size_t iterations_;
+      /// Status of the resolution if instances stopped on budget
+      Status status_;
+      /// Message of the first exception thrown by an instance
+      std::string error_;
+      mutable Statistics statistics_;
+    }; // class PortfolioPlanner
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_PORTFOLIO_PLANNER_HH
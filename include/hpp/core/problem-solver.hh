@@ -19,9 +19,15 @@
 #ifndef HPP_CORE_PROBLEM_SOLVER_HH
 # define HPP_CORE_PROBLEM_SOLVER_HH
 
+# include <deque>
+# include <limits>
+# include <vector>
+# include <boost/thread/mutex.hpp>
 # include <hpp/model/fwd.hh>
 # include <hpp/core/deprecated.hh>
+# include <hpp/core/path-planner.hh>
 # include <hpp/core/problem.hh>
+# include <hpp/core/statistics.hh>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
 
@@ -63,6 +69,11 @@ namespace hpp {
       void resetGoalConfigs ();
       /// Set path planner type
       void pathPlannerType (const std::string& type);
+      /// Add a path planner type to the instances raced by
+      /// "PortfolioPlanner" path planner type
+      /// \throw std::runtime_error if type is unknown or is
+      ///        "PortfolioPlanner".
+      void addPortfolioPlannerType (const std::string& type);
       /// Get path planner
       const PathPlannerPtr_t& pathPlanner () const
       {
@@ -82,6 +93,16 @@ namespace hpp {
 	return roadmap_;
       }
 
+      /// Save the roadmap in a binary file
+      /// \sa Roadmap::save
+      void saveRoadmap (const std::string& filename) const;
+
+      /// Replace the roadmap by the content of a file
+      ///
+      /// Edges are rebuilt with the steering method of the problem.
+      /// \sa Roadmap::load
+      void loadRoadmap (const std::string& filename);
+
       /// Add a constraint
       void addConstraint (const ConstraintPtr_t& constraint);
 
@@ -95,6 +116,9 @@ namespace hpp {
       void resetConstraints ();
 
       /// Create new problem.
+      ///
+      /// The problem can then be customized through problem (), solve keeps
+      /// it as long as the robot is not changed.
       void resetProblem ();
 
       /// \name Solve problem and get paths
@@ -103,16 +127,106 @@ namespace hpp {
       /// Set and solve the problem
       void solve ();
 
+      /// Set and solve the problem within a budget
+      ///
+      /// \param timeout maximal duration of planning and optimization in
+      ///        seconds,
+      /// \param maxIterations maximal number of steps of the path planner,
+      ///        0 for none.
+      /// \return status of the resolution.
+      ///
+      /// The path planner is wrapped in a PlanAndOptimize with the path
+      /// optimizer, that optimizes the planned path while time is left.
+      /// The planned path and each improvement are added to paths () as
+      /// soon as they are found, the last one is the best. pathPlanner ()
+      /// returns the wrapper, so that the resolution can be interrupted.
+      PathPlanner::Status solve (value_type timeout,
+				 std::size_t maxIterations = 0);
+
+      /// Set the problem and solve it in a worker thread
+      ///
+      /// \param timeout maximal duration of planning and optimization in
+      ///        seconds,
+      /// \param maxIterations maximal number of steps of the path planner,
+      ///        0 for none.
+      /// \return handle to follow, wait for or cancel the resolution.
+      ///
+      /// Same resolution as solve (timeout, maxIterations). The paths found
+      /// are published through the handle and added to paths () by the
+      /// worker thread. statistics () is not updated: statistics of the
+      /// resolution are given by the handle. The problem and the roadmap are
+      /// shared with the worker thread and must not be modified, and the
+      /// problem solver must not be destroyed, until the resolution is
+      /// finished.
+      SolveHandlePtr_t solveAsync
+      (value_type timeout = std::numeric_limits <value_type>::infinity (),
+       std::size_t maxIterations = 0);
+
       /// Add a path
-      void addPath (const PathVectorPtr_t& path)
+      ///
+      /// If more than maxPaths () paths are stored, the oldest one is
+      /// archived.
+      void addPath (const PathVectorPtr_t& path);
+
+      /// Return vector of paths
+      ///
+      /// Copy of the paths, that may be taken while a resolution started by
+      /// solveAsync adds paths.
+      PathVectors_t paths () const;
+
+      /// Set maximal number of paths returned by paths ()
+      ///
+      /// Paths in excess, the oldest first, are archived: only the
+      /// configurations at the bounds of their sub-paths are kept, see
+      /// archivedPath. By default there is no limit.
+      void maxPaths (std::size_t nbPaths);
+      /// Get maximal number of paths returned by paths ()
+      std::size_t maxPaths () const
       {
-	paths_.push_back (path);
+	return maxPaths_;
       }
+      /// Set maximal number of archived paths
+      ///
+      /// Archived paths in excess, the oldest first, are forgotten. By
+      /// default there is no limit.
+      void maxArchivedPaths (std::size_t nbPaths);
+      /// Get maximal number of archived paths
+      std::size_t maxArchivedPaths () const
+      {
+	return maxArchivedPaths_;
+      }
+      /// Set whether all the paths found by a call to solve are stored
+      ///
+      /// If false, each path found by solve replaces the path previously
+      /// found by the same call, so that only the optimized path is stored.
+      /// Default is true.
+      void keepIntermediatePaths (bool keep)
+      {
+	keepIntermediatePaths_ = keep;
+      }
+      /// Get whether all the paths found by a call to solve are stored
+      bool keepIntermediatePaths () const
+      {
+	return keepIntermediatePaths_;
+      }
+      /// Number of archived paths
+      std::size_t numberArchivedPaths () const;
+      /// Rebuild an archived path
+      ///
+      /// \param rank rank of the path, the oldest being 0.
+      /// \return path made of the paths computed by the steering method of
+      ///         the problem between consecutive archived configurations.
+      /// \throw std::runtime_error if there is no problem.
+      PathVectorPtr_t archivedPath (std::size_t rank) const;
 
-      /// Return vector of paths
-      const PathVectors_t& paths () const
+      /// Statistics of the last call to solve
+      ///
+      /// Phases and counters of the path planner, see
+      /// PathPlanner::statistics, and time spent by the path optimizer.
+      /// Counters include the work of the path optimizer.
+      const Statistics& statistics () const
       {
-	return paths_;
+	return statistics_;
       }
       /// \}
 
@@ -125,6 +239,10 @@ namespace hpp {
       ///        for this object.
       /// \param distance whether distance computation should be performed
       ///        for this object.
+      ///
+      /// The roadmap is kept: at the next call to solve, its nodes and
+      /// valid edges are checked again against the obstacles (see
+      /// Roadmap::revalidateEdges) instead of building a new roadmap.
       void addObstacle (const CollisionObjectPtr_t& inObject, bool collision,
 			bool distance);
 
@@ -156,16 +274,43 @@ namespace hpp {
       ConfigurationPtr_t initConf_;
       /// Shared pointer to goal configuration.
       Configurations_t goalConfigurations_;
+      /// Set the problem and create the path planner and the path
+      /// optimizer
+      void initializeSolve ();
+      /// Create a PortfolioPlanner racing portfolioPlannerTypes_
+      PathPlannerPtr_t createPortfolioPlanner (const Problem& problem,
+					       const RoadmapPtr_t& roadmap);
+      /// Add a path found by solve, replace the previous path found by the
+      /// same call if intermediate paths are not kept
+      void addSolvePath (const PathVectorPtr_t& path);
+      /// Archive paths and forget archived paths in excess, pathsMutex_
+      /// being locked
+      void archivePaths ();
       /// Path planner
       std::string pathPlannerType_;
+      std::vector <std::string> portfolioPlannerTypes_;
       PathPlannerPtr_t pathPlanner_;
       /// Path optimizer
       std::string pathOptimizerType_;
       PathOptimizerPtr_t pathOptimizer_;
       /// Store roadmap
       RoadmapPtr_t roadmap_;
+      /// Protects paths_, archivedPaths_ and the solve path, written by the
+      /// worker thread of solveAsync
+      mutable boost::mutex pathsMutex_;
       /// Paths
       PathVectors_t paths_;
+      std::size_t maxPaths_;
+      std::size_t maxArchivedPaths_;
+      bool keepIntermediatePaths_;
+      /// Last path found by the current call to solve, NULL if none
+      PathVectorPtr_t solvePath_;
+      /// Whether solvePath_ is the last archived path
+      bool solvePathArchived_;
+      /// Configurations at the bounds of the sub-paths of archived paths,
+      /// stored column-wise
+      std::deque <matrix_t> archivedPaths_;
+      Statistics statistics_;
       /// Path planner factory
       PathPlannerFactory_t pathPlannerFactory_;
       /// Path optimizer factory
@@ -177,6 +322,9 @@ namespace hpp {
       ObjectVector_t distanceObstacles_;
       /// Map of obstacles by names
       std::map <std::string, CollisionObjectPtr_t> obstacleMap_;
+      /// Whether collision obstacles were added since the roadmap edges
+      /// were validated
+      bool obstaclesChanged_;
     }; // class ProblemSolver
   } // namespace core
 } // namespace hpp
@@ -135,6 +135,29 @@ namespace hpp {
       }
       /// \}
 
+      /// \name Random number generation
+      /// \{
+
+      /// Set random generator
+      ///
+      /// Planners and path optimizers created afterwards draw their random
+      /// numbers from generators split from this one, see
+      /// RandomGenerator::split.
+      void randomGenerator (const RandomGeneratorPtr_t& generator)
+      {
+	randomGenerator_ = generator;
+      }
+
+      /// Get random generator
+      ///
+      /// Resetting the generator with a seed before creating planners and
+      /// path optimizers reproduces their results.
+      const RandomGeneratorPtr_t& randomGenerator () const
+      {
+	return randomGenerator_;
+      }
+      /// \}
+
       /// Check that problem is well formulated
       void checkProblem () const;
 
@@ -185,6 +208,8 @@ namespace hpp {
       ObjectVector_t distanceObstacles_;
       /// Set of constraints applicable to the robot
       ConstraintSetPtr_t constraints_;
+      /// Generator random generators of planners are split from
+      RandomGeneratorPtr_t randomGenerator_;
     }; // class Problem
   } // namespace core
 } // namespace hpp
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_RANDOM_GENERATOR_HH
+# define HPP_CORE_RANDOM_GENERATOR_HH
+
+# include <boost/random/mersenne_twister.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// Seedable pseudo-random number generator
+    ///
+    /// Planners, configuration shooters and path optimizers draw random
+    /// numbers from their own generator instead of the global rand ()
+    /// function. Generators of objects running in different threads are
+    /// independent, and a seed reproduces a run.
+    ///
+    /// \warning a generator should not be used by several threads.
+    class HPP_CORE_DLLAPI RandomGenerator
+    {
+    public:
+      /// Seed of generators created without seed
+      static const unsigned int defaultSeed;
+
+      /// Create a generator
+      static RandomGeneratorPtr_t create (unsigned int seed = defaultSeed);
+
+      /// Reset the generator with a seed
+      void seed (unsigned int seed);
+
+      /// Get the seed the generator was last reset with
+      unsigned int seed () const
+      {
+	return seed_;
+      }
+
+      /// Uniformly distributed value in [0, 1)
+      value_type uniform ()
+      {
+	return engine_ () * (1./4294967296.);
+      }
+
+      /// Uniformly distributed value in [lower, upper)
+      value_type uniform (value_type lower, value_type upper)
+      {
+	return lower + (upper - lower) * uniform ();
+      }
+
+      /// Uniformly distributed integer in [0, n)
+      std::size_t index (std::size_t n);
+
+      /// Normally distributed value of mean 0 and standard deviation 1
+      value_type normal ();
+
+      /// Create a generator seeded by this one
+      ///
+      /// Used to give an independent stream of random numbers to an object
+      /// that may run in another thread. A sequence of calls to split on a
+      /// generator reset with the same seed creates the same generators.
+      RandomGeneratorPtr_t split ();
+
+    protected:
+      RandomGenerator (unsigned int seed);
+
+    private:
+      boost::mt19937 engine_;
+      unsigned int seed_;
+    }; // class RandomGenerator
+  } //   namespace core
+} // namespace hpp
+#endif // HPP_CORE_RANDOM_GENERATOR_HH
@@ -19,6 +19,8 @@
 #ifndef HPP_CORE_RANDOM_SHORTCUT_HH
 # define HPP_CORE_RANDOM_SHORTCUT_HH
 
+# include <map>
+# include <vector>
 # include <hpp/core/path-optimizer.hh>
 
 namespace hpp {
@@ -29,6 +31,11 @@ namespace hpp {
     /// path and that tries to connect these configurations by a call to
     /// the steering method.
     ///
+    /// Validity of the shortcuts is memoized during a call to optimize:
+    /// shortcuts lying inside one element of the current path are parts of
+    /// valid paths, and shortcuts between configurations already tried are
+    /// not checked again.
+    ///
     /// \note The optimizer assumes that the input path is a vector of optimal
     ///       paths for the distance function.
     class HPP_CORE_DLLAPI RandomShortcut : public PathOptimizer
@@ -39,8 +46,44 @@ namespace hpp {
 
       /// Optimize path
       virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path) const;
+
+      /// \name Memoization of shortcut validity
+      /// \{
+
+      /// Number of shortcuts the validity of which was known during the last
+      /// call to optimize
+      std::size_t cacheHits () const
+      {
+	return cacheHits_;
+      }
+      /// Number of shortcuts checked by the path validation during the last
+      /// call to optimize
+      std::size_t cacheMisses () const
+      {
+	return cacheMisses_;
+      }
+      /// \}
     protected:
+      /// Validity of shortcuts indexed by their end configurations
+      typedef std::map <std::vector <value_type>, bool> Validity_t;
+
       RandomShortcut (const Problem& problem);
+      /// Key of the shortcut between two configurations in Validity_t
+      static std::vector <value_type> shortcutKey (ConfigurationIn_t q1,
+						   ConfigurationIn_t q2);
+      /// Whether both parameters lie in the same element of a path vector
+      static bool sameElement (const PathVectorPtr_t& path, value_type t1,
+			       value_type t2);
+      /// Compute the length of a vector of paths assuming that each element
+      /// is optimal for the given distance.
+      static value_type pathLength (const PathVectorPtr_t& path,
+				    const DistancePtr_t& distance);
+
+      /// Generator of random parameters split from the generator of the
+      /// problem
+      RandomGeneratorPtr_t generator_;
+      mutable std::size_t cacheHits_;
+      mutable std::size_t cacheMisses_;
     }; // class RandomShortcut
   } // namespace core
 } // namespace hpp
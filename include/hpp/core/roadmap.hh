@@ -19,9 +19,15 @@
 #ifndef HPP_CORE_ROADMAP_HH
 # define HPP_CORE_ROADMAP_HH
 
+# include <vector>
+# include <boost/pool/object_pool.hpp>
+# include <boost/scoped_ptr.hpp>
+# include <boost/thread/recursive_mutex.hpp>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
+# include <hpp/core/edge.hh>
 # include <hpp/core/k-d-tree.hh>
+# include <hpp/core/node.hh>
 
 namespace hpp {
   namespace core {
@@ -30,6 +36,17 @@ namespace hpp {
 
     /// Roadmap built by random path planning methods
     /// Nodes are configurations, paths are collision-free paths.
+    ///
+    /// Nodes and edges are allocated by chunks in pools owned by the
+    /// roadmap, and are released all together by clear.
+    ///
+    /// Methods that add nodes and edges, nearest neighbor requests and
+    /// pathExists may be called concurrently by several threads. Other
+    /// accessors must not be called while such threads are running.
+    ///
+    /// Roadmaps can be saved in a binary file and loaded back (see save and
+    /// load) to reuse them for other queries in a static environment, or
+    /// merged into another roadmap (see merge).
     class HPP_CORE_DLLAPI Roadmap {
     public:
       /// Return shared pointer to new instance.
@@ -37,11 +54,17 @@ namespace hpp {
       void clear ();
       /// Add a node with given configuration
       /// \param config configuration
+      /// \param checkDuplicate whether to look for the configuration in the
+      ///        roadmap. Callers that know that the configuration is new
+      ///        skip the search.
       ///
       /// If configuration is alread in the roadmap, return the node
       /// containing the configuration. Otherwise, create a new node and a new
       /// connected component with this node.
-      NodePtr_t addNode (const ConfigurationPtr_t& config);
+      ///
+      /// \throw std::runtime_error if another node is closer than 1e-4.
+      NodePtr_t addNode (const ConfigurationPtr_t& config,
+			 bool checkDuplicate = true);
 
       /// Get nearest node to a configuration in the roadmap.
       /// \param configuration configuration
@@ -57,15 +80,46 @@ namespace hpp {
 			     const ConnectedComponentPtr_t& connectedComponent,
 			     value_type& minDistance);
 
+      /// Get nearest node to a configuration in each connected component.
+      /// \param configuration configuration
+      /// \retval nearest for each connected component of the roadmap,
+      ///         nearest node and distance to this node.
+      ///
+      /// The nearest neighbor data-structure is traversed only once.
+      void nearestNodes (const ConfigurationPtr_t& configuration,
+			 NearestNodes_t& nearest);
+
+      /// Get the k nearest nodes to a configuration in a connected component
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component, NULL to search
+      ///        all the nodes of the roadmap,
+      /// \param k number of nodes,
+      /// \retval nodes nearest nodes sorted by increasing distance.
+      void nearestNodes (const ConfigurationPtr_t& configuration,
+			 const ConnectedComponentPtr_t& connectedComponent,
+			 std::size_t k, Nodes_t& nodes);
+
+      /// Get nodes of a connected component within a given distance
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component
+      /// \param radius maximal distance to the configuration,
+      /// \retval nodes nodes at distance less than radius.
+      void nodesWithinBall (const ConfigurationPtr_t& configuration,
+			    const ConnectedComponentPtr_t& connectedComponent,
+			    value_type radius, Nodes_t& nodes);
+
       /// Add a node and an edge
       /// \param from node from which the edge starts,
       /// \param to configuration to which the edge stops
       /// \param path path between both configurations
+      /// \param checkDuplicate whether to look for configuration <c>to</c>
+      ///        in the connected component of <c>from</c>,
       /// \return node containing configuration <c>to</c>.
       /// Add the symmetric edge with reverse path.
       NodePtr_t addNodeAndEdge (const NodePtr_t from,
 				const ConfigurationPtr_t& to,
-				const PathPtr_t path);
+				const PathPtr_t path,
+				bool checkDuplicate = true);
 
       /// Add a goal configuration
       /// \param config configuration
@@ -76,6 +130,7 @@ namespace hpp {
       void resetGoalNodes ()
       {
 	goalNodes_.clear ();
+	++goalRevision_;
       }
 
       void initNode (const ConfigurationPtr_t& config)
@@ -86,6 +141,9 @@ namespace hpp {
       virtual ~Roadmap ();
       /// Find a path between initial and goal configurations
       PathPtr_t findPath () const;
+      /// Check that a goal node is in the connected component of the
+      /// initial node
+      bool pathExists () const;
       const Nodes_t& nodes () const
       {
 	return nodes_;
@@ -106,6 +164,17 @@ namespace hpp {
       {
 	return goalNodes_;
       }
+      /// Revision of the goal nodes
+      ///
+      /// Incremented each time the set of goal nodes reachable from a node
+      /// may change: when goal nodes are added or reset, and when
+      /// connected components are merged. Distances to goals cached in nodes
+      /// (see Node::cachedDistanceToGoal) are valid only for the revision they
+      /// were computed for.
+      std::size_t goalRevision () const
+      {
+	return goalRevision_;
+      }
       /// \name Distance used for nearest neighbor search
       /// \{
       /// Get distance function
@@ -115,6 +184,121 @@ namespace hpp {
       EdgePtr_t addEdge (const NodePtr_t& n1, const NodePtr_t& n2,
 			 const PathPtr_t& path);
 
+      /// Add an edge between two nodes and its reverse edge
+      ///
+      /// The reverse edge shares the path, see Edge.
+      /// \return the edge from n1 to n2.
+      EdgePtr_t addEdges (const NodePtr_t& n1, const NodePtr_t& n2,
+			  const PathPtr_t& path);
+
+      /// Add an edge the path of which has not been validated
+      ///
+      /// The edge status is Edge::UNKNOWN and the connected components of
+      /// the nodes are not merged.
+      EdgePtr_t addLazyEdge (const NodePtr_t& n1, const NodePtr_t& n2,
+			     const PathPtr_t& path);
+
+      /// Add an edge the path of which has not been validated and its
+      /// reverse edge
+      ///
+      /// \return the edge from n1 to n2.
+      EdgePtr_t addLazyEdges (const NodePtr_t& n1, const NodePtr_t& n2,
+			      const PathPtr_t& path);
+
+      /// Set validation status of an edge
+      ///
+      /// If the edge becomes valid, the connected components of its nodes
+      /// are merged.
+      void edgeStatus (const EdgePtr_t& edge, Edge::Status status);
+
+      /// Check the nodes and the valid edges again after obstacles were
+      /// added
+      /// \param validation path validation in the new environment,
+      /// \return number of valid edges found invalid or removed.
+      ///
+      /// Nodes the configuration of which is not valid anymore are removed
+      /// with their edges, since path validation does not check the
+      /// beginning of paths extended from them. Other nodes are reindexed.
+      /// Edges the path of which is not valid anymore become
+      /// Edge::INVALID, an edge and its reverse edge being checked once.
+      /// Connected components are then computed again from the valid edges.
+      /// Other nodes are kept, so that the roadmap can be reused for new
+      /// queries without building it again.
+      ///
+      /// \note the initial node is unset if it is removed.
+      std::size_t revalidateEdges (const PathValidationPtr_t& validation);
+
+      /// \name Nearest neighbor search
+      /// \{
+
+      /// Set the data structure used for nearest neighbor search
+      ///
+      /// Nodes already in the roadmap are inserted in the new data-structure.
+      void nearestNeighbor (const NearestNeighborSearchPtr_t& nearestNeighbor);
+
+      /// Get the data structure used for nearest neighbor search
+      const NearestNeighborSearchPtr_t& nearestNeighbor () const
+      {
+	updateNearestNeighbor ();
+	return nearestNeighbor_;
+      }
+      /// \}
+
+      /// \name Serialization
+      /// \{
+
+      /// Save nodes and edges in a binary file
+      ///
+      /// The file stores the configurations of the nodes in one contiguous
+      /// block, the connected component of each node and the edges as pairs
+      /// of node indices with their validation status. Paths are not stored,
+      /// they are recomputed by the steering method at loading. Initial and
+      /// goal nodes are saved as other nodes.
+      ///
+      /// \throw std::runtime_error if the file cannot be written.
+      void save (const std::string& filename) const;
+
+      /// Replace the content of the roadmap by the content of a file
+      /// \param filename file written by save,
+      /// \param steeringMethod steering method computing the paths of the
+      ///        edges.
+      ///
+      /// The file is mapped in memory and configurations are copied from
+      /// the mapping. Nodes are inserted in the nearest neighbor data
+      /// structure at the first request.
+      ///
+      /// \throw std::runtime_error if the file cannot be read or does not
+      ///        match the robot of the roadmap.
+      void load (const std::string& filename,
+		 const SteeringMethodPtr_t& steeringMethod);
+
+      /// Add the content of a file to the roadmap
+      /// \param filename file written by save, for instance by a planner
+      ///        run with another seed in another process,
+      /// \param steeringMethod steering method computing the paths of the
+      ///        edges,
+      /// \param pathValidation validation of the paths connecting the nodes
+      ///        of the file to the other nodes.
+      /// \return number of connections added between nodes of the file and
+      ///         other nodes.
+      ///
+      /// Nodes of the file closer than 1e-4 to a node of the roadmap are
+      /// replaced by this node. Connected components are computed again and
+      /// the nodes are inserted all together in the nearest neighbor data
+      /// structure. Then each node of the file is connected to the nearest
+      /// node of the other sources in each connected component it does not
+      /// belong to, if the path between them is valid. Roadmaps built in
+      /// parallel are thus gathered in one roadmap by merging files one
+      /// after the other.
+      ///
+      /// \throw std::runtime_error if the file cannot be read or does not
+      ///        match the robot of the roadmap. The roadmap is then not
+      ///        modified.
+      std::size_t merge (const std::string& filename,
+			 const SteeringMethodPtr_t& steeringMethod,
+			 const PathValidationPtr_t& pathValidation);
+      /// \}
+
     protected:
       /// Constructor
       /// \param distance distance function for nearest neighbor computations
@@ -128,26 +312,74 @@ namespace hpp {
     private:
       typedef std::map <ConnectedComponentPtr_t, NearestNeighborPtr_t>
 	NearetNeighborMap_t;
+      typedef boost::object_pool <Node> NodePool_t;
+      typedef boost::object_pool <Edge> EdgePool_t;
       /// Add a node with given configuration
       /// \param config configuration
       /// \param connectedComponent Connected component the node will belong
       ///        to.
+      /// \param checkDuplicate whether to look for the configuration in the
+      ///        connected component.
       ///
       /// If configuration is alread in the connected component, return the node
       /// containing the configuration. Otherwise, create a new node with given
       /// connected component.
       NodePtr_t addNode (const ConfigurationPtr_t& config,
-			 ConnectedComponentPtr_t connectedComponent);
+			 ConnectedComponentPtr_t connectedComponent,
+			 bool checkDuplicate);
+      /// Look for a node closer than 1e-4 to a configuration
+      /// \param connectedComponent connected component, NULL for all nodes,
+      /// \return the node if it contains the configuration, NULL if there is
+      ///         no such node.
+      /// \throw std::runtime_error if the node does not contain the
+      ///        configuration.
+      NodePtr_t findDuplicate (const ConfigurationPtr_t& config,
+			       const ConnectedComponentPtr_t&
+			       connectedComponent);
+      /// Merge the connected components of the nodes of an edge
+      void merge (const EdgePtr_t& edge);
+      /// Add the nodes and edges of a file written by save
+      /// \param replace whether to clear the roadmap first, otherwise nodes
+      ///        of the file already in the roadmap are not added again,
+      /// \retval newNodes the nodes created.
+      ///
+      /// Connected components of the file are added to the roadmap, nodes
+      /// are not inserted in the nearest neighbor data structure.
+      void read (const std::string& filename,
+		 const SteeringMethodPtr_t& steeringMethod, bool replace,
+		 Nodes_t& newNodes);
+      /// Remove nodes and their edges
+      /// \param removed whether to remove each node, by index,
+      /// \return number of valid edges removed.
+      ///
+      /// Remaining nodes are reindexed. Memory is released with the pools
+      /// when the roadmap is cleared. Connected components should be
+      /// computed again.
+      std::size_t removeNodes (const std::vector <bool>& removed);
+      /// Compute connected components from scratch with the valid edges
+      void updateConnectedComponents ();
+      /// Insert the nodes in the nearest neighbor data structure if they
+      /// have been loaded since the last request
+      void updateNearestNeighbor () const;
 
       const DistancePtr_t& distance_;
+      DevicePtr_t robot_;
+      /// Memory of nodes and edges
+      boost::scoped_ptr <NodePool_t> nodePool_;
+      boost::scoped_ptr <EdgePool_t> edgePool_;
       ConnectedComponents_t connectedComponents_;
       Nodes_t nodes_;
       Edges_t edges_;
       NodePtr_t initNode_;
       Nodes_t goalNodes_;
+      std::size_t goalRevision_;
       // use KDTree instead of NearestNeighbor 
       //NearetNeighborMap_t nearestNeighbor_;
-      KDTree kdTree_;
+      NearestNeighborSearchPtr_t nearestNeighbor_;
+      /// Whether loaded nodes are missing in nearestNeighbor_
+      mutable bool nearestNeighborOutdated_;
+      /// Protects the roadmap against concurrent modifications
+      mutable boost::recursive_mutex mutex_;
 
     }; // class Roadmap
   } //   namespace core
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_RRT_CONNECT_PLANNER_HH
+# define HPP_CORE_RRT_CONNECT_PLANNER_HH
+
+# include <hpp/core/path-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// Bidirectional RRT-Connect algorithm
+    ///
+    /// The start tree is the connected component of the initial node, goal
+    /// trees are the connected components of the goal nodes. At each step,
+    /// one tree is grown toward a random configuration, alternately the
+    /// start tree and a goal tree. The other trees are then extended toward
+    /// the new node until they reach it or are blocked.
+    ///
+    /// Each extension goes as far as the path validation allows, which is
+    /// the greedy CONNECT operation of RRT-Connect for steering methods
+    /// returning the whole path to the target.
+    class HPP_CORE_DLLAPI RrtConnectPlanner : public PathPlanner
+    {
+    public:
+      /// Return shared pointer to new object.
+      static RrtConnectPlannerPtr_t createWithRoadmap
+	(const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Return shared pointer to new object.
+      static RrtConnectPlannerPtr_t create (const Problem& problem);
+      /// Grow one tree and try to connect the other ones to it
+      virtual void oneStep ();
+      /// Do nothing.
+      virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
+
+      /// Set configuration shooter.
+      void configurationShooter (const ConfigurationShooterPtr_t& shooter);
+    protected:
+      /// Constructor
+      RrtConnectPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Constructor with roadmap
+      RrtConnectPlanner (const Problem& problem);
+      /// Extend a node in the direction of a configuration
+      /// \param near node in the roadmap,
+      /// \param target target configuration
+      virtual PathPtr_t extend (const NodePtr_t& near,
+				const ConfigurationPtr_t& target);
+    private:
+      /// Extend a tree toward a configuration as far as possible
+      /// \param cc connected component to extend,
+      /// \param target target configuration,
+      /// \param targetNode node of another tree containing the target
+      ///        configuration, NULL if the target is not in the roadmap,
+      /// \retval reached whether the target configuration has been reached,
+      /// \return the last node added to the tree, or the target node if
+      ///         reached, NULL if the tree could not be extended.
+      ///
+      /// If the target node is reached, it is linked to the tree.
+      NodePtr_t connect (const ConnectedComponentPtr_t& cc,
+			 const ConfigurationPtr_t& target,
+			 const NodePtr_t& targetNode, bool& reached);
+
+      ConfigurationShooterPtr_t configurationShooter_;
+      mutable Configuration_t qProj_;
+      /// Random configuration, filled by the shooter at each step
+      ConfigurationPtr_t qRand_;
+      /// Whether next step grows the start tree
+      bool growStart_;
+      /// Index of the goal node the tree of which is grown at the next
+      /// step growing a goal tree
+      std::size_t goalIndex_;
+    }; // class RrtConnectPlanner
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_RRT_CONNECT_PLANNER_HH
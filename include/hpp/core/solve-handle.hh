@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_SOLVE_HANDLE_HH
+# define HPP_CORE_SOLVE_HANDLE_HH
+
+# include <string>
+# include <boost/thread/condition_variable.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/thread.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+# include <hpp/core/path-planner.hh>
+# include <hpp/core/plan-and-optimize.hh>
+# include <hpp/core/statistics.hh>
+
+namespace hpp {
+  namespace core {
+    /// Resolution running in a worker thread
+    ///
+    /// Returned by ProblemSolver::solveAsync. The worker thread solves with
+    /// a PlanAndOptimize within a budget. The planned path is available
+    /// as soon as it is found, then each improvement of the optimizers.
+    /// The resolution is cancelled through PathPlanner::interrupt: if a
+    /// path was already found, the shortest one is kept.
+    ///
+    /// \note The problem solved must not be modified until the resolution
+    ///       is finished. The destructor cancels the resolution and waits
+    ///       for the worker thread.
+    class HPP_CORE_DLLAPI SolveHandle
+    {
+    public:
+      /// Progress of the resolution
+      enum State {
+	/// No path found yet
+	PLANNING,
+	/// A path was found and is being optimized
+	OPTIMIZING,
+	/// The worker thread returned
+	FINISHED
+      };
+
+      /// Start the resolution in a worker thread
+      /// \param planner path planner and optimizers,
+      /// \param timeout maximal duration in seconds, infinity for none,
+      /// \param maxIterations maximal number of steps of the path planner,
+      ///        0 for none,
+      /// \param callback function also called in the worker thread with
+      ///        each path published, if not empty.
+      static SolveHandlePtr_t create
+      (const PlanAndOptimizePtr_t& planner, value_type timeout,
+       std::size_t maxIterations,
+       const PlanAndOptimize::PathCallback_t& callback =
+       PlanAndOptimize::PathCallback_t ());
+
+      /// Cancel the resolution and wait for the worker thread
+      ~SolveHandle ();
+
+      /// Get progress of the resolution
+      State state () const;
+
+      /// Whether the worker thread returned
+      bool finished () const
+      {
+	return state () == FINISHED;
+      }
+
+      /// Wait until the resolution is finished
+      /// \return status of the resolution.
+      /// \throw std::runtime_error with the message of the exception thrown
+      ///        by the resolution if any.
+      PathPlanner::Status wait ();
+
+      /// Wait until the resolution is finished or a duration elapsed
+      /// \param timeout maximal duration to wait in seconds,
+      /// \return whether the resolution is finished.
+      bool waitFor (value_type timeout);
+
+      /// Cancel the resolution
+      ///
+      /// Interrupt the path planner. Planning stops after the current step,
+      /// optimization after the current optimizer. Call wait to get the
+      /// resulting status.
+      void cancel ();
+
+      /// Path found by the path planner, NULL if none yet
+      PathVectorPtr_t plannedPath () const;
+
+      /// Last path published so far, NULL if none yet
+      ///
+      /// Path returned by the resolution once finished successfully.
+      PathVectorPtr_t bestPath () const;
+
+      /// Paths published so far: planned path, then each improvement
+      PathVectors_t paths () const;
+
+      /// Time elapsed since the beginning of the resolution in seconds,
+      /// duration of the resolution once finished
+      value_type elapsed () const;
+
+      /// Statistics of the resolution
+      /// \throw std::runtime_error if the resolution is not finished.
+      const Statistics& statistics () const;
+
+    protected:
+      SolveHandle (const PlanAndOptimizePtr_t& planner, value_type timeout,
+		   std::size_t maxIterations,
+		   const PlanAndOptimize::PathCallback_t& callback);
+      /// Start the worker thread
+      void start ();
+
+    private:
+      /// Main function of the worker thread
+      void run ();
+      /// Callback of the planner for each new path
+      void publish (const PathVectorPtr_t& path);
+
+      const PlanAndOptimizePtr_t planner_;
+      const value_type timeout_;
+      const std::size_t maxIterations_;
+      const PlanAndOptimize::PathCallback_t callback_;
+      boost::thread thread_;
+      /// Protects the members below
+      mutable boost::mutex mutex_;
+      boost::condition_variable finished_;
+      State state_;
+      PathPlanner::Status status_;
+      PathVectors_t paths_;
+      /// Message of the exception thrown by the resolution
+      std::string error_;
+      /// Beginning and end of the resolution as returned by Statistics::now
+      uint64_t start_;
+      uint64_t end_;
+      Statistics statistics_;
+    }; // class SolveHandle
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_SOLVE_HANDLE_HH
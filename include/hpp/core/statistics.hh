@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_STATISTICS_HH
+# define HPP_CORE_STATISTICS_HH
+
+# include <iosfwd>
+# include <stdint.h>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// Time spent in the phases of a path planning resolution and counters
+    /// of the algorithms it relies on
+    ///
+    /// Path planners time their phases with Statistics::Timer, which costs
+    /// two readings of a monotonic clock per timed call. Counters are kept
+    /// by the nearest neighbor search, the config projector and the path
+    /// validation, and collected by PathPlanner::statistics.
+    class HPP_CORE_DLLAPI Statistics
+    {
+    public:
+      /// Phases of a resolution
+      enum Phase {
+	/// Random configuration shooting
+	SHOOTING,
+	/// Nearest neighbor search in the roadmap
+	NEAREST_NEIGHBOR,
+	/// Path computation by the steering method
+	STEERING,
+	/// Projection of configurations on the constraints
+	PROJECTION,
+	/// Path validation
+	COLLISION_CHECKING,
+	/// Path search in the roadmap graph
+	GRAPH_SEARCH,
+	/// Path optimization
+	OPTIMIZATION,
+	NB_PHASES
+      };
+
+      /// Counters of the algorithms used by a resolution
+      enum Counter {
+	/// Cells of the nearest neighbor search structure visited
+	NEAREST_NEIGHBOR_VISITS,
+	/// Distances between configurations evaluated in the leaves of the
+	/// nearest neighbor search structure
+	NEAREST_NEIGHBOR_DISTANCES,
+	/// Newton iterations of the config projector
+	PROJECTION_ITERATIONS,
+	/// Projections that did not converge
+	PROJECTION_FAILURES,
+	/// Configurations tested for collision by the path validation
+	COLLISION_SAMPLES,
+	NB_COUNTERS
+      };
+
+      /// Add the time elapsed between construction and destruction to a
+      /// phase
+      class HPP_CORE_DLLAPI Timer
+      {
+      public:
+	Timer (Statistics& statistics, Phase phase) :
+	  statistics_ (statistics), phase_ (phase), start_ (now ())
+	{
+	}
+	~Timer ()
+	{
+	  statistics_.add (phase_, now () - start_);
+	}
+      private:
+	Statistics& statistics_;
+	Phase phase_;
+	uint64_t start_;
+      }; // class Timer
+
+      /// Create statistics with zero time and zero counts
+      Statistics ()
+      {
+	reset ();
+      }
+
+      /// Set times and counts to zero
+      void reset ();
+
+      /// Add time and calls to a phase
+      void add (Phase phase, uint64_t nanoseconds, std::size_t calls = 1)
+      {
+	nanoseconds_ [phase] += nanoseconds;
+	calls_ [phase] += calls;
+      }
+
+      /// Add a value to a counter
+      void add (Counter counter, std::size_t value)
+      {
+	counts_ [counter] += value;
+      }
+
+      /// Add times and counts of other statistics
+      Statistics& operator+= (const Statistics& other);
+
+      /// Cumulative time spent in a phase in nanoseconds
+      uint64_t nanoseconds (Phase phase) const
+      {
+	return nanoseconds_ [phase];
+      }
+
+      /// Number of timed calls of a phase
+      std::size_t calls (Phase phase) const
+      {
+	return calls_ [phase];
+      }
+
+      /// Value of a counter
+      std::size_t count (Counter counter) const
+      {
+	return counts_ [counter];
+      }
+
+      /// Name of a phase
+      static const char* name (Phase phase);
+
+      /// Name of a counter
+      static const char* name (Counter counter);
+
+      /// Time of a monotonic clock in nanoseconds
+      static uint64_t now ();
+
+    private:
+      uint64_t nanoseconds_ [NB_PHASES];
+      std::size_t calls_ [NB_PHASES];
+      std::size_t counts_ [NB_COUNTERS];
+    }; // class Statistics
+
+    /// Print one line per phase and per counter
+    HPP_CORE_DLLAPI std::ostream& operator<< (std::ostream& os,
+					      const Statistics& statistics);
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_STATISTICS_HH
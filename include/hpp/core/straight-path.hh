@@ -34,6 +34,11 @@ namespace hpp {
     ///       joints, and translation part of freeflyer joints,
     ///   \li angular interpolation for unbounded rotation joints,
     ///   \li constant angular velocity for SO(3) part of freeflyer joints.
+    ///
+    /// The interpolation is prepared at construction: linearly interpolated
+    /// degrees of freedom are computed for the whole configuration by one
+    /// vector operation, only the other joints are interpolated by their
+    /// joint configuration.
     class HPP_CORE_DLLAPI StraightPath : public Path
     {
     public:
@@ -58,10 +63,15 @@ namespace hpp {
       /// Return a shared pointer to this
       ///
       /// As StaightPath are immutable, and refered to by shared pointers,
-      /// they do not need to be copied.
+      /// they do not need to be copied, unless projections are warm started,
+      /// since copies should not share the state of projections.
       virtual PathPtr_t copy () const
       {
-	return weak_.lock ();
+	if (!warmStart ()) return weak_.lock ();
+	StraightPathPtr_t path (create (device_, initial_, end_, length ()));
+	path->constraints (constraints ());
+	path->warmStart (true);
+	return path;
       }
 
       /// Extraction/Reversion of a sub-path
@@ -97,9 +107,20 @@ namespace hpp {
 				 value_type param) const;
 
     private:
+      /// Joint that is not interpolated linearly and its rank in
+      /// configuration
+      typedef std::vector <std::pair <JointPtr_t, size_type> >
+	JointInterpolations_t;
+      /// Build delta_ and joints_
+      void computeInterpolation ();
+
       DevicePtr_t device_;
       const Configuration_t initial_;
       const Configuration_t end_;
+      /// Difference between end_ and initial_ for linearly interpolated
+      /// degrees of freedom, zero for other degrees of freedom
+      vector_t delta_;
+      JointInterpolations_t joints_;
       StraightPathWkPtr_t weak_;
     }; // class StraightPath
   } //   namespace core
@@ -27,6 +27,17 @@ namespace hpp {
     ///
     /// Euclidean distance between configurations seen as vectors.
     /// Each degree of freedom is weighed by a positive value.
+    ///
+    /// The contribution of joints with one bounded degree of freedom,
+    /// translations and bounded rotations, is computed for the whole
+    /// configuration at once with a vector of squared weights, by a kernel
+    /// specialized for the configuration size of the robot. Other joints
+    /// are stored in a table built at construction.
+    ///
+    /// impl_distanceBelow adds the contributions of the joints of the table
+    /// one by one and stops as soon as the sum exceeds the square of the
+    /// bound. impl_distances runs the kernel on all the columns of the
+    /// block before adding the contributions of the joints of the table.
     class HPP_CORE_DLLAPI WeighedDistance : public Distance {
     public:
       static WeighedDistancePtr_t create (const DevicePtr_t& robot);
@@ -48,9 +59,33 @@ namespace hpp {
       /// Derived class should implement this function
       virtual value_type impl_distance (ConfigurationIn_t q1,
 				    ConfigurationIn_t q2);
+      virtual value_type impl_squaredDistance (ConfigurationIn_t q1,
+					       ConfigurationIn_t q2);
+      virtual bool impl_distanceBelow (ConfigurationIn_t q1,
+				       ConfigurationIn_t q2, value_type bound,
+				       value_type& distance);
+      virtual void impl_distances (ConfigurationIn_t q,
+				   matrixIn_t configurations,
+				   vectorOut_t distances);
     private:
+      /// Joint the distance of which is computed by the joint
+      struct JointDistance_t {
+	JointPtr_t joint;
+	size_type rank;
+	/// Index in weights_
+	std::size_t weight;
+      }; // struct JointDistance_t
+      typedef std::vector <JointDistance_t> JointDistances_t;
+      /// Build squaredWeights_ and joints_ from the joints and weights_
+      void computeDistanceTable ();
       DevicePtr_t robot_;
       std::vector <value_type> weights_;
+      /// Square of weights of linear dimensions of the configuration, zero
+      /// for other dimensions
+      vector_t squaredWeights_;
+      /// Configuration size the kernels are specialized for
+      int fixedSize_;
+      JointDistances_t joints_;
       WeighedDistanceWkPtr_t weak_;
     }; // class WeighedDistance
   } //   namespace core
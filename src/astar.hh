@@ -20,47 +20,91 @@
 # define HPP_CORE_ASTAR_HH
 
 # include <limits>
+# include <vector>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/distance.hh>
 # include <hpp/core/edge.hh>
 # include <hpp/core/node.hh>
 # include <hpp/core/path-vector.hh>
+# include <hpp/core/roadmap.hh>
+# include <hpp/core/connected-component.hh>
 
 namespace hpp {
   namespace core {
+    /// A* search in a roadmap
+    ///
+    /// Data about nodes are stored in vectors indexed by Node::index. The
+    /// open set is a binary heap that supports decreasing the cost of a node.
+    /// Only goal nodes that belong to the connected component of the initial
+    /// node are considered. Edge costs are cached in edges and the heuristic
+    /// is cached in nodes until the goal revision of the roadmap changes.
+    ///
+    /// Only valid edges are followed. In lazy mode, edges the status of which
+    /// is unknown are followed as well and all the goal nodes are
+    /// considered, the path found is then a candidate to validate.
     class Astar
     {
-      typedef std::list < NodePtr_t > Nodes_t;
+    public:
       typedef std::list <EdgePtr_t> Edges_t;
-      typedef std::map <NodePtr_t, EdgePtr_t> Parent_t;
-      Nodes_t closed_;
-      Nodes_t open_;
-      std::map <NodePtr_t, value_type> costFromStart_;
-      std::map <NodePtr_t, value_type> estimatedCostToGoal_;
-      Parent_t parent_;
+    private:
+      /// State of a node during search
+      enum State {
+	UNVISITED,
+	OPEN,
+	CLOSED
+      };
+      static const std::size_t npos = (std::size_t) -1;
+
       RoadmapPtr_t roadmap_;
       DistancePtr_t distance_;
+      bool lazy_;
+      /// Goal nodes reachable from the initial node
+      Nodes_t goals_;
+      /// Data indexed by node index
+      std::vector <NodePtr_t> nodes_;
+      std::vector <char> state_;
+      std::vector <char> isGoal_;
+      std::vector <value_type> costFromStart_;
+      std::vector <value_type> estimatedCost_;
+      std::vector <EdgePtr_t> parent_;
+      /// Position in heap_, npos if not in open set
+      std::vector <std::size_t> position_;
+      /// Binary heap of node indices sorted by estimated cost
+      std::vector <std::size_t> heap_;
 
     public:
-      Astar (const RoadmapPtr_t& roadmap, const DistancePtr_t distance) :
-	roadmap_ (roadmap), distance_ (distance)
+      Astar (const RoadmapPtr_t& roadmap, const DistancePtr_t distance,
+	     bool lazy = false) :
+	roadmap_ (roadmap), distance_ (distance), lazy_ (lazy)
       {
       }
 
-      PathVectorPtr_t solution ()
+      /// Find the edges of a path from the initial node to a goal node
+      /// \retval edges edges of the path,
+      /// \return false if no goal node can be reached.
+      bool edges (Edges_t& edges)
       {
+	edges.clear ();
 	NodePtr_t node = findPath ();
-	Edges_t edges;
-
+	if (!node) return false;
 	while (node) {
-	  Parent_t::const_iterator itEdge = parent_.find (node);
-	  if (itEdge != parent_.end ()) {
-	    EdgePtr_t edge = itEdge->second;
+	  EdgePtr_t edge = parent_ [node->index ()];
+	  if (edge) {
 	    edges.push_front (edge);
 	    node = edge->from ();
 	  }
 	  else node = NodePtr_t (0x0);
 	}
+	return true;
+      }
+
+      PathVectorPtr_t solution ()
+      {
+	Edges_t edges;
+	if (!this->edges (edges)) {
+	  throw std::runtime_error
+	    ("A* failed to find a solution to the goal.");
+	}
 	PathVectorPtr_t pathVector;
 	for (Edges_t::const_iterator itEdge = edges.begin ();
 	     itEdge != edges.end (); itEdge++) {
@@ -73,87 +117,162 @@ namespace hpp {
       }
 
     private:
-      struct SortFunctor {
-	std::map <NodePtr_t, value_type>& cost_;
-	SortFunctor (std::map <NodePtr_t, value_type>& cost) :
-	  cost_ (cost) {}
-	bool operator () (const NodePtr_t& n1, const NodePtr_t& n2)
-	{
-	  return cost_ [n1] < cost_ [n2];
-	}
-      }; // struc SortFunctor
-
-      bool isGoal (const NodePtr_t node)
+      void initialize ()
       {
+	std::size_t n = roadmap_->nodes ().size ();
+	nodes_.assign (n, NodePtr_t (0x0));
+	for (Nodes_t::const_iterator itNode = roadmap_->nodes ().begin ();
+	     itNode != roadmap_->nodes ().end (); itNode++) {
+	  assert ((*itNode)->index () < n);
+	  nodes_ [(*itNode)->index ()] = *itNode;
+	}
+	state_.assign (n, UNVISITED);
+	isGoal_.assign (n, false);
+	costFromStart_.assign (n, std::numeric_limits <value_type>::infinity ());
+	estimatedCost_.assign (n, std::numeric_limits <value_type>::infinity ());
+	parent_.assign (n, EdgePtr_t (0x0));
+	position_.assign (n, std::size_t (npos));
+	heap_.clear ();
+	goals_.clear ();
+	ConnectedComponentPtr_t cc = roadmap_->initNode ()->connectedComponent ();
 	for (Nodes_t::const_iterator itGoal = roadmap_->goalNodes ().begin ();
 	     itGoal != roadmap_->goalNodes ().end (); itGoal++) {
-	  if (*itGoal == node) {
-	    return true;
+	  if (lazy_ || (*itGoal)->connectedComponent () == cc) {
+	    goals_.push_back (*itGoal);
+	    isGoal_ [(*itGoal)->index ()] = true;
 	  }
 	}
-	return false;
       }
 
       NodePtr_t findPath ()
       {
-	closed_.clear ();
-	open_.clear ();
-	parent_.clear ();
-	estimatedCostToGoal_.clear ();
-	costFromStart_.clear ();
-
-	open_.push_back (roadmap_->initNode ());
-	while (!open_.empty ()) {
-	  open_.sort (SortFunctor (estimatedCostToGoal_));
-	  Nodes_t::iterator itv = open_.begin ();
-	  NodePtr_t current (*itv);
-	  if (isGoal (current)) {
-	    return current;
+	initialize ();
+	std::size_t init = roadmap_->initNode ()->index ();
+	costFromStart_ [init] = 0;
+	estimatedCost_ [init] = heuristic (init);
+	push (init);
+	while (!heap_.empty ()) {
+	  std::size_t current = pop ();
+	  if (isGoal_ [current]) {
+	    return nodes_ [current];
 	  }
-	  open_.erase (itv);
-	  closed_.push_back (current);
-	  for (Edges_t::const_iterator itEdge = current->outEdges ().begin ();
-	       itEdge != current->outEdges ().end (); itEdge++) {
-	    value_type transitionCost = edgeCost (*itEdge);
-	    NodePtr_t child ((*itEdge)->to ());
-	    if (std::find (closed_.begin (), closed_.end (), child) ==
-		closed_.end ()) {
-	      // node is not in closed set
-	      value_type tmpCost = costFromStart_ [current] + transitionCost;
-	      bool childNotInOpenSet = (std::find (open_.begin (),
-						   open_.end (),
-						   child) == open_.end ());
-	      if ((childNotInOpenSet) || (tmpCost < costFromStart_ [child])) {
-		parent_ [child] = *itEdge;
-		costFromStart_ [child] = tmpCost;
-		estimatedCostToGoal_ [child] = costFromStart_ [child] +
-		  heuristic (child);
-		if (childNotInOpenSet) open_.push_back (child);
+	  state_ [current] = CLOSED;
+	  const Node::Edges_t& outEdges (nodes_ [current]->outEdges ());
+	  for (Edges_t::const_iterator itEdge = outEdges.begin ();
+	       itEdge != outEdges.end (); itEdge++) {
+	    if (!usable (*itEdge)) continue;
+	    std::size_t child = (*itEdge)->to ()->index ();
+	    if (state_ [child] == CLOSED) continue;
+	    value_type tmpCost = costFromStart_ [current] + (*itEdge)->cost ();
+	    if (state_ [child] == UNVISITED || tmpCost < costFromStart_ [child]) {
+	      parent_ [child] = *itEdge;
+	      costFromStart_ [child] = tmpCost;
+	      estimatedCost_ [child] = tmpCost + heuristic (child);
+	      if (state_ [child] == UNVISITED) {
+		push (child);
+	      } else {
+		decrease (child);
 	      }
 	    }
 	  }
 	}
-	throw std::runtime_error ("A* failed to find a solution to the goal.");
+	return 0x0;
       }
 
-      value_type heuristic (const NodePtr_t node) const
+      /// Whether the search follows an edge
+      bool usable (const EdgePtr_t& edge) const
       {
-	const ConfigurationPtr_t config = node->configuration ();
-	value_type res = std::numeric_limits <value_type>::infinity ();
-	for (Nodes_t::const_iterator itGoal = roadmap_->goalNodes ().begin ();
-	     itGoal != roadmap_->goalNodes ().end (); itGoal++) {
-	  ConfigurationPtr_t goal = (*itGoal)->configuration ();
-	  value_type dist = (*distance_) (*config, *goal);
-	  if (dist < res) {
-	    res = dist;
+	if (lazy_) return edge->status () != Edge::INVALID;
+	return edge->status () == Edge::VALID;
+      }
+
+      /// \name Binary heap
+      /// \{
+      void push (std::size_t node)
+      {
+	state_ [node] = OPEN;
+	position_ [node] = heap_.size ();
+	heap_.push_back (node);
+	siftUp (heap_.size () - 1);
+      }
+
+      std::size_t pop ()
+      {
+	std::size_t result = heap_.front ();
+	position_ [result] = npos;
+	heap_.front () = heap_.back ();
+	heap_.pop_back ();
+	if (!heap_.empty ()) {
+	  position_ [heap_.front ()] = 0;
+	  siftDown (0);
+	}
+	return result;
+      }
+
+      /// Restore heap order after decreasing the cost of a node
+      void decrease (std::size_t node)
+      {
+	siftUp (position_ [node]);
+      }
+
+      void siftUp (std::size_t i)
+      {
+	std::size_t node = heap_ [i];
+	while (i > 0) {
+	  std::size_t parent = (i - 1)/2;
+	  if (estimatedCost_ [heap_ [parent]] <= estimatedCost_ [node]) break;
+	  heap_ [i] = heap_ [parent];
+	  position_ [heap_ [i]] = i;
+	  i = parent;
+	}
+	heap_ [i] = node;
+	position_ [node] = i;
+      }
+
+      void siftDown (std::size_t i)
+      {
+	std::size_t node = heap_ [i];
+	std::size_t n = heap_.size ();
+	while (2*i + 1 < n) {
+	  std::size_t child = 2*i + 1;
+	  if (child + 1 < n && estimatedCost_ [heap_ [child + 1]] <
+	      estimatedCost_ [heap_ [child]]) {
+	    ++child;
 	  }
+	  if (estimatedCost_ [node] <= estimatedCost_ [heap_ [child]]) break;
+	  heap_ [i] = heap_ [child];
+	  position_ [heap_ [i]] = i;
+	  i = child;
 	}
-	return res;
+	heap_ [i] = node;
+	position_ [node] = i;
       }
+      /// \}
 
-      value_type edgeCost (const EdgePtr_t& edge)
+      /// Distance to the nearest reachable goal, cached in the node
+      ///
+      /// Goals are not restricted to a connected component in lazy mode and
+      /// the distance is not cached.
+      value_type heuristic (std::size_t node)
       {
-	return edge->path ()->length ();
+	value_type res;
+	std::size_t revision = roadmap_->goalRevision ();
+	if (!lazy_ && nodes_ [node]->cachedDistanceToGoal (revision, res)) {
+	  return res;
+	}
+	const ConfigurationPtr_t config = nodes_ [node]->configuration ();
+	res = std::numeric_limits <value_type>::infinity ();
+	for (Nodes_t::const_iterator itGoal = goals_.begin ();
+	     itGoal != goals_.end (); itGoal++) {
+	  ConfigurationPtr_t goal = (*itGoal)->configuration ();
+	  value_type dist;
+	  if (distance_->distanceBelow (*config, *goal, res, dist) &&
+	      dist < res) {
+	    res = dist;
+	  }
+	}
+	if (!lazy_) nodes_ [node]->cacheDistanceToGoal (revision, res);
+	return res;
       }
     }; // class Astar
   } //   namespace core
@@ -22,28 +22,153 @@
 # include <hpp/model/joint.hh>
 # include <hpp/model/joint-configuration.hh>
 # include <hpp/core/configuration-shooter.hh>
+# include <hpp/core/random-generator.hh>
 
 namespace hpp {
   namespace core {
+    /// Uniform sampling of the configuration space
+    ///
+    /// Translations, rotations and SO3 joints are sampled with the random
+    /// generator of the shooter. Other joints are sampled by their joint
+    /// configuration.
     class BasicConfigurationShooter : public ConfigurationShooter
     {
     public:
-      BasicConfigurationShooter (const DevicePtr_t& robot) : robot_ (robot)
+      BasicConfigurationShooter (const DevicePtr_t& robot) : robot_ (robot),
+	generator_ (RandomGenerator::create ())
+      {
+      }
+      BasicConfigurationShooter (const DevicePtr_t& robot,
+				 const RandomGeneratorPtr_t& generator) :
+	robot_ (robot), generator_ (generator)
       {
       }
       virtual ConfigurationPtr_t shoot () const
       {
-	JointVector_t jv = robot_->getJointVector ();
 	ConfigurationPtr_t config (new Configuration_t (robot_->configSize ()));
+	shoot (*config);
+	return config;
+      }
+      virtual void shoot (ConfigurationOut_t config) const
+      {
+	const JointVector_t& jv = robot_->getJointVector ();
 	for (JointVector_t::const_iterator itJoint = jv.begin ();
 	     itJoint != jv.end (); itJoint++) {
-	  std::size_t rank = (*itJoint)->rankInConfiguration ();
-	  (*itJoint)->configuration ()->uniformlySample (rank, *config);
+	  size_type rank = (*itJoint)->rankInConfiguration ();
+	  if (dynamic_cast <model::JointSO3*> (*itJoint)) {
+	    sampleSO3 (config.segment (rank, 4));
+	  } else if (!sample (*itJoint, rank, config)) {
+	    (*itJoint)->configuration ()->uniformlySample (rank, config);
+	  }
 	}
-	return config;
+      }
+      /// Shoot random configurations in the columns of a matrix
+      ///
+      /// Bounded degrees of freedom are sampled in one vector operation for
+      /// all the columns. The sequence of random numbers is different from
+      /// the one of successive calls to shoot.
+      virtual void shootBatch (matrixOut_t configs) const
+      {
+	const JointVector_t& jv = robot_->getJointVector ();
+	for (JointVector_t::const_iterator itJoint = jv.begin ();
+	     itJoint != jv.end (); itJoint++) {
+	  size_type rank = (*itJoint)->rankInConfiguration ();
+	  if (dynamic_cast <model::JointSO3*> (*itJoint)) {
+	    for (size_type j=0; j < configs.cols (); ++j) {
+	      sampleSO3 (configs.col (j).segment (rank, 4));
+	    }
+	  } else if (!sampleRows (*itJoint, rank, configs)) {
+	    for (size_type j=0; j < configs.cols (); ++j) {
+	      (*itJoint)->configuration ()->uniformlySample
+		(rank, configs.col (j));
+	    }
+	  }
+	}
+      }
+      /// Get random generator
+      const RandomGeneratorPtr_t& randomGenerator () const
+      {
+	return generator_;
+      }
+      /// Lower and upper bounds of a degree of freedom of a translation or
+      /// a rotation
+      /// \return false if the degree of freedom should be sampled by the
+      ///         joint configuration.
+      static bool bounds (const JointPtr_t& joint, size_type i,
+			  value_type& lower, value_type& upper)
+      {
+	const bool rotation = dynamic_cast <model::JointRotation*> (joint);
+	if (!rotation && !dynamic_cast <model::JointTranslation*> (joint)) {
+	  return false;
+	}
+	if (joint->isBounded (i)) {
+	  lower = joint->lowerBound (i); upper = joint->upperBound (i);
+	} else if (rotation) {
+	  lower = -M_PI; upper = M_PI;
+	} else {
+	  return false;
+	}
+	return true;
+      }
+      /// Unit quaternion from three values in [0, 1) (Shoemake)
+      ///
+      /// The quaternion is uniformly distributed if the values are.
+      template <typename Derived>
+      static void unitQuaternion (value_type u1, value_type u2, value_type u3,
+				  Eigen::MatrixBase <Derived> const& quaternion)
+      {
+	Eigen::MatrixBase <Derived>& q
+	  (const_cast <Eigen::MatrixBase <Derived>&> (quaternion));
+	value_type a2 = 2 * M_PI * u2;
+	value_type a3 = 2 * M_PI * u3;
+	q [0] = sqrt (1 - u1) * sin (a2);
+	q [1] = sqrt (1 - u1) * cos (a2);
+	q [2] = sqrt (u1) * sin (a3);
+	q [3] = sqrt (u1) * cos (a3);
       }
     private:
+      /// Sample the configuration of a translation or a rotation
+      /// \return false if the joint should be sampled by its configuration
+      bool sample (const JointPtr_t& joint, size_type rank,
+		   ConfigurationOut_t config) const
+      {
+	value_type lower, upper;
+	for (size_type i=0; i < joint->configSize (); ++i) {
+	  if (!bounds (joint, i, lower, upper)) return false;
+	  config [rank + i] = generator_->uniform (lower, upper);
+	}
+	return true;
+      }
+      /// Sample the configuration of a translation or a rotation in all
+      /// the columns of a matrix
+      bool sampleRows (const JointPtr_t& joint, size_type rank,
+		       matrixOut_t configs) const
+      {
+	value_type lower, upper;
+	for (size_type i=0; i < joint->configSize (); ++i) {
+	  if (!bounds (joint, i, lower, upper)) return false;
+	}
+	for (size_type i=0; i < joint->configSize (); ++i) {
+	  bounds (joint, i, lower, upper);
+	  for (size_type j=0; j < configs.cols (); ++j) {
+	    configs (rank + i, j) = generator_->uniform ();
+	  }
+	  configs.row (rank + i).array () =
+	    lower + (upper - lower) * configs.row (rank + i).array ();
+	}
+	return true;
+      }
+      /// Uniformly distributed unit quaternion
+      template <typename Derived>
+      void sampleSO3 (Eigen::MatrixBase <Derived> const& quaternion) const
+      {
+	value_type u1 = generator_->uniform ();
+	value_type u2 = generator_->uniform ();
+	value_type u3 = generator_->uniform ();
+	unitQuaternion (u1, u2, u3, quaternion);
+      }
       const DevicePtr_t& robot_;
+      RandomGeneratorPtr_t generator_;
     }; // class BasicConfigurationShooter
   } //   namespace core
 } // namespace hpp
@@ -16,7 +16,11 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <hpp/util/debug.hh>
 #include <hpp/model/configuration.hh>
 #include <hpp/model/device.hh>
@@ -28,11 +32,44 @@
 namespace hpp {
   namespace core {
     //using boost::fusion::result_of::at;
+    const value_type ConfigProjector::initialStep = .2;
+
+    namespace {
+      /// Initial damping of Levenberg Marquardt iterations relative to the
+      /// largest diagonal element of J J^T
+      const value_type initialDamping = 1e-3;
+      /// Relative damping above which iterations stop
+      const value_type maxDamping = 1e12;
+    } // namespace
+
     bool operator< (const LockedDofPtr_t& l1, const LockedDofPtr_t& l2)
     {
       return l1->index () < l2->index ();
     }
 
+    /// Multiply a vector by the orthogonal factor Q of a Householder QR
+    /// decomposition, or by its transpose, without allocating memory
+    /// \param qr, coeffs packed decomposition and Householder coefficients,
+    /// \param transpose whether to multiply by Q^T instead of Q,
+    /// \retval v vector multiplied in place.
+    static void applyHouseholderQ (const matrix_t& qr, const vector_t& coeffs,
+				   bool transpose, vectorOut_t v)
+    {
+      size_type n = qr.rows ();
+      size_type nbReflectors = coeffs.size ();
+      for (size_type i=0; i<nbReflectors; ++i) {
+	// Q = H_0 ... H_{k-1} with H_j = I - tau_j u_j u_j^T and
+	// u_j = (0, ..., 0, 1, qr (j+1:n, j))
+	size_type j = transpose ? i : nbReflectors - 1 - i;
+	size_type size = n - j - 1;
+	value_type s = v [j] +
+	  qr.col (j).tail (size).dot (v.tail (size));
+	s *= coeffs [j];
+	v [j] -= s;
+	v.tail (size) -= s * qr.col (j).tail (size);
+      }
+    }
+
     ConfigProjectorPtr_t ConfigProjector::create (const DevicePtr_t& robot,
 						  const std::string& name,
 						  value_type errorThreshold,
@@ -51,26 +88,34 @@ namespace hpp {
 				      size_type maxIterations) :
       Constraint (name), robot_ (robot), constraints_ (),
       squareErrorThreshold_ (errorThreshold * errorThreshold),
-      maxIterations_ (maxIterations), toMinusFrom_ (robot->numberDof ()),
+      maxIterations_ (maxIterations), linearSolver_ (SVD), damping_ (1e-8),
+      algorithm_ (NEWTON_RAPHSON), workspace_ (), workspaces_ (),
+      toMinusFrom_ (robot->numberDof ()),
       projMinusFrom_ (robot->numberDof ()),
-      dq_ (robot->numberDof ()),
-      dqSmall_ (robot->numberDof ()),
+      warmStartStep_ (robot->numberDof ()),
       nbNonLockedDofs_ (robot_->numberDof ())
     {
+      computeIntervals ();
+      resize ();
     }
 
     void ConfigProjector::addConstraint
     (const DifferentiableFunctionPtr_t& constraint)
     {
-      vector_t value (constraint->outputSize ());
-      matrix_t jacobian (constraint->outputSize (),
-			 robot_->numberDof ());
-      constraints_.push_back (FunctionValueAndJacobian_t (constraint, value,
-							  jacobian));
+      constraints_.push_back (NumericalConstraint_t (constraint));
       computeIntervals ();
       resize ();
     }
 
+    bool ConfigProjector::threadSafe () const
+    {
+      for (NumericalConstraints_t::const_iterator it = constraints_.begin ();
+	   it != constraints_.end (); ++it) {
+	if (!it->function->threadSafe ()) return false;
+      }
+      return true;
+    }
+
     void ConfigProjector::computeIntervals ()
     {
       intervals_.clear ();
@@ -94,52 +139,106 @@ namespace hpp {
       }
       // Remove temporary element.
       lockedDofs_.pop_back ();
+      computeJacobianBlocks ();
     }
 
-    void ConfigProjector::resize ()
+    void ConfigProjector::computeJacobianBlocks ()
     {
-      std::size_t size = 0;
-      for (NumericalConstraints_t::const_iterator itConstraint =
+      for (NumericalConstraints_t::iterator itConstraint =
 	     constraints_.begin ();
 	   itConstraint != constraints_.end (); itConstraint ++) {
-	FunctionValueAndJacobian_t fvj = (*itConstraint);
-	size += fvj.function->outputSize ();
+	const SizeIntervals_t& active =
+	  itConstraint->function->activeDerivativeIntervals ();
+	JacobianBlocks_t& blocks = itConstraint->blocks;
+	blocks.clear ();
+	size_type reducedCol = 0;
+	for (Intervals_t::const_iterator itInterval = intervals_.begin ();
+	     itInterval != intervals_.end (); itInterval ++) {
+	  size_type col0 = itInterval->first;
+	  size_type col1 = col0 + itInterval->second;
+	  for (SizeIntervals_t::const_iterator itActive = active.begin ();
+	       itActive != active.end (); itActive ++) {
+	    size_type begin = std::max (col0, itActive->first);
+	    size_type end = std::min (col1, itActive->first +
+				      itActive->second);
+	    if (begin < end) {
+	      JacobianBlock_t block;
+	      block.col = begin;
+	      block.reducedCol = reducedCol + begin - col0;
+	      block.nbCols = end - begin;
+	      blocks.push_back (block);
+	    }
+	  }
+	  reducedCol += itInterval->second;
+	}
       }
+    }
+
+    void ConfigProjector::resize ()
+    {
       nbNonLockedDofs_ = robot_->numberDof () - lockedDofs_.size ();
-      value_.resize (size);
-      reducedJacobian_.resize (size, nbNonLockedDofs_);
-      reducedJacobian_.setConstant (sqrt (-1));
-      dqSmall_.resize (nbNonLockedDofs_);
-      dq_.setZero ();
       toMinusFromSmall_.resize (nbNonLockedDofs_);
       projMinusFromSmall_.resize (nbNonLockedDofs_);
       projMinusFrom_.setZero ();
-      reducedProjector_.resize (nbNonLockedDofs_, nbNonLockedDofs_);
+      resize (workspace_);
+      // Workspaces of projectBatch are resized when needed
+      workspaces_.clear ();
+    }
+
+    void ConfigProjector::resize (Workspace_t& ws) const
+    {
+      size_type nbRows = 0;
+      ws.values.clear ();
+      ws.jacobians.clear ();
+      for (NumericalConstraints_t::const_iterator itConstraint =
+	     constraints_.begin ();
+	   itConstraint != constraints_.end (); itConstraint ++) {
+	size_type size = itConstraint->function->outputSize ();
+	ws.values.push_back (vector_t (size));
+	ws.jacobians.push_back (matrix_t::Zero (size, robot_->numberDof ()));
+	nbRows += size;
+      }
+      ws.value.resize (nbRows);
+      ws.reducedJacobian.resize (nbRows, nbNonLockedDofs_);
+      // Columns that no function depends on are never written
+      ws.reducedJacobian.setZero ();
+      ws.dqSmall.resize (nbNonLockedDofs_);
+      ws.dq = vector_t::Zero (robot_->numberDof ());
+      // Allocate decompositions and working memory
+      ws.svd = Eigen::JacobiSVD <matrix_t>
+	(nbRows, nbNonLockedDofs_, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      ws.qr = Eigen::ColPivHouseholderQR <matrix_t> (nbNonLockedDofs_, nbRows);
+      ws.ldlt = Eigen::LDLT <matrix_t> (nbRows);
+      ws.jacobianTranspose.resize (nbNonLockedDofs_, nbRows);
+      ws.squareJacobian.resize (nbRows, nbRows);
+      ws.rhs.resize (nbRows);
+      ws.savedConfiguration.resize (robot_->configSize ());
+      ws.savedValue.resize (nbRows);
+      ws.savedJacobian.resize (nbRows, nbNonLockedDofs_);
     }
 
     void ConfigProjector::computeValueAndJacobian
-    (ConfigurationIn_t configuration)
+    (ConfigurationIn_t configuration, Workspace_t& ws) const
     {
       size_type row = 0, nbRows = 0;
-      for (NumericalConstraints_t::iterator itConstraint =
+      std::size_t i = 0;
+      for (NumericalConstraints_t::const_iterator itConstraint =
 	     constraints_.begin ();
-	   itConstraint != constraints_.end (); itConstraint ++) {
-	DifferentiableFunction& f = *(itConstraint->function);
-	vector_t& value = itConstraint->value;
-	matrix_t& jacobian = itConstraint->jacobian;
+	   itConstraint != constraints_.end (); itConstraint ++, i++) {
+	const DifferentiableFunction& f = *(itConstraint->function);
+	vector_t& value = ws.values [i];
+	matrix_t& jacobian = ws.jacobians [i];
 	f (value, configuration);
 	f.jacobian (jacobian, configuration);
 	nbRows = f.outputSize ();
-	// Copy columns that are not locked
-	size_type col = 0;
-	value_.segment (row, nbRows) = value;
-	for (Intervals_t::const_iterator itInterval = intervals_.begin ();
-	     itInterval != intervals_.end (); itInterval ++) {
-	  size_type col0 = itInterval->first;
-	  size_type nbCols = itInterval->second;
-	  reducedJacobian_.block (row, col, nbRows, nbCols) =
-	    jacobian.block (0, col0, nbRows, nbCols);
-	  col += nbCols;
+	// Copy columns the function depends on that are not locked
+	ws.value.segment (row, nbRows) = value;
+	for (JacobianBlocks_t::const_iterator itBlock =
+	       itConstraint->blocks.begin ();
+	     itBlock != itConstraint->blocks.end (); itBlock ++) {
+	  ws.reducedJacobian.block (row, itBlock->reducedCol, nbRows,
+				  itBlock->nbCols) =
+	    jacobian.block (0, itBlock->col, nbRows, itBlock->nbCols);
 	}
 	row += nbRows;
       }
@@ -148,7 +247,7 @@ namespace hpp {
     /// Convert vector of non locked degrees of freedom to vector of
     /// all degrees of freedom
     void ConfigProjector::smallToNormal (vectorIn_t small,
-					 vectorOut_t normal)
+					 vectorOut_t normal) const
     {
       assert (small.size () + (size_type) lockedDofs_.size () ==
 	      robot_->numberDof ());
@@ -164,7 +263,7 @@ namespace hpp {
     }
 
     void ConfigProjector::normalToSmall (vectorIn_t normal,
-					 vectorOut_t small)
+					 vectorOut_t small) const
     {
       assert (small.size () + (size_type) lockedDofs_.size () ==
 	      robot_->numberDof ());
@@ -180,72 +279,342 @@ namespace hpp {
     }
 
     bool ConfigProjector::impl_compute (ConfigurationOut_t configuration)
+    {
+      value_type alpha = initialStep;
+      return project (configuration, workspace_, alpha);
+    }
+
+    bool ConfigProjector::apply (ConfigurationOut_t configuration,
+				 WarmStart_t& warmStart)
+    {
+      value_type alpha;
+      if (warmStart.valid) {
+	// Move previous result as configuration moved from previous input
+	model::difference (robot_, configuration, warmStart.input,
+			   warmStartStep_);
+	warmStart.input = configuration;
+	model::integrate (robot_, warmStart.output, warmStartStep_,
+			  configuration);
+	alpha = warmStart.alpha;
+	if (project (configuration, workspace_, alpha)) {
+	  warmStart.output = configuration;
+	  warmStart.alpha = alpha;
+	  return true;
+	}
+	hppDout (info, "Warm started projection failed.");
+	configuration = warmStart.input;
+      } else {
+	warmStart.input = configuration;
+      }
+      alpha = initialStep;
+      warmStart.valid = project (configuration, workspace_, alpha);
+      if (warmStart.valid) {
+	warmStart.output = configuration;
+	warmStart.alpha = alpha;
+      }
+      return warmStart.valid;
+    }
+
+    bool ConfigProjector::projectBatch (matrixOut_t configurations,
+					std::vector <bool>& success,
+					std::size_t nbThreads)
+    {
+      std::size_t nbConfigs = configurations.cols ();
+      if (nbThreads == 0) {
+	nbThreads = std::max (boost::thread::hardware_concurrency (), 1u);
+      }
+      nbThreads = std::min (nbThreads, nbConfigs);
+      if (!threadSafe ()) nbThreads = 1;
+      // Elements of std::vector <bool> cannot be written concurrently
+      std::vector <char> results (nbConfigs, false);
+      if (nbThreads <= 1) {
+	projectRange (configurations, results, 0, nbConfigs, workspace_);
+      } else {
+	while (workspaces_.size () < nbThreads) {
+	  workspaces_.push_back (Workspace_t ());
+	  resize (workspaces_.back ());
+	}
+	boost::thread_group threads;
+	for (std::size_t rank = 0; rank < nbThreads; ++rank) {
+	  threads.create_thread
+	    (boost::bind (&ConfigProjector::projectRange, this,
+			  boost::ref (configurations), boost::ref (results),
+			  (rank * nbConfigs)/nbThreads,
+			  ((rank + 1) * nbConfigs)/nbThreads,
+			  boost::ref (workspaces_ [rank])));
+	}
+	threads.join_all ();
+	for (std::size_t rank = 0; rank < nbThreads; ++rank) {
+	  workspace_.iterations += workspaces_ [rank].iterations;
+	  workspace_.failures += workspaces_ [rank].failures;
+	  workspaces_ [rank].iterations = 0;
+	  workspaces_ [rank].failures = 0;
+	  for (std::size_t i = 0; i < 3; ++i) {
+	    workspace_.statuses [i] += workspaces_ [rank].statuses [i];
+	    workspaces_ [rank].statuses [i] = 0;
+	  }
+	}
+      }
+      success.assign (results.begin (), results.end ());
+      return std::find (results.begin (), results.end (), false) ==
+	results.end ();
+    }
+
+    void ConfigProjector::projectRange (matrixOut_t configurations,
+					std::vector <char>& success,
+					std::size_t begin, std::size_t end,
+					Workspace_t& ws) const
+    {
+      for (std::size_t i = begin; i < end; ++i) {
+	value_type alpha = initialStep;
+	success [i] = project (configurations.col (i), ws, alpha);
+      }
+    }
+
+    bool ConfigProjector::project (ConfigurationOut_t configuration,
+				   Workspace_t& ws, value_type& alpha) const
     {
       hppDout (info, "before projection: " << configuration.transpose ());
       computeLockedDofs (configuration);
-      value_type alpha = .2;
+      switch (algorithm_) {
+      case NEWTON_RAPHSON:
+	newtonRaphson (configuration, ws, alpha);
+	break;
+      case LEVENBERG_MARQUARDT:
+	levenbergMarquardt (configuration, ws);
+	break;
+      }
+      hppDout (info, "number of iterations: " << ws.report.iterations);
+      ws.iterations += ws.report.iterations;
+      ++ws.statuses [ws.report.status];
+      if (ws.report.status != SUCCESS) {
+	hppDout (info, "Projection failed.");
+	++ws.failures;
+	return false;
+      }
+      hppDout (info, "After projection: " << configuration.transpose ());
+      return true;
+    }
+
+    void ConfigProjector::newtonRaphson (ConfigurationOut_t configuration,
+					 Workspace_t& ws,
+					 value_type& alpha) const
+    {
       value_type alphaMax = .95;
       size_type errorDecreased = 3, iter = 0;
       value_type previousSquareNorm =
 	std::numeric_limits<value_type>::infinity();
       value_type squareNorm;
       // Fill value and Jacobian
-      computeValueAndJacobian (configuration);
-      squareNorm = value_.squaredNorm ();
+      computeValueAndJacobian (configuration, ws);
+      squareNorm = ws.value.squaredNorm ();
       while (squareNorm > squareErrorThreshold_ && errorDecreased &&
 	     iter < maxIterations_) {
 	// Linearization of the system of equations
 	// 0 - v_{i} = J (q_i) (q_{i+1} - q_{i})
 	// q_{i+1} = q_{i} - \alpha_{i} J(q_i)^{+} v_{i}
 	// dq = J(q_i)^{+} v_{i}
-	Eigen::JacobiSVD <matrix_t> svd (reducedJacobian_,
-					 Eigen::ComputeThinU |
-					 Eigen::ComputeThinV);
-	dqSmall_ = svd.solve(value_);
-	smallToNormal (dqSmall_, dq_);
-	vector_t v (-alpha * dq_);
-	model::integrate (robot_, configuration, v, configuration);
+	decomposeJacobian (ws);
+	solveJacobian (ws);
+	smallToNormal (ws.dqSmall, ws.dq);
+	ws.dq *= -alpha;
+	model::integrate (robot_, configuration, ws.dq, configuration);
 	// Increase alpha towards alphaMax
 	alpha = alphaMax - .8*(alphaMax - alpha);
-	squareNorm = value_.squaredNorm ();
+	squareNorm = ws.value.squaredNorm ();
 	hppDout (info, "squareNorm = " << squareNorm);
 	--errorDecreased;
 	if (squareNorm < previousSquareNorm) errorDecreased = 3;
 	previousSquareNorm = squareNorm;
 	++iter;
-	computeValueAndJacobian (configuration);
+	computeValueAndJacobian (configuration, ws);
       };
-      hppDout (info, "number of iterations: " << iter);
+      ws.report.iterations = iter;
+      ws.report.residual = ws.value.norm ();
+      if (squareNorm <= squareErrorThreshold_) ws.report.status = SUCCESS;
+      else if (!errorDecreased) ws.report.status = NO_DECREASE;
+      else ws.report.status = MAX_ITERATIONS;
+    }
+
+    void ConfigProjector::levenbergMarquardt
+    (ConfigurationOut_t configuration, Workspace_t& ws) const
+    {
+      size_type iter = 0;
+      computeValueAndJacobian (configuration, ws);
+      value_type squareNorm = ws.value.squaredNorm ();
+      ws.report.status = MAX_ITERATIONS;
       if (squareNorm > squareErrorThreshold_) {
-	hppDout (info, "Projection failed.");
-	return false;
+	// Damping is scaled by the largest diagonal element of J J^T
+	value_type scale = ws.reducedJacobian.rowwise ().squaredNorm ().
+	  maxCoeff ();
+	if (scale <= 0) scale = 1;
+	value_type lambda = initialDamping * scale;
+	value_type nu = 2;
+	while (iter < maxIterations_) {
+	  ++iter;
+	  // dq = - J^T y with y = (J J^T + lambda I)^{-1} v
+	  ws.squareJacobian.noalias () =
+	    ws.reducedJacobian * ws.reducedJacobian.transpose ();
+	  ws.squareJacobian.diagonal ().array () += lambda;
+	  ws.ldlt.compute (ws.squareJacobian);
+	  ws.rhs = ws.value;
+	  ws.ldlt.solveInPlace (ws.rhs);
+	  ws.dqSmall.noalias () = - ws.reducedJacobian.transpose () * ws.rhs;
+	  // The linearized value v + J dq = lambda y
+	  value_type predicted = squareNorm - lambda * lambda *
+	    ws.rhs.squaredNorm ();
+	  ws.savedConfiguration = configuration;
+	  ws.savedValue = ws.value;
+	  ws.savedJacobian = ws.reducedJacobian;
+	  smallToNormal (ws.dqSmall, ws.dq);
+	  model::integrate (robot_, configuration, ws.dq, configuration);
+	  computeValueAndJacobian (configuration, ws);
+	  value_type newSquareNorm = ws.value.squaredNorm ();
+	  hppDout (info, "squareNorm = " << newSquareNorm << ", lambda = "
+		   << lambda);
+	  value_type rho = predicted > 0 ?
+	    (squareNorm - newSquareNorm) / predicted : -1;
+	  if (rho > 0) {
+	    squareNorm = newSquareNorm;
+	    if (squareNorm <= squareErrorThreshold_) {
+	      ws.report.status = SUCCESS;
+	      break;
+	    }
+	    value_type factor = 2 * rho - 1;
+	    lambda *= std::max (1./3, 1 - factor * factor * factor);
+	    nu = 2;
+	  } else {
+	    // Reject step
+	    configuration = ws.savedConfiguration;
+	    ws.value.swap (ws.savedValue);
+	    ws.reducedJacobian.swap (ws.savedJacobian);
+	    lambda *= nu;
+	    nu *= 2;
+	    if (lambda > maxDamping * scale) {
+	      ws.report.status = NO_DECREASE;
+	      break;
+	    }
+	  }
+	}
+      } else {
+	ws.report.status = SUCCESS;
       }
-      hppDout (info, "After projection: " << configuration.transpose ());
-      return true;
+      ws.report.iterations = iter;
+      ws.report.residual = sqrt (squareNorm);
     }
 
     void ConfigProjector::projectOnKernel (ConfigurationIn_t from,
 					   ConfigurationIn_t to,
 					   ConfigurationOut_t result)
     {
-      computeValueAndJacobian (from);
+      computeValueAndJacobian (from, workspace_);
       model::difference (robot_, to, from, toMinusFrom_);
       normalToSmall (toMinusFrom_, toMinusFromSmall_);
-      typedef Eigen::JacobiSVD < matrix_t > Jacobi_t;
-      Jacobi_t svd (reducedJacobian_, Eigen::ComputeFullV);
-      size_type p = svd.nonzeroSingularValues ();
-      size_type n = nbNonLockedDofs_;
-      const Eigen::Block <const matrix_t> V1=svd.matrixV ().block (0, 0, n, p);
-      reducedProjector_.setIdentity ();
-      reducedProjector_ -= V1 * V1.transpose ();
-      projMinusFromSmall_ = reducedProjector_ * toMinusFromSmall_;
+      decomposeJacobian (workspace_);
+      projectOnJacobianKernel (workspace_, toMinusFromSmall_,
+			       projMinusFromSmall_);
       smallToNormal (projMinusFromSmall_, projMinusFrom_);
       model::integrate (robot_, from, projMinusFrom_, result);
     }
 
+    void ConfigProjector::decomposeJacobian (Workspace_t& ws) const
+    {
+      if (ws.value.size () == 0) return;
+      switch (linearSolver_) {
+      case SVD:
+	ws.svd.compute (ws.reducedJacobian);
+	break;
+      case QR:
+	ws.jacobianTranspose = ws.reducedJacobian.transpose ();
+	ws.qr.compute (ws.jacobianTranspose);
+	break;
+      case DAMPED_LDLT:
+	ws.squareJacobian.noalias () =
+	  ws.reducedJacobian * ws.reducedJacobian.transpose ();
+	ws.squareJacobian.diagonal ().array () += damping_;
+	ws.ldlt.compute (ws.squareJacobian);
+	break;
+      }
+    }
+
+    void ConfigProjector::solveJacobian (Workspace_t& ws) const
+    {
+      if (ws.value.size () == 0) {
+	ws.dqSmall.setZero ();
+	return;
+      }
+      switch (linearSolver_) {
+      case SVD:
+	{
+	  // dq = V_p S_p^{-1} U_p^T v with p nonzero singular values
+	  size_type p = ws.svd.nonzeroSingularValues ();
+	  ws.rhs.head (p).noalias () =
+	    ws.svd.matrixU ().leftCols (p).transpose () * ws.value;
+	  ws.rhs.head (p).array () /= ws.svd.singularValues ().head (p).array ();
+	  ws.dqSmall.noalias () = ws.svd.matrixV ().leftCols (p) * ws.rhs.head (p);
+	}
+	break;
+      case QR:
+	{
+	  // J^T P = Q R, hence dq = Q_r R_r^{-T} (P^T v)_r, where r is the
+	  // rank of J
+	  size_type r = ws.qr.rank ();
+	  ws.rhs = ws.qr.colsPermutation ().transpose () * ws.value;
+	  ws.qr.matrixQR ().topLeftCorner (r, r).
+	    triangularView <Eigen::Upper> ().transpose ().
+	    solveInPlace (ws.rhs.head (r));
+	  ws.dqSmall.head (r) = ws.rhs.head (r);
+	  ws.dqSmall.tail (nbNonLockedDofs_ - r).setZero ();
+	  applyHouseholderQ (ws.qr.matrixQR (), ws.qr.hCoeffs (), false,
+			     ws.dqSmall);
+	}
+	break;
+      case DAMPED_LDLT:
+	// dq = J^T (J J^T + damping I)^{-1} v
+	ws.rhs = ws.value;
+	ws.ldlt.solveInPlace (ws.rhs);
+	ws.dqSmall.noalias () = ws.reducedJacobian.transpose () * ws.rhs;
+	break;
+      }
+    }
+
+    void ConfigProjector::projectOnJacobianKernel (Workspace_t& ws,
+						   vectorIn_t v,
+						   vectorOut_t result) const
+    {
+      result = v;
+      if (ws.value.size () == 0) return;
+      switch (linearSolver_) {
+      case SVD:
+	{
+	  // Remove components along the p first right singular vectors
+	  size_type p = ws.svd.nonzeroSingularValues ();
+	  ws.rhs.head (p).noalias () =
+	    ws.svd.matrixV ().leftCols (p).transpose () * v;
+	  result.noalias () -= ws.svd.matrixV ().leftCols (p) * ws.rhs.head (p);
+	}
+	break;
+      case QR:
+	{
+	  // The r first columns of Q span the image of J^T
+	  size_type r = ws.qr.rank ();
+	  applyHouseholderQ (ws.qr.matrixQR (), ws.qr.hCoeffs (), true, result);
+	  result.head (r).setZero ();
+	  applyHouseholderQ (ws.qr.matrixQR (), ws.qr.hCoeffs (), false, result);
+	}
+	break;
+      case DAMPED_LDLT:
+	ws.rhs.noalias () = ws.reducedJacobian * v;
+	ws.ldlt.solveInPlace (ws.rhs);
+	result.noalias () -= ws.reducedJacobian.transpose () * ws.rhs;
+	break;
+      }
+    }
+
     void ConfigProjector::computeLockedDofs (ConfigurationOut_t configuration)
+      const
     {
-      for (LockedDofs_t::iterator itLock = lockedDofs_.begin ();
+      for (LockedDofs_t::const_iterator itLock = lockedDofs_.begin ();
 	   itLock != lockedDofs_.end (); itLock ++) {
 	configuration [(*itLock)->index ()] = (*itLock)->value ();
       }
@@ -16,6 +16,7 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <hpp/core/constraint-set.hh>
 #include <hpp/core/config-projector.hh>
 
@@ -52,6 +53,48 @@ namespace hpp {
       }
       return true;
     }
+    bool ConstraintSet::apply (ConfigurationOut_t configuration,
+			       ConfigProjector::WarmStart_t& warmStart)
+    {
+      for (Constraints_t::iterator itConstraint = constraints_.begin ();
+	   itConstraint != constraints_.end (); itConstraint ++) {
+	if (*itConstraint == configProjector_) {
+	  if (!configProjector_->apply (configuration, warmStart))
+	    return false;
+	} else if (!(*itConstraint)->impl_compute (configuration)) {
+	  return false;
+	}
+      }
+      return true;
+    }
+
+    bool ConstraintSet::applyBatch (matrixOut_t configurations,
+				    std::vector <bool>& success,
+				    std::size_t nbThreads)
+    {
+      success.assign (configurations.cols (), true);
+      std::vector <bool> projected;
+      for (Constraints_t::iterator itConstraint = constraints_.begin ();
+	   itConstraint != constraints_.end (); itConstraint ++) {
+	if (*itConstraint == configProjector_) {
+	  configProjector_->projectBatch (configurations, projected,
+					  nbThreads);
+	  for (std::size_t i = 0; i < success.size (); ++i) {
+	    success [i] = success [i] && projected [i];
+	  }
+	} else {
+	  for (std::size_t i = 0; i < success.size (); ++i) {
+	    if (success [i]) {
+	      success [i] = (*itConstraint)->impl_compute
+		(configurations.col (i));
+	    }
+	  }
+	}
+      }
+      return std::find (success.begin (), success.end (), false) ==
+	success.end ();
+    }
+
     ConstraintSet::ConstraintSet (const DevicePtr_t& robot,
 				  const std::string& name) :
       Constraint (name), constraints_ (), configProjector_ (),
@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <limits>
+#include <stdexcept>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include <hpp/core/continuous-collision-checking.hh>
+#include <hpp/core/discretized-collision-checking.hh>
+#include <hpp/core/straight-path.hh>
+#include <hpp/core/weighed-distance.hh>
+
+namespace hpp {
+  namespace core {
+
+    ContinuousCollisionCheckingPtr_t
+    ContinuousCollisionChecking::create (const DevicePtr_t& robot,
+					 const WeighedDistancePtr_t& distance,
+					 const value_type& tolerance,
+					 const value_type& stepSize)
+    {
+      ContinuousCollisionChecking* ptr =
+	new ContinuousCollisionChecking (robot, distance, tolerance, stepSize);
+      return ContinuousCollisionCheckingPtr_t (ptr);
+    }
+
+    value_type ContinuousCollisionChecking::maximalVelocity
+    (const PathPtr_t& path)
+    {
+      const interval_t& timeRange (path->timeRange ());
+      Configuration_t q1 ((*path) (timeRange.first));
+      Configuration_t q2 ((*path) (timeRange.second));
+      value_type result = 0;
+      std::size_t i=0;
+      const JointVector_t& jointVector (robot_->getJointVector ());
+      for (JointVector_t::const_iterator itJoint = jointVector.begin ();
+	   itJoint != jointVector.end (); itJoint++) {
+	if ((*itJoint)->numberDof () != 0) {
+	  result += distance_->getWeight (i) *
+	    (*itJoint)->configuration ()->distance
+	    (q1, q2, (*itJoint)->rankInConfiguration ());
+	  ++i;
+	}
+      }
+      return result / (timeRange.second - timeRange.first);
+    }
+
+    value_type ContinuousCollisionChecking::distanceToObstacles
+    (ConfigurationIn_t q)
+    {
+      ++numberSamples_;
+      robot_->currentConfiguration (q);
+      robot_->computeForwardKinematics ();
+      if (robot_->collisionTest ()) return 0;
+      robot_->computeDistances ();
+      const model::DistanceResults_t& results (robot_->distanceResults ());
+      value_type result = std::numeric_limits <value_type>::infinity ();
+      for (model::DistanceResults_t::const_iterator itResult =
+	     results.begin (); itResult != results.end (); ++itResult) {
+	if (itResult->distance () < result) {
+	  result = itResult->distance ();
+	}
+      }
+      return result;
+    }
+
+    bool ContinuousCollisionChecking::validate
+    (const PathPtr_t& path, bool reverse, PathPtr_t& validPart)
+    {
+      if (path->constraints () ||
+	  !HPP_DYNAMIC_PTR_CAST (StraightPath, path)) {
+	return discretized_->validate (path, reverse, validPart);
+      }
+      value_type tmin = path->timeRange ().first;
+      value_type tmax = path->timeRange ().second;
+      value_type velocity = tmax > tmin ? maximalVelocity (path) : 0;
+      // Parameters are explored from tmin to tmax in the direction given by
+      // reverse.
+      value_type tbegin = reverse ? tmax : tmin;
+      value_type tend = reverse ? tmin : tmax;
+      value_type sign = reverse ? -1 : 1;
+      value_type t = tbegin;
+      value_type lastValidTime = tbegin;
+      while (true) {
+	(*path) (q_, t);
+	value_type distance = distanceToObstacles (q_);
+	if (distance == std::numeric_limits <value_type>::infinity ()) {
+	  // No pair is registered for distance computation: nothing bounds
+	  // the motion between samples.
+	  return discretized_->validate (path, reverse, validPart);
+	}
+	if (distance <= tolerance_) {
+	  hppDout (info, "distance to obstacles " << distance << " at " << t);
+	  if (reverse) {
+	    validPart = path->extract (std::make_pair (lastValidTime, tmax));
+	  } else {
+	    validPart = path->extract (std::make_pair (tmin, lastValidTime));
+	  }
+	  return false;
+	}
+	lastValidTime = t;
+	// The robot cannot travel more than distance before parameter
+	// t + distance/velocity.
+	if (velocity <= 0 || distance >= velocity * sign * (tend - t)) {
+	  validPart = path;
+	  return true;
+	}
+	t += sign * distance / velocity;
+      }
+    }
+
+    PathValidationPtr_t ContinuousCollisionChecking::clone
+    (const DevicePtr_t& robot) const
+    {
+      return create (robot, distance_, tolerance_, stepSize_);
+    }
+
+    void ContinuousCollisionChecking::obstaclesChanged ()
+    {
+      discretized_->obstaclesChanged ();
+    }
+
+    ContinuousCollisionChecking::ContinuousCollisionChecking
+    (const DevicePtr_t& robot, const WeighedDistancePtr_t& distance,
+     const value_type& tolerance, const value_type& stepSize) :
+      PathValidation (), robot_ (robot), distance_ (distance),
+      tolerance_ (tolerance), stepSize_ (stepSize),
+      discretized_ (DiscretizedCollisionChecking::create (robot, stepSize)),
+      q_ (robot->configSize ())
+    {
+      // Every step covers at least tolerance: a non positive value would
+      // let the steps shrink without limit near obstacles.
+      if (tolerance <= 0) {
+	throw std::runtime_error
+	  ("ContinuousCollisionChecking: tolerance should be positive.");
+      }
+    }
+
+  } // namespace core
+} // namespace hpp
@@ -48,16 +48,22 @@ namespace hpp {
 
     DiffusingPlanner::DiffusingPlanner (const Problem& problem):
       PathPlanner (problem),
-      configurationShooter_ (new BasicConfigurationShooter (problem.robot ())),
-      qProj_ (problem.robot ()->configSize ())
+      configurationShooter_ (new BasicConfigurationShooter
+			     (problem.robot (),
+			      problem.randomGenerator ()->split ())),
+      qProj_ (problem.robot ()->configSize ()),
+      qRand_ (new Configuration_t (problem.robot ()->configSize ()))
     {
     }
 
     DiffusingPlanner::DiffusingPlanner (const Problem& problem,
 					const RoadmapPtr_t& roadmap) :
       PathPlanner (problem, roadmap),
-      configurationShooter_ (new BasicConfigurationShooter (problem.robot ())),
-      qProj_ (problem.robot ()->configSize ())
+      configurationShooter_ (new BasicConfigurationShooter
+			     (problem.robot (),
+			      problem.randomGenerator ()->split ())),
+      qProj_ (problem.robot ()->configSize ()),
+      qRand_ (new Configuration_t (problem.robot ()->configSize ()))
     {
     }
 
@@ -76,19 +82,24 @@ namespace hpp {
       const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
       const ConstraintSetPtr_t& constraints (sm->constraints ());
       if (constraints) {
-	ConfigProjectorPtr_t configProjector (constraints->configProjector ());
-	if (configProjector) {
-	  configProjector->projectOnKernel (*(near->configuration ()), *target,
-					    qProj_);
-	} else {
-	  qProj_ = *target;
-	}
-	if (constraints->apply (qProj_)) {
-	  return (*sm) (*(near->configuration ()), qProj_);
-	} else {
-	  return PathPtr_t ();
+	bool projected;
+	{
+	  Statistics::Timer timer (timers (), Statistics::PROJECTION);
+	  ConfigProjectorPtr_t configProjector
+	    (constraints->configProjector ());
+	  if (configProjector) {
+	    configProjector->projectOnKernel (*(near->configuration ()),
+					      *target, qProj_);
+	  } else {
+	    qProj_ = *target;
+	  }
+	  projected = constraints->apply (qProj_);
 	}
+	if (!projected) return PathPtr_t ();
+	Statistics::Timer timer (timers (), Statistics::STEERING);
+	return (*sm) (*(near->configuration ()), qProj_);
       }
+      Statistics::Timer timer (timers (), Statistics::STEERING);
       return (*sm) (*(near->configuration ()), *target);
     }
 
@@ -99,35 +110,54 @@ namespace hpp {
       Nodes_t newNodes;
       PathPtr_t validPath, path;
       // Pick a random node
-      ConfigurationPtr_t q_rand = configurationShooter_->shoot ();
+      const ConfigurationPtr_t& q_rand (qRand_);
+      {
+	Statistics::Timer timer (timers (), Statistics::SHOOTING);
+	configurationShooter_->shoot (*q_rand);
+      }
       hppDout (info, "q_rand = " << displayConfig (*q_rand));
       //
       // First extend each connected component toward q_rand
       //
+      NearestNodes_t nearestNodes;
+      {
+	Statistics::Timer timer (timers (), Statistics::NEAREST_NEIGHBOR);
+	roadmap ()->nearestNodes (q_rand, nearestNodes);
+      }
       for (ConnectedComponents_t::const_iterator itcc =
 	     roadmap ()->connectedComponents ().begin ();
 	   itcc != roadmap ()->connectedComponents ().end (); itcc++) {
 	// Find nearest node in roadmap
-	value_type distance;
-	NodePtr_t near = roadmap ()->nearestNode (q_rand, *itcc, distance);
+	NodePtr_t near;
+	NearestNodes_t::const_iterator itNearest = nearestNodes.find (*itcc);
+	if (itNearest != nearestNodes.end ()) {
+	  near = itNearest->second.first;
+	} else {
+	  // Connected component created during this step
+	  Statistics::Timer timer (timers (), Statistics::NEAREST_NEIGHBOR);
+	  value_type distance;
+	  near = roadmap ()->nearestNode (q_rand, *itcc, distance);
+	}
 	path = extend (near, q_rand);
 	if (path) {
-	  bool pathValid = pathValidation->validate (path, false, validPath);
+	  bool pathValid;
+	  {
+	    Statistics::Timer timer (timers (), Statistics::COLLISION_CHECKING);
+	    pathValid = pathValidation->validate (path, false, validPath);
+	  }
 	  // Insert new path to q_near in roadmap
 	  value_type t_final = validPath->timeRange ().second;
 	  if (t_final != path->timeRange ().first) {
 	    ConfigurationPtr_t q_new (new Configuration_t
 				      ((*validPath) (t_final)));
 	    if (!pathValid || !belongs (q_new, newNodes)) {
+	      // q_new is the random configuration or the end of the valid
+	      // part of the extension: it is not in the roadmap.
 	      newNodes.push_back (roadmap ()->addNodeAndEdge
-				  (near, q_new, validPath));
+				  (near, q_new, validPath, false));
 	    } else {
 	      NodePtr_t newNode = roadmap ()->addNode (q_new);
-	      roadmap ()->addEdge (near, newNode, validPath);
-	      interval_t timeRange = validPath->timeRange ();
-	      roadmap ()->addEdge (newNode, near, validPath->extract
-				   (interval_t (timeRange.second ,
-						      timeRange.first)));
+	      roadmap ()->addEdges (near, newNode, validPath);
 	    }
 	  }
 	}
@@ -143,13 +173,17 @@ namespace hpp {
 	  ConfigurationPtr_t q1 ((*itn1)->configuration ());
 	  ConfigurationPtr_t q2 ((*itn2)->configuration ());
 	  assert (*q1 != *q2);
-	  path = (*sm) (*q1, *q2);
-	  if (pathValidation->validate (path, false, validPath)) {
-	    roadmap ()->addEdge (*itn1, *itn2, path);
-	    interval_t timeRange = path->timeRange ();
-	    roadmap ()->addEdge (*itn2, *itn1, path->extract
-				 (interval_t (timeRange.second,
-					      timeRange.first)));
+	  bool pathValid;
+	  {
+	    Statistics::Timer timer (timers (), Statistics::STEERING);
+	    path = (*sm) (*q1, *q2);
+	  }
+	  {
+	    Statistics::Timer timer (timers (), Statistics::COLLISION_CHECKING);
+	    pathValid = pathValidation->validate (path, false, validPath);
+	  }
+	  if (pathValid) {
+	    roadmap ()->addEdges (*itn1, *itn2, path);
 	  }
 	}
       }
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_DISCRETIZATION_HH
+# define HPP_CORE_DISCRETIZATION_HH
+
+# include <cmath>
+# include <deque>
+# include <vector>
+# include <hpp/core/fwd.hh>
+
+namespace hpp {
+  namespace core {
+    /// Parameters checked by discretized collision checking
+    ///
+    /// \param timeRange interval of definition of the path,
+    /// \param stepSize distance between consecutive parameters,
+    /// \param reverse whether to start from the end of the interval,
+    /// \retval times parameters in the order they are checked: every
+    ///         stepSize from the beginning (or the end) of the interval,
+    ///         then the other bound.
+    inline void sequentialParameters (const interval_t& timeRange,
+				      value_type stepSize, bool reverse,
+				      std::vector <value_type>& times)
+    {
+      value_type tmin = timeRange.first;
+      value_type tmax = timeRange.second;
+      times.clear ();
+      unsigned finished = 0;
+      if (reverse) {
+	value_type t = tmax - stepSize;
+	while (finished < 2) {
+	  times.push_back (t);
+	  t -= stepSize;
+	  if (t < tmin) {
+	    t = tmin;
+	    finished++;
+	  }
+	}
+      } else {
+	value_type t = tmin + stepSize;
+	while (finished < 2) {
+	  times.push_back (t);
+	  t += stepSize;
+	  if (t > tmax) {
+	    t = tmax;
+	    finished++;
+	  }
+	}
+      }
+    }
+
+    /// Parameters checked by discretized collision checking in bisection
+    /// order
+    ///
+    /// \param timeRange interval of definition of the path,
+    /// \param stepSize maximal distance between consecutive parameters,
+    /// \retval times parameters of sequentialParameters in forward
+    ///         order, reordered by bisection: the middle one, then the
+    ///         middles of both halves, and so on. The upper bound of the
+    ///         interval comes last. As for sequential checking, the lower
+    ///         bound is not checked.
+    inline void bisectionParameters (const interval_t& timeRange,
+				     value_type stepSize,
+				     std::vector <value_type>& times)
+    {
+      value_type tmin = timeRange.first;
+      value_type tmax = timeRange.second;
+      times.clear ();
+      std::size_t n = (std::size_t) std::ceil ((tmax - tmin)/stepSize);
+      if (n == 0) n = 1;
+      // Index k < n stands for tmin + k stepSize, index n for tmax.
+      // Intervals of indices, explored breadth first
+      std::deque <std::pair <std::size_t, std::size_t> > intervals;
+      intervals.push_back (std::make_pair (0, n));
+      while (!intervals.empty ()) {
+	std::size_t begin = intervals.front ().first;
+	std::size_t end = intervals.front ().second;
+	intervals.pop_front ();
+	if (end - begin < 2) continue;
+	std::size_t middle = (begin + end)/2;
+	times.push_back (tmin + middle * stepSize);
+	intervals.push_back (std::make_pair (begin, middle));
+	intervals.push_back (std::make_pair (middle, end));
+      }
+      times.push_back (tmax);
+    }
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_DISCRETIZATION_HH
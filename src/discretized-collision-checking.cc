@@ -16,9 +16,18 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <limits>
+#include <boost/thread/thread.hpp>
+#include <hpp/fcl/collision.h>
+#include <hpp/model/body.hh>
+#include <hpp/model/collision-object.hh>
 #include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/config-projector.hh>
 #include <hpp/core/path.hh>
 #include <hpp/core/discretized-collision-checking.hh>
+#include "discretization.hh"
 
 namespace hpp {
   namespace core {
@@ -35,71 +44,336 @@ namespace hpp {
     bool DiscretizedCollisionChecking::validate
     (const PathPtr_t& path, bool reverse, PathPtr_t& validPart)
     {
-      bool valid = true;
+      value_type tmin = path->timeRange ().first;
+      value_type tmax = path->timeRange ().second;
+      sequentialParameters (path->timeRange (), stepSize_, reverse, times_);
+      std::size_t index = firstCollision (path);
+      if (index == times_.size ()) {
+	validPart = path;
+	return true;
+      }
       if (reverse) {
-	value_type tmin = path->timeRange ().first;
-	value_type tmax = path->timeRange ().second;
-	value_type lastValidTime = tmax;
-	value_type t = tmax - stepSize_;
-	unsigned finished = 0;
-	while (finished < 2 && valid) {
-	  Configuration_t q = (*path) (t);
-	  robot_->currentConfiguration (q);
-	  robot_->computeForwardKinematics ();
-	  if (robot_->collisionTest ()) {
-	    valid = false;
-	  } else {
-	    lastValidTime = t;
-	    t -= stepSize_;
-	  }
-	  if (t < tmin) {
-	    t = tmin;
-	    finished++;
-	  }
+	value_type lastValidTime = index == 0 ? tmax : times_ [index - 1];
+	validPart = path->extract (std::make_pair (lastValidTime, tmax));
+      } else {
+	value_type lastValidTime = index == 0 ? tmin : times_ [index - 1];
+	validPart = path->extract (std::make_pair (tmin, lastValidTime));
+      }
+      return false;
+    }
+
+    bool DiscretizedCollisionChecking::isValid (const PathPtr_t& path)
+    {
+      bisectionParameters (path->timeRange (), stepSize_, times_);
+      return firstCollision (path) == times_.size ();
+    }
+
+    std::size_t DiscretizedCollisionChecking::firstCollision
+    (const PathPtr_t& path)
+    {
+      const ConstraintSetPtr_t& constraints = path->constraints ();
+      bool projected = constraints && constraints->configProjector ();
+      // Projection computes the forward kinematics of the robot in between
+      // configurations.
+      bool incremental = incremental_ && !projected;
+      if (incremental) startIncremental ();
+      if (projectionThreads_ == 1 || !projected) {
+	for (std::size_t i = 0; i < times_.size (); ++i) {
+	  (*path) (q_, times_ [i]);
+	  if (collides (q_, incremental)) return i;
 	}
-	if (valid) {
-	  validPart = path;
+	return times_.size ();
+      }
+      // Compute configurations by batches of a few configurations per
+      // thread, so that checking stops soon after the first collision.
+      std::size_t nbThreads = projectionThreads_;
+      if (nbThreads == 0) {
+	nbThreads = std::max (boost::thread::hardware_concurrency (), 1u);
+      }
+      std::size_t batchSize = 4 * nbThreads;
+      for (std::size_t begin = 0; begin < times_.size ();
+	   begin += batchSize) {
+	std::size_t end = std::min (begin + batchSize, times_.size ());
+	batchTimes_.assign (times_.begin () + begin, times_.begin () + end);
+	configurations_.resize (robot_->configSize (), end - begin);
+	path->eval (batchTimes_, configurations_, nbThreads);
+	for (std::size_t i = begin; i < end; ++i) {
+	  if (collides (configurations_.col (i - begin), false)) return i;
+	}
+      }
+      return times_.size ();
+    }
+
+    namespace {
+      bool collide (const CollisionObjectPtr_t& inner,
+		    const CollisionObjectPtr_t& outer)
+      {
+	fcl::CollisionRequest request;
+	fcl::CollisionResult result;
+	return fcl::collide (inner->fcl ().get (), outer->fcl ().get (),
+			     request, result) != 0;
+      }
+    } // namespace
+
+    bool DiscretizedCollisionChecking::collides (ConfigurationIn_t q,
+						 bool incremental)
+    {
+      if (cacheCapacity_ == 0) return testCollision (q, incremental);
+      key_.assign (q.data (), q.data () + q.size ());
+      Validity_t::const_iterator it = cache_.find (key_);
+      if (it != cache_.end ()) {
+	++numberCacheHits_;
+	return it->second;
+      }
+      bool collision = testCollision (q, incremental);
+      if (cache_.size () == cacheCapacity_) {
+	cache_.erase (cacheOrder_.front ());
+	cacheOrder_.pop_front ();
+      }
+      cacheOrder_.push_back (cache_.insert
+			     (std::make_pair (key_, collision)).first);
+      return collision;
+    }
+
+    bool DiscretizedCollisionChecking::testCollision (ConfigurationIn_t q,
+						      bool incremental)
+    {
+      ++numberSamples_;
+      if (incremental && hasReference_) return collidesIncrementally (q);
+      robot_->currentConfiguration (q);
+      robot_->computeForwardKinematics ();
+      if (!hints_.empty ()) {
+	++numberHintTests_;
+	if (hintCollides ()) {
+	  ++numberHintHits_;
 	  return true;
-	} else {
-	  validPart = path->extract (std::make_pair (lastValidTime, tmax));
-	  return false;
 	}
+      }
+      bool collision;
+      if (hintCapacity_ == 0) {
+	collision = robot_->collisionTest ();
       } else {
-	value_type tmin = path->timeRange ().first;
-	value_type tmax = path->timeRange ().second;
-	value_type lastValidTime = tmin;
-	value_type t = tmin + stepSize_;
-	unsigned finished = 0;
-	while (finished < 2 && valid) {
-	  Configuration_t q = (*path) (t);
-	  robot_->currentConfiguration (q);
-	  robot_->computeForwardKinematics ();
-	  if (robot_->collisionTest ()) {
-	    valid = false;
-	  } else {
-	    lastValidTime = t;
-	    t += stepSize_;
-	  }
-	  if (t > tmax) {
-	    t = tmax;
-	    finished ++;
-	  }
+	CollisionHint pair;
+	collision = findCollision (pair);
+	if (collision) remember (pair);
+      }
+      if (!collision && incremental) {
+	qValid_ = q;
+	hasReference_ = true;
+      }
+      return collision;
+    }
+
+    void DiscretizedCollisionChecking::startIncremental ()
+    {
+      hasReference_ = false;
+      // Objects may have been added to the robot since the previous path.
+      movingJoints_.clear ();
+      // Joints may have been replaced even if their number did not change.
+      const JointVector_t& joints (robot_->getJointVector ());
+      if (joints == joints_) return;
+      joints_ = joints;
+      parents_.resize (joints.size ());
+      for (std::size_t i = 0; i < joints.size (); ++i) {
+	JointVector_t::const_iterator itParent =
+	  std::find (joints.begin (), joints.end (),
+		     joints [i]->parentJoint ());
+	parents_ [i] = itParent == joints.end () ? npos :
+	  (std::size_t) (itParent - joints.begin ());
+	// collidesIncrementally visits parents before their children.
+	assert (parents_ [i] == npos || parents_ [i] < i);
+      }
+      moved_.resize (joints.size ());
+    }
+
+    bool DiscretizedCollisionChecking::collidesIncrementally
+    (ConfigurationIn_t q)
+    {
+      ++numberIncrementalSamples_;
+      const JointVector_t& joints (robot_->getJointVector ());
+      // Parents come before their children in the joint vector.
+      bool moving = false;
+      for (std::size_t i = 0; i < joints.size (); ++i) {
+	size_type rank = joints [i]->rankInConfiguration ();
+	size_type size = joints [i]->configSize ();
+	moved_ [i] = (parents_ [i] != npos && moved_ [parents_ [i]]) ||
+	  q.segment (rank, size) != qValid_.segment (rank, size);
+	moving = moving || moved_ [i];
+      }
+      // qValid_ is collision-free.
+      if (!moving) return false;
+      robot_->currentConfiguration (q);
+      for (std::size_t i = 0; i < joints.size (); ++i) {
+	if (!moved_ [i]) continue;
+	if (parents_ [i] == npos) {
+	  joints [i]->recursiveComputePosition (q, model::Transform3f ());
+	} else if (!moved_ [parents_ [i]]) {
+	  joints [i]->recursiveComputePosition
+	    (q, joints [parents_ [i]]->currentTransformation ());
 	}
-	if (valid) {
-	  validPart = path;
+      }
+      if (moved_ != movingJoints_) {
+	computeMovingPairs ();
+	movingJoints_ = moved_;
+      }
+      if (!hints_.empty ()) {
+	++numberHintTests_;
+	if (hintCollides ()) {
+	  ++numberHintHits_;
+	  hasReference_ = false;
 	  return true;
-	} else {
-	  validPart = path->extract (std::make_pair (tmin, lastValidTime));
-	  return false;
 	}
       }
+      for (std::vector <CollisionHint>::const_iterator it =
+	     movingPairs_.begin (); it != movingPairs_.end (); ++it) {
+	if (collide (it->inner, it->outer)) {
+	  if (hintCapacity_ > 0) remember (*it);
+	  hasReference_ = false;
+	  return true;
+	}
+      }
+      qValid_ = q;
+      return false;
+    }
+
+    void DiscretizedCollisionChecking::computeMovingPairs ()
+    {
+      movingPairs_.clear ();
+      const JointVector_t& joints (robot_->getJointVector ());
+      // Sorted objects attached to moving joints
+      std::vector <model::CollisionObject*> movingObjects;
+      for (std::size_t i = 0; i < joints.size (); ++i) {
+	model::BodyPtr_t body = joints [i]->linkedBody ();
+	if (!moved_ [i] || !body) continue;
+	const ObjectVector_t& inner (body->innerObjects (model::COLLISION));
+	for (ObjectVector_t::const_iterator itInner = inner.begin ();
+	     itInner != inner.end (); ++itInner) {
+	  movingObjects.push_back (itInner->get ());
+	}
+      }
+      std::sort (movingObjects.begin (), movingObjects.end ());
+      // Same loops as Device::collisionTest, keeping the pairs the relative
+      // position of which changes
+      for (std::size_t i = 0; i < joints.size (); ++i) {
+	model::BodyPtr_t body = joints [i]->linkedBody ();
+	if (!body) continue;
+	const ObjectVector_t& inner (body->innerObjects (model::COLLISION));
+	const ObjectVector_t& outer (body->outerObjects (model::COLLISION));
+	for (ObjectVector_t::const_iterator itOuter = outer.begin ();
+	     itOuter != outer.end (); ++itOuter) {
+	  if (!moved_ [i] &&
+	      !std::binary_search (movingObjects.begin (), movingObjects.end (),
+				   itOuter->get ())) continue;
+	  for (ObjectVector_t::const_iterator itInner = inner.begin ();
+	       itInner != inner.end (); ++itInner) {
+	    CollisionHint pair;
+	    pair.body = body;
+	    pair.inner = *itInner;
+	    pair.outer = *itOuter;
+	    movingPairs_.push_back (pair);
+	  }
+	}
+      }
+    }
+
+    bool DiscretizedCollisionChecking::hintCollides ()
+    {
+      std::vector <CollisionHint>::iterator it = hints_.begin ();
+      while (it != hints_.end ()) {
+	if (!collide (it->inner, it->outer)) {
+	  ++it;
+	  continue;
+	}
+	// The obstacle may have been removed from the robot since the pair
+	// was found in collision.
+	const ObjectVector_t& outer (it->body->outerObjects (model::COLLISION));
+	if (std::find (outer.begin (), outer.end (), it->outer) ==
+	    outer.end ()) {
+	  it = hints_.erase (it);
+	  continue;
+	}
+	std::rotate (hints_.begin (), it, it + 1);
+	return true;
+      }
+      return false;
+    }
+
+    bool DiscretizedCollisionChecking::findCollision (CollisionHint& pair)
+    {
+      // Same loops as Device::collisionTest
+      const JointVector_t& joints (robot_->getJointVector ());
+      for (JointVector_t::const_iterator itJoint = joints.begin ();
+	   itJoint != joints.end (); ++itJoint) {
+	model::BodyPtr_t body = (*itJoint)->linkedBody ();
+	if (!body) continue;
+	const ObjectVector_t& inner
+	  (body->innerObjects (model::COLLISION));
+	const ObjectVector_t& outer
+	  (body->outerObjects (model::COLLISION));
+	for (ObjectVector_t::const_iterator itInner = inner.begin ();
+	     itInner != inner.end (); ++itInner) {
+	  for (ObjectVector_t::const_iterator itOuter = outer.begin ();
+	       itOuter != outer.end (); ++itOuter) {
+	    if (collide (*itInner, *itOuter)) {
+	      pair.body = body;
+	      pair.inner = *itInner;
+	      pair.outer = *itOuter;
+	      return true;
+	    }
+	  }
+	}
+      }
+      return false;
+    }
+
+    void DiscretizedCollisionChecking::remember (const CollisionHint& hint)
+    {
+      if (hints_.size () == hintCapacity_) hints_.pop_back ();
+      hints_.insert (hints_.begin (), hint);
+    }
+
+    void DiscretizedCollisionChecking::validityCache (std::size_t capacity)
+    {
+      cacheCapacity_ = capacity;
+      while (cache_.size () > capacity) {
+	cache_.erase (cacheOrder_.front ());
+	cacheOrder_.pop_front ();
+      }
+    }
+
+    void DiscretizedCollisionChecking::obstaclesChanged ()
+    {
+      cache_.clear ();
+      cacheOrder_.clear ();
+    }
+
+    PathValidationPtr_t DiscretizedCollisionChecking::clone
+    (const DevicePtr_t& robot) const
+    {
+      DiscretizedCollisionCheckingPtr_t validation =
+	create (robot, stepSize_);
+      validation->projectionThreads (projectionThreads_);
+      validation->collisionHints (hintCapacity_);
+      validation->incrementalKinematics (incremental_);
+      validation->validityCache (cacheCapacity_);
+      return validation;
     }
 
     DiscretizedCollisionChecking::DiscretizedCollisionChecking
     (const DevicePtr_t& robot, const value_type& stepSize) :
-      PathValidation (), robot_ (robot), stepSize_ (stepSize)
+      PathValidation (), robot_ (robot), stepSize_ (stepSize),
+      projectionThreads_ (1), times_ (), q_ (robot->configSize ()),
+      batchTimes_ (), configurations_ (), hints_ (), hintCapacity_ (0),
+      numberHintTests_ (0), numberHintHits_ (0), incremental_ (false),
+      numberIncrementalSamples_ (0), parents_ (), joints_ (),
+      hasReference_ (false), qValid_ (robot->configSize ()), moved_ (),
+      movingJoints_ (), movingPairs_ (), cache_ (), cacheOrder_ (),
+      cacheCapacity_ (1000), numberCacheHits_ (0), key_ ()
     {
     }
 
+    const std::size_t DiscretizedCollisionChecking::npos =
+      std::numeric_limits <std::size_t>::max ();
+
   } // namespace core
 } // namespace hpp
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_FIXED_SIZE_KERNELS_HH
+# define HPP_CORE_FIXED_SIZE_KERNELS_HH
+
+# include <hpp/core/fwd.hh>
+
+namespace hpp {
+  namespace core {
+    /// Kernels on vectors of the size of the configuration
+    ///
+    /// Each kernel is instantiated for the configuration sizes of the robots
+    /// used most and for dynamic sizes. Classes compute the FixedSize_t of
+    /// the robot at construction and call the dispatch functions below:
+    /// the fixed size instances use maps on fixed size Eigen vectors, the
+    /// loops of which are unrolled and vectorized. To register another
+    /// size, add a value to FixedSize_t and a case to each function.
+    enum FixedSize_t {
+      DYNAMIC_SIZE,
+      SIZE_6,
+      SIZE_7,
+      SIZE_12
+    };
+
+    /// Fixed size matching a configuration size
+    inline FixedSize_t fixedSize (size_type size)
+    {
+      switch (size) {
+      case 6: return SIZE_6;
+      case 7: return SIZE_7;
+      case 12: return SIZE_12;
+      default: return DYNAMIC_SIZE;
+      }
+    }
+
+    template <int N> struct Kernels
+    {
+      typedef Eigen::Matrix <value_type, N, 1> Vector_t;
+      typedef Eigen::Map <const Vector_t> ConstMap_t;
+
+      /// Sum of squared differences of q1 and q2 weighed by squaredWeights
+      static value_type weighedSquaredNorm (size_type n,
+					    const value_type* squaredWeights,
+					    const value_type* q1,
+					    const value_type* q2)
+      {
+	ConstMap_t w (squaredWeights, n), a (q1, n), b (q2, n);
+	return (w.array () * (a - b).array ().square ()).sum ();
+      }
+
+      /// weighedSquaredNorm between q and each column of a block
+      static void weighedSquaredNorms (size_type n,
+				       const value_type* squaredWeights,
+				       const value_type* q,
+				       matrixIn_t configurations,
+				       vectorOut_t result)
+      {
+	const value_type* column = configurations.data ();
+	for (size_type j=0; j < configurations.cols (); ++j) {
+	  result [j] = weighedSquaredNorm (n, squaredWeights, q, column);
+	  column += configurations.outerStride ();
+	}
+      }
+    }; // struct Kernels
+
+    /// Sum of squared differences of q1 and q2 weighed by squaredWeights
+    inline value_type weighedSquaredNorm (FixedSize_t size,
+					  vectorIn_t squaredWeights,
+					  ConfigurationIn_t q1,
+					  ConfigurationIn_t q2)
+    {
+      const size_type n = q1.size ();
+      const value_type* w = squaredWeights.data ();
+      switch (size) {
+      case SIZE_6:
+	return Kernels <6>::weighedSquaredNorm (n, w, q1.data (), q2.data ());
+      case SIZE_7:
+	return Kernels <7>::weighedSquaredNorm (n, w, q1.data (), q2.data ());
+      case SIZE_12:
+	return Kernels <12>::weighedSquaredNorm (n, w, q1.data (), q2.data ());
+      default:
+	return Kernels <Eigen::Dynamic>::weighedSquaredNorm
+	  (n, w, q1.data (), q2.data ());
+      }
+    }
+
+    /// weighedSquaredNorm between q and each column of configurations
+    ///
+    /// The size is dispatched once for the whole block and each column
+    /// gives the same value as weighedSquaredNorm.
+    inline void weighedSquaredNorms (FixedSize_t size,
+				     vectorIn_t squaredWeights,
+				     ConfigurationIn_t q,
+				     matrixIn_t configurations,
+				     vectorOut_t result)
+    {
+      const size_type n = q.size ();
+      const value_type* w = squaredWeights.data ();
+      switch (size) {
+      case SIZE_6:
+	Kernels <6>::weighedSquaredNorms (n, w, q.data (), configurations,
+					  result);
+	break;
+      case SIZE_7:
+	Kernels <7>::weighedSquaredNorms (n, w, q.data (), configurations,
+					  result);
+	break;
+      case SIZE_12:
+	Kernels <12>::weighedSquaredNorms (n, w, q.data (), configurations,
+					   result);
+	break;
+      default:
+	Kernels <Eigen::Dynamic>::weighedSquaredNorms
+	  (n, w, q.data (), configurations, result);
+      }
+    }
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_FIXED_SIZE_KERNELS_HH
@@ -0,0 +1,516 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <limits>
+#include <algorithm>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/flat-k-d-tree.hh>
+#include <hpp/core/node.hh>
+
+namespace hpp {
+  namespace core {
+    const std::size_t FlatKDTree::npos =
+      std::numeric_limits <std::size_t>::max ();
+
+    FlatKDTreePtr_t FlatKDTree::create (const DevicePtr_t& robot,
+					const DistancePtr_t& distance,
+					size_type bucketSize)
+    {
+      FlatKDTree* ptr = new FlatKDTree (robot, distance, bucketSize);
+      return FlatKDTreePtr_t (ptr);
+    }
+
+    FlatKDTree::FlatKDTree (const DevicePtr_t& robot,
+			    const DistancePtr_t& distance,
+			    size_type bucketSize) :
+      robot_ (robot), distance_ (distance), bucketSize_ (bucketSize),
+      dim_ (robot->configSize ()), lowerBounds_ (dim_), upperBounds_ (dim_),
+      typeDims_ (dim_), cells_ (), leaves_ (), cellLower_ (dim_),
+      cellUpper_ (dim_), offsets_ (dim_), qBox_ (dim_)
+    {
+      // Same bounds as KDTree::findDeviceBounds
+      const JointVector_t& jv = robot_->getJointVector ();
+      size_type i=0;
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); itJoint++) {
+	for (size_type rank=0; rank < (*itJoint)->configSize (); ++rank) {
+	  if ((*itJoint)->configSize () == 4) {
+	    // SO3 joint
+	    upperBounds_ [i] = 1.;
+	    lowerBounds_ [i] = -1.;
+	    typeDims_ [i] = 2;
+	  } else if ((*itJoint)->isBounded (rank)) {
+	    upperBounds_ [i] = (*itJoint)->upperBound (rank);
+	    lowerBounds_ [i] = (*itJoint)->lowerBound (rank);
+	    typeDims_ [i] = 0;
+	  } else {
+	    // if unbounded => rotation
+	    upperBounds_ [i] = M_PI;
+	    lowerBounds_ [i] = -M_PI;
+	    typeDims_ [i] = 1;
+	  }
+	  ++i;
+	}
+      }
+      clear ();
+    }
+
+    void FlatKDTree::clear ()
+    {
+      cells_.clear ();
+      leaves_.clear ();
+      newLeafCell ();
+    }
+
+    std::size_t FlatKDTree::newLeafCell ()
+    {
+      Cell cell;
+      cell.splitDim = 0;
+      cell.splitValue = 0;
+      cell.infChild = npos;
+      cell.supChild = npos;
+      cell.leaf = leaves_.size ();
+      leaves_.push_back (Leaf ());
+      leaves_.back ().configurations.resize (dim_, bucketSize_);
+      leaves_.back ().nodes.reserve (bucketSize_);
+      leaves_.back ().components.reserve (bucketSize_);
+      cells_.push_back (cell);
+      return cells_.size () - 1;
+    }
+
+    void FlatKDTree::pushBack (Leaf& leaf, ConfigurationIn_t q,
+			       const NodePtr_t& node, ConnectedComponent* cc)
+    {
+      size_type n = leaf.nodes.size ();
+      if (n >= leaf.configurations.cols ()) {
+	leaf.configurations.conservativeResize (dim_, 2*n);
+      }
+      leaf.configurations.col (n) = q;
+      leaf.nodes.push_back (node);
+      leaf.components.push_back (cc);
+    }
+
+    void FlatKDTree::leafDistances (const Leaf& leaf, ConfigurationIn_t q)
+    {
+      size_type n = leaf.nodes.size ();
+      numberDistances_ += n;
+      leafDistances_.resize (n);
+      distance_->distances (q, leaf.configurations.leftCols (n),
+			    leafDistances_);
+    }
+
+    void FlatKDTree::addNode (const NodePtr_t& node)
+    {
+      ConfigurationIn_t q (*(node->configuration ()));
+      ConnectedComponent* cc = node->connectedComponent ().get ();
+      cellLower_ = lowerBounds_;
+      cellUpper_ = upperBounds_;
+      std::size_t current = 0;
+      while (true) {
+	insertComponent (cells_ [current].components, cc);
+	const Cell& cell = cells_ [current];
+	if (cell.leaf == npos) {
+	  if (q [cell.splitDim] > cell.splitValue) {
+	    cellLower_ [cell.splitDim] = cell.splitValue;
+	    current = cell.supChild;
+	  } else {
+	    cellUpper_ [cell.splitDim] = cell.splitValue;
+	    current = cell.infChild;
+	  }
+	} else {
+	  Leaf& leaf = leaves_ [cell.leaf];
+	  if ((size_type) leaf.nodes.size () < bucketSize_ ||
+	      !split (current, cellLower_, cellUpper_)) {
+	    pushBack (leaves_ [cells_ [current].leaf], q, node, cc);
+	    return;
+	  }
+	  // The cell is now an inner cell, keep going down the tree.
+	}
+      }
+    }
+
+    bool FlatKDTree::split (std::size_t current, vectorIn_t lower,
+			    vectorIn_t upper)
+    {
+      // Split the widest dimension. Quaternion coordinates do not help
+      // pruning and are never split.
+      size_type splitDim = 0;
+      value_type width = 0;
+      for (size_type i=0; i < dim_; ++i) {
+	if (typeDims_ [i] != 2 && upper [i] - lower [i] > width) {
+	  width = upper [i] - lower [i];
+	  splitDim = i;
+	}
+      }
+      if (width <= 0) return false;
+      value_type splitValue = .5 * (lower [splitDim] + upper [splitDim]);
+
+      // Create children. Inferior child reuses the leaf of the split cell.
+      std::size_t leafIndex = cells_ [current].leaf;
+      std::size_t supChild = newLeafCell ();
+      std::size_t supLeaf = cells_ [supChild].leaf;
+      Cell inf;
+      inf.splitDim = 0;
+      inf.splitValue = 0;
+      inf.infChild = npos;
+      inf.supChild = npos;
+      inf.leaf = leafIndex;
+      cells_.push_back (inf);
+      std::size_t infChild = cells_.size () - 1;
+
+      Leaf old;
+      std::swap (old, leaves_ [leafIndex]);
+      Leaf& infLeaf = leaves_ [leafIndex];
+      infLeaf.configurations.resize (dim_, bucketSize_);
+      infLeaf.nodes.reserve (bucketSize_);
+      infLeaf.components.reserve (bucketSize_);
+      for (std::size_t j=0; j < old.nodes.size (); ++j) {
+	std::size_t child;
+	if (old.configurations (splitDim, j) > splitValue) {
+	  child = supChild;
+	  pushBack (leaves_ [supLeaf], old.configurations.col (j),
+		    old.nodes [j], old.components [j]);
+	} else {
+	  child = infChild;
+	  pushBack (infLeaf, old.configurations.col (j), old.nodes [j],
+		    old.components [j]);
+	}
+	insertComponent (cells_ [child].components, old.components [j]);
+      }
+      Cell& cell = cells_ [current];
+      cell.splitDim = splitDim;
+      cell.splitValue = splitValue;
+      cell.infChild = infChild;
+      cell.supChild = supChild;
+      cell.leaf = npos;
+      return true;
+    }
+
+    value_type FlatKDTree::planeDistance (ConfigurationIn_t q, size_type dim,
+					  value_type value)
+    {
+      if (typeDims_ [dim] == 2) return 0;
+      qBox_ [dim] = value;
+      value_type res = (*distance_) (q, qBox_);
+      if (typeDims_ [dim] == 1) {
+	// The far side of a looped dimension is an arc ending at the plane
+	// and at most at the bound opposite to the configuration, around
+	// which the distance wraps.
+	qBox_ [dim] = q [dim] > value ? lowerBounds_ [dim] : upperBounds_ [dim];
+	res = std::min (res, (*distance_) (q, qBox_));
+      }
+      qBox_ [dim] = q [dim];
+      return res;
+    }
+
+    void FlatKDTree::initSearch (ConfigurationIn_t q)
+    {
+      // Test if the configuration is in the root box
+      for (size_type i=0; i < dim_; ++i) {
+	if (q [i] < lowerBounds_ [i] || q [i] > upperBounds_ [i]) {
+	  throw std::runtime_error ("The Configuration isn't in the root box");
+	}
+      }
+      offsets_.setZero ();
+      qBox_ = q;
+    }
+
+    NodePtr_t FlatKDTree::search (const ConfigurationPtr_t& configuration,
+				  const ConnectedComponentPtr_t&
+				  connectedComponent,
+				  value_type& minDistance)
+    {
+      const Configuration_t& q (*configuration);
+      initSearch (q);
+      startSearch (true);
+      NodePtr_t nearest = 0x0;
+      minDistance = std::numeric_limits <value_type>::infinity ();
+      search (0, 0., q, connectedComponent.get (), minDistance, nearest);
+      return nearest;
+    }
+
+    void FlatKDTree::search (std::size_t current, value_type boxDistance,
+			     ConfigurationIn_t q, ConnectedComponent* cc,
+			     value_type& minDistance, NodePtr_t& nearest)
+    {
+      const Cell& cell = cells_ [current];
+      ++numberVisits_;
+      if (cc ? !hasComponent (cell.components, cc) : cell.components.empty ())
+	return;
+      if (leafBudget_ == 0) return;
+      if (cell.leaf != npos) {
+	--leafBudget_;
+	const Leaf& leaf = leaves_ [cell.leaf];
+	leafDistances (leaf, q);
+	for (std::size_t j=0; j < leaf.nodes.size (); ++j) {
+	  if (cc && leaf.components [j] != cc) continue;
+	  if (leafDistances_ [j] < minDistance) {
+	    minDistance = leafDistances_ [j];
+	    nearest = leaf.nodes [j];
+	  }
+	}
+	return;
+      }
+      std::size_t nearChild, farChild;
+      if (q [cell.splitDim] > cell.splitValue) {
+	nearChild = cell.supChild; farChild = cell.infChild;
+      } else {
+	nearChild = cell.infChild; farChild = cell.supChild;
+      }
+      search (nearChild, boxDistance, q, cc, minDistance, nearest);
+      // boxDistance is a squared distance
+      value_type offset = planeDistance (q, cell.splitDim, cell.splitValue);
+      value_type oldOffset = offsets_ [cell.splitDim];
+      value_type farDistance = boxDistance - oldOffset*oldOffset +
+	offset*offset;
+      if (farDistance * pruneFactor_ < minDistance*minDistance) {
+	offsets_ [cell.splitDim] = offset;
+	search (farChild, farDistance, q, cc, minDistance, nearest);
+	offsets_ [cell.splitDim] = oldOffset;
+      }
+    }
+
+    void FlatKDTree::search (const ConfigurationPtr_t& configuration,
+			     const ConnectedComponents_t& connectedComponents,
+			     NearestNodes_t& nearest)
+    {
+      const Configuration_t& q (*configuration);
+      initSearch (q);
+      startSearch (true);
+      requested_.clear ();
+      for (ConnectedComponents_t::const_iterator itcc =
+	     connectedComponents.begin ();
+	   itcc != connectedComponents.end (); ++itcc) {
+	insertComponent (requested_, itcc->get ());
+      }
+      requestedNodes_.assign (requested_.size (), 0x0);
+      requestedDistances_.assign (requested_.size (),
+				  std::numeric_limits <value_type>::infinity ());
+      search (0, 0., q);
+      nearest.clear ();
+      for (ConnectedComponents_t::const_iterator itcc =
+	     connectedComponents.begin ();
+	   itcc != connectedComponents.end (); ++itcc) {
+	std::size_t index = requestedIndex (itcc->get ());
+	nearest [*itcc] = std::make_pair (requestedNodes_ [index],
+					  requestedDistances_ [index]);
+      }
+    }
+
+    std::size_t FlatKDTree::requestedIndex (ConnectedComponent* cc) const
+    {
+      Components_t::const_iterator it =
+	std::lower_bound (requested_.begin (), requested_.end (), cc);
+      if (it == requested_.end () || *it != cc) return npos;
+      return it - requested_.begin ();
+    }
+
+    void FlatKDTree::search (std::size_t current, value_type boxDistance,
+			     ConfigurationIn_t q)
+    {
+      const Cell& cell = cells_ [current];
+      ++numberVisits_;
+      // Explore the cell only if it may improve the nearest node of one of
+      // the requested connected components it contains.
+      value_type maxDistance = 0;
+      for (Components_t::const_iterator itcc = cell.components.begin ();
+	   itcc != cell.components.end (); ++itcc) {
+	std::size_t index = requestedIndex (*itcc);
+	if (index != npos && requestedDistances_ [index] > maxDistance) {
+	  maxDistance = requestedDistances_ [index];
+	}
+      }
+      // boxDistance is a squared distance
+      if (boxDistance * pruneFactor_ >= maxDistance*maxDistance ||
+	  leafBudget_ == 0) return;
+      if (cell.leaf != npos) {
+	--leafBudget_;
+	const Leaf& leaf = leaves_ [cell.leaf];
+	leafDistances (leaf, q);
+	for (std::size_t j=0; j < leaf.nodes.size (); ++j) {
+	  std::size_t index = requestedIndex (leaf.components [j]);
+	  if (index == npos) continue;
+	  if (leafDistances_ [j] < requestedDistances_ [index]) {
+	    requestedDistances_ [index] = leafDistances_ [j];
+	    requestedNodes_ [index] = leaf.nodes [j];
+	  }
+	}
+	return;
+      }
+      std::size_t nearChild, farChild;
+      if (q [cell.splitDim] > cell.splitValue) {
+	nearChild = cell.supChild; farChild = cell.infChild;
+      } else {
+	nearChild = cell.infChild; farChild = cell.supChild;
+      }
+      search (nearChild, boxDistance, q);
+      value_type offset = planeDistance (q, cell.splitDim, cell.splitValue);
+      value_type oldOffset = offsets_ [cell.splitDim];
+      offsets_ [cell.splitDim] = offset;
+      search (farChild, boxDistance - oldOffset*oldOffset + offset*offset, q);
+      offsets_ [cell.splitDim] = oldOffset;
+    }
+
+    void FlatKDTree::kNearest (const ConfigurationPtr_t& configuration,
+			       const ConnectedComponentPtr_t&
+			       connectedComponent,
+			       std::size_t k, Nodes_t& nodes)
+    {
+      nodes.clear ();
+      if (k == 0) return;
+      const Configuration_t& q (*configuration);
+      initSearch (q);
+      startSearch (true);
+      NodeQueue_t queue;
+      kNearest (0, 0., q, connectedComponent.get (), k, queue);
+      sort (queue, nodes);
+    }
+
+    void FlatKDTree::kNearest (std::size_t current, value_type boxDistance,
+			       ConfigurationIn_t q, ConnectedComponent* cc,
+			       std::size_t k, NodeQueue_t& queue)
+    {
+      const Cell& cell = cells_ [current];
+      ++numberVisits_;
+      if (cc ? !hasComponent (cell.components, cc) : cell.components.empty ())
+	return;
+      if (leafBudget_ == 0) return;
+      if (cell.leaf != npos) {
+	--leafBudget_;
+	const Leaf& leaf = leaves_ [cell.leaf];
+	leafDistances (leaf, q);
+	for (std::size_t j=0; j < leaf.nodes.size (); ++j) {
+	  if (cc && leaf.components [j] != cc) continue;
+	  push (queue, k, leafDistances_ [j], leaf.nodes [j]);
+	}
+	return;
+      }
+      std::size_t nearChild, farChild;
+      if (q [cell.splitDim] > cell.splitValue) {
+	nearChild = cell.supChild; farChild = cell.infChild;
+      } else {
+	nearChild = cell.infChild; farChild = cell.supChild;
+      }
+      kNearest (nearChild, boxDistance, q, cc, k, queue);
+      value_type offset = planeDistance (q, cell.splitDim, cell.splitValue);
+      value_type oldOffset = offsets_ [cell.splitDim];
+      value_type farDistance = boxDistance - oldOffset*oldOffset +
+	offset*offset;
+      value_type maxDistance = bound (queue, k);
+      // boxDistance is a squared distance
+      if (farDistance * pruneFactor_ < maxDistance*maxDistance) {
+	offsets_ [cell.splitDim] = offset;
+	kNearest (farChild, farDistance, q, cc, k, queue);
+	offsets_ [cell.splitDim] = oldOffset;
+      }
+    }
+
+    void FlatKDTree::withinRadius (const ConfigurationPtr_t& configuration,
+				   const ConnectedComponentPtr_t&
+				   connectedComponent,
+				   value_type radius, Nodes_t& nodes)
+    {
+      nodes.clear ();
+      const Configuration_t& q (*configuration);
+      initSearch (q);
+      withinRadius (0, 0., q, connectedComponent.get (), radius, nodes);
+    }
+
+    void FlatKDTree::withinRadius (std::size_t current, value_type boxDistance,
+				   ConfigurationIn_t q, ConnectedComponent* cc,
+				   value_type radius, Nodes_t& nodes)
+    {
+      const Cell& cell = cells_ [current];
+      ++numberVisits_;
+      if (!hasComponent (cell.components, cc)) return;
+      if (cell.leaf != npos) {
+	const Leaf& leaf = leaves_ [cell.leaf];
+	leafDistances (leaf, q);
+	for (std::size_t j=0; j < leaf.nodes.size (); ++j) {
+	  if (leaf.components [j] != cc) continue;
+	  if (leafDistances_ [j] <= radius) {
+	    nodes.push_back (leaf.nodes [j]);
+	  }
+	}
+	return;
+      }
+      std::size_t nearChild, farChild;
+      if (q [cell.splitDim] > cell.splitValue) {
+	nearChild = cell.supChild; farChild = cell.infChild;
+      } else {
+	nearChild = cell.infChild; farChild = cell.supChild;
+      }
+      withinRadius (nearChild, boxDistance, q, cc, radius, nodes);
+      value_type offset = planeDistance (q, cell.splitDim, cell.splitValue);
+      value_type oldOffset = offsets_ [cell.splitDim];
+      value_type farDistance = boxDistance - oldOffset*oldOffset +
+	offset*offset;
+      // boxDistance is a squared distance
+      if (farDistance <= radius*radius) {
+	offsets_ [cell.splitDim] = offset;
+	withinRadius (farChild, farDistance, q, cc, radius, nodes);
+	offsets_ [cell.splitDim] = oldOffset;
+      }
+    }
+
+    NodePtr_t FlatKDTree::nearestWithinRadius
+    (const ConfigurationPtr_t& configuration,
+     const ConnectedComponentPtr_t& connectedComponent, value_type radius,
+     value_type& minDistance)
+    {
+      const Configuration_t& q (*configuration);
+      initSearch (q);
+      startSearch (false);
+      NodePtr_t nearest = 0x0;
+      minDistance = radius;
+      search (0, 0., q, connectedComponent.get (), minDistance, nearest);
+      return nearest;
+    }
+
+    void FlatKDTree::merge (ConnectedComponentPtr_t cc1,
+			    ConnectedComponentPtr_t cc2)
+    {
+      merge (0, cc1.get (), cc2.get ());
+    }
+
+    void FlatKDTree::merge (std::size_t current, ConnectedComponent* cc1,
+			    ConnectedComponent* cc2)
+    {
+      Components_t& components = cells_ [current].components;
+      Components_t::iterator it =
+	std::lower_bound (components.begin (), components.end (), cc2);
+      if (it == components.end () || *it != cc2) return;
+      components.erase (it);
+      insertComponent (components, cc1);
+      const Cell& cell = cells_ [current];
+      if (cell.leaf != npos) {
+	Leaf& leaf = leaves_ [cell.leaf];
+	std::replace (leaf.components.begin (), leaf.components.end (),
+		      cc2, cc1);
+      } else {
+	merge (cell.infChild, cc1, cc2);
+	merge (cell.supChild, cc1, cc2);
+      }
+    }
+  } //   namespace core
+} // namespace hpp
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/gaussian-configuration-shooter.hh>
+#include "basic-configuration-shooter.hh"
+
+namespace hpp {
+  namespace core {
+    GaussianConfigurationShooterPtr_t GaussianConfigurationShooter::create
+    (const DevicePtr_t& robot, const DistancePtr_t& distance,
+     value_type standardDeviation, const RandomGeneratorPtr_t& generator)
+    {
+      GaussianConfigurationShooter* ptr = new GaussianConfigurationShooter
+	(robot, distance, standardDeviation, generator);
+      return GaussianConfigurationShooterPtr_t (ptr);
+    }
+
+    GaussianConfigurationShooter::GaussianConfigurationShooter
+    (const DevicePtr_t& robot, const DistancePtr_t& distance,
+     value_type standardDeviation, const RandomGeneratorPtr_t& generator) :
+      robot_ (robot), distance_ (distance),
+      standardDeviation_ (standardDeviation), generator_ (generator),
+      uniform_ (new BasicConfigurationShooter (robot_, generator)),
+      bridgeTest_ (false), maxTrials_ (100),
+      q1_ (robot->configSize ()), q2_ (robot->configSize ())
+    {
+    }
+
+    ConfigurationPtr_t GaussianConfigurationShooter::shoot () const
+    {
+      ConfigurationPtr_t config (new Configuration_t (robot_->configSize ()));
+      shoot (*config);
+      return config;
+    }
+
+    void GaussianConfigurationShooter::shoot (ConfigurationOut_t config) const
+    {
+      for (std::size_t trial = 0; trial < maxTrials_; ++trial) {
+	uniform_->shoot (q1_);
+	uniform_->shoot (q2_);
+	// Second configuration of the pair, in the direction of q2_ at a
+	// normally distributed distance
+	value_type d = (*distance_) (q1_, q2_);
+	if (d <= 0) continue;
+	value_type step = fabs (standardDeviation_ * generator_->normal ());
+	interpolate (q1_, q2_, std::min (step / d, 1.), config);
+	bool collision1 = collides (q1_);
+	bool collision2 = collides (config);
+	if (bridgeTest_) {
+	  if (collision1 && collision2) {
+	    interpolate (q1_, config, .5, q2_);
+	    if (!collides (q2_)) {
+	      config = q2_;
+	      return;
+	    }
+	  }
+	} else if (collision1 != collision2) {
+	  if (!collision1) config = q1_;
+	  return;
+	}
+      }
+      hppDout (info, "no configuration close to obstacles after "
+	       << maxTrials_ << " trials");
+      uniform_->shoot (config);
+    }
+
+    bool GaussianConfigurationShooter::collides (ConfigurationIn_t q) const
+    {
+      robot_->currentConfiguration (q);
+      robot_->computeForwardKinematics ();
+      return robot_->collisionTest ();
+    }
+
+    void GaussianConfigurationShooter::interpolate
+    (ConfigurationIn_t q1, ConfigurationIn_t q2, value_type u,
+     ConfigurationOut_t result) const
+    {
+      const JointVector_t& jv = robot_->getJointVector ();
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); itJoint++) {
+	(*itJoint)->configuration ()->interpolate
+	  (q1, q2, u, (*itJoint)->rankInConfiguration (), result);
+      }
+    }
+  } //   namespace core
+} // namespace hpp
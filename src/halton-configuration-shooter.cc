@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <hpp/model/device.hh>
+#include <hpp/core/halton-configuration-shooter.hh>
+#include "basic-configuration-shooter.hh"
+
+namespace hpp {
+  namespace core {
+    namespace {
+      /// Whether a joint is sampled by the Halton sequence
+      bool isSampled (const JointPtr_t& joint)
+      {
+	if (dynamic_cast <model::JointSO3*> (joint)) return true;
+	value_type lower, upper;
+	for (size_type i=0; i < joint->configSize (); ++i) {
+	  if (!BasicConfigurationShooter::bounds (joint, i, lower, upper)) {
+	    return false;
+	  }
+	}
+	return joint->configSize () > 0;
+      }
+
+      /// Number of coordinates of the Halton sequence used by a joint
+      std::size_t sampledSize (const JointPtr_t& joint)
+      {
+	if (!isSampled (joint)) return 0;
+	if (dynamic_cast <model::JointSO3*> (joint)) return 3;
+	return joint->configSize ();
+      }
+    } // namespace
+
+    HaltonConfigurationShooterPtr_t HaltonConfigurationShooter::create
+    (const DevicePtr_t& robot)
+    {
+      HaltonConfigurationShooter* ptr = new HaltonConfigurationShooter (robot);
+      return HaltonConfigurationShooterPtr_t (ptr);
+    }
+
+    HaltonConfigurationShooter::HaltonConfigurationShooter
+    (const DevicePtr_t& robot) : robot_ (robot), bases_ (), index_ (1)
+    {
+      std::size_t dimension = 0;
+      const JointVector_t& jv = robot_->getJointVector ();
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); itJoint++) {
+	dimension += sampledSize (*itJoint);
+      }
+      // First primes by trial division
+      for (std::size_t n = 2; bases_.size () < dimension; ++n) {
+	bool prime = true;
+	for (std::size_t i=0; i < bases_.size () &&
+	       bases_ [i] * bases_ [i] <= n; ++i) {
+	  if (n % bases_ [i] == 0) {
+	    prime = false; break;
+	  }
+	}
+	if (prime) bases_.push_back (n);
+      }
+    }
+
+    value_type HaltonConfigurationShooter::radicalInverse (std::size_t index,
+							   std::size_t base)
+    {
+      value_type res = 0;
+      value_type factor = 1./base;
+      while (index > 0) {
+	res += factor * (index % base);
+	index /= base;
+	factor /= base;
+      }
+      return res;
+    }
+
+    ConfigurationPtr_t HaltonConfigurationShooter::shoot () const
+    {
+      ConfigurationPtr_t config (new Configuration_t (robot_->configSize ()));
+      shoot (*config);
+      return config;
+    }
+
+    void HaltonConfigurationShooter::shoot (ConfigurationOut_t config) const
+    {
+      std::size_t coordinate = 0;
+      const JointVector_t& jv = robot_->getJointVector ();
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); itJoint++) {
+	size_type rank = (*itJoint)->rankInConfiguration ();
+	if (!isSampled (*itJoint)) {
+	  (*itJoint)->configuration ()->uniformlySample (rank, config);
+	} else if (dynamic_cast <model::JointSO3*> (*itJoint)) {
+	  value_type u1 = radicalInverse (index_, bases_ [coordinate]);
+	  value_type u2 = radicalInverse (index_, bases_ [coordinate + 1]);
+	  value_type u3 = radicalInverse (index_, bases_ [coordinate + 2]);
+	  BasicConfigurationShooter::unitQuaternion (u1, u2, u3,
+						     config.segment (rank, 4));
+	  coordinate += 3;
+	} else {
+	  value_type lower = 0, upper = 0;
+	  for (size_type i=0; i < (*itJoint)->configSize (); ++i) {
+	    BasicConfigurationShooter::bounds (*itJoint, i, lower, upper);
+	    config [rank + i] = lower + (upper - lower) *
+	      radicalInverse (index_, bases_ [coordinate]);
+	    ++coordinate;
+	  }
+	}
+      }
+      ++index_;
+    }
+  } //   namespace core
+} // namespace hpp
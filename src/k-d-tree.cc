@@ -24,6 +24,8 @@
 # include <hpp/model/joint-configuration.hh>
 # include <hpp/model/device.hh>
 # include <hpp/core/weighed-distance.hh>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 
@@ -32,53 +34,30 @@ using namespace std;
 namespace hpp {
   namespace core {
 
-    // Constructor with the mother tree node (same bounds)
+    // Constructor with the mother tree node (same bounds), the split
+    // dimension is set by the mother
     KDTree::KDTree (const KDTreePtr_t mother) : 
       robot_(mother->robot_),
       dim_(mother->dim_),
       distance_(mother->distance_),
       nodesMap_(),
+      components_(),
       bucketSize_(mother->bucketSize_),
       bucket_(0),
       splitDim_(),
       upperBounds_(mother->upperBounds_),
       lowerBounds_(mother->lowerBounds_),
-      typeDims_(mother->typeDims_),
+      typeDims_(),
       supChild_(),
-      infChild_()
+      infChild_(),
+      root_(mother->root_),
+      depth_(mother->depth_ + 1),
+      size_(0),
+      jointRanks_(),
+      firstDims_(),
+      numberRebuilds_(0),
+      qBox_()
        {
-
-      // Incremental split dimention
-      //if ( mother->splitDim_ < dim_ ) {
-      //	splitDim_ = mother->splitDim_ + 1;
-      //}
-      //else {
-      //	splitDim_ = 0;
-      //}
-
-      // Split the widhtest dimention
-      try {
-	WeighedDistance& weighedDistance =
-          dynamic_cast<WeighedDistance&>( (*distance_) );
-	double dimWidth = 0.;
-	for (int i=0 ; i < dim_ ; i++ ) {
-	  if ( (upperBounds_[i] - lowerBounds_[i])
-               *weighedDistance.getWeight(i) > dimWidth ) {
-	    dimWidth =  upperBounds_[i] - lowerBounds_[i];
-	    splitDim_ = i;
-	  }
-	}
-      }
-      catch (std::bad_cast& bc) {
-	double dimWidth = 0.;
-	for (int i=0 ; i < dim_ ; i++ ) {
-	  if ( (upperBounds_[i] - lowerBounds_[i]) > dimWidth ) {
-	    dimWidth =  upperBounds_[i] - lowerBounds_[i];
-	    splitDim_ = i;
-	  }
-	}
-      }
-
       supChild_ = NULL;
       infChild_ = NULL;
     }
@@ -89,6 +68,7 @@ namespace hpp {
       dim_(),
       distance_(distance),
       nodesMap_(),
+      components_(),
       bucketSize_(bucketSize),
       bucket_(0),
       splitDim_(),
@@ -96,10 +76,18 @@ namespace hpp {
       lowerBounds_(), 
       typeDims_(),
       supChild_(),
-      infChild_()
+      infChild_(),
+      root_(this),
+      depth_(0),
+      size_(0),
+      jointRanks_(),
+      firstDims_(),
+      numberRebuilds_(0),
+      qBox_()
        {
       this->findDeviceBounds();
       dim_ = lowerBounds_.size();
+      qBox_.resize(dim_);
       splitDim_ = 0;
       supChild_ = NULL;
       infChild_ = NULL;
@@ -110,83 +98,227 @@ namespace hpp {
       if (supChild_ != NULL ) { delete supChild_; }
     }
 
-    // find the leaf node in the tree for the configuration of the node
-    KDTreePtr_t KDTree::findLeaf (const NodePtr_t& node) {
-      KDTreePtr_t CurrentTree = this;
-      CurrentTree->nodesMap_[node->connectedComponent()];
-      while ( CurrentTree->supChild_ != NULL && CurrentTree->infChild_ != NULL) 
-	{
-	  if ( (*(node->configuration()))[CurrentTree->supChild_->splitDim_]
-	       > CurrentTree->supChild_->lowerBounds_[CurrentTree->supChild_
-						      ->splitDim_] )  {
-	    CurrentTree = CurrentTree->supChild_;
-	    CurrentTree->nodesMap_[node->connectedComponent()];
-	  }
-	  else {
-	    CurrentTree = CurrentTree->infChild_;
-	    CurrentTree->nodesMap_[node->connectedComponent()];
-	  }
-	}
-      return CurrentTree;
+    void KDTree::addNode (const NodePtr_t& node) {
+      std::vector <KDTreePtr_t> path;
+      this->insert(node, path);
+      this->rebalance(path);
     }
 
+    void KDTree::addNodes (const Nodes_t& nodes) {
+      NodeVector_t all;
+      all.reserve (size_ + nodes.size ());
+      this->collect (all);
+      all.insert (all.end (), nodes.begin (), nodes.end ());
+      this->clear ();
+      this->build (all.begin (), all.end ());
+    }
 
-    void KDTree::addNode (const NodePtr_t& node) {
-
-      KDTreePtr_t Leaf = this->findLeaf(node);
-      if ( Leaf->bucket_ < bucketSize_ ) {
-	Leaf->nodesMap_[node->connectedComponent()].push_front(node);
-	Leaf->bucket_++;
-      }
-      else {
-	Leaf->split();
-	for ( NodesMap_t::iterator map = Leaf->nodesMap_.begin();
-	      map != Leaf->nodesMap_.end() ; map++ ) {
-	  for (Nodes_t::iterator it = map->second.begin ();
-	       it != map->second.end (); it++ ) {
-	    Leaf->addNode(*it);
-	  }
-	  map->second.clear();
+    void KDTree::insert (const NodePtr_t& node,
+			 std::vector <KDTreePtr_t>& path) {
+      // go down the tree and add the connected component of the node in
+      // the cells along the way
+      const Configuration_t& q (*(node->configuration()));
+      ConnectedComponent* cc = node->connectedComponent().get();
+      KDTreePtr_t current = this;
+      while (true) {
+	insertComponent (current->components_, cc);
+	current->size_++;
+	path.push_back(current);
+	if ( current->infChild_ == NULL || current->supChild_ == NULL ) {
+	  if ( current->bucket_ < bucketSize_ || !current->split() ) break;
 	}
-	Leaf->addNode(node);
+	if ( q[current->supChild_->splitDim_] >
+	     current->supChild_->lowerBounds_[current->supChild_->splitDim_] )
+	  current = current->supChild_;
+	else
+	  current = current->infChild_;
       }
+      current->nodesMap_[node->connectedComponent()].push_front(node);
+      current->bucket_++;
     }
 
-
     void KDTree::clear() {
       nodesMap_.clear();
-      if ( infChild_ != NULL ) { infChild_ = NULL; }
-      if ( supChild_ != NULL ) { supChild_ = NULL; }
+      components_.clear();
+      bucket_ = 0;
+      if ( infChild_ != NULL ) { delete infChild_; infChild_ = NULL; }
+      if ( supChild_ != NULL ) { delete supChild_; supChild_ = NULL; }
+      size_ = 0;
     }
 
 
-    void KDTree::split() {
+    bool KDTree::split() {
       if ( infChild_ != NULL || supChild_ != NULL ) {
 	// Error, you're triing to split a non leaf part of the KDTree
 	throw std::runtime_error 
 	  ("Attempt to split the KDTree in a non leaf part");
       }
-      else {  infChild_ = new KDTree(this);
-	infChild_->upperBounds_[infChild_->splitDim_] = 
-	  (upperBounds_[infChild_->splitDim_] + 
-	   lowerBounds_[infChild_->splitDim_])/2;
-	supChild_ = (new KDTree(this));
-	supChild_->lowerBounds_[supChild_->splitDim_] = 
-	  (upperBounds_[supChild_->splitDim_] + 
-	   lowerBounds_[supChild_->splitDim_])/2;
+      NodeVector_t nodes;
+      nodes.reserve (bucket_);
+      this->collect (nodes);
+      int splitDim;
+      value_type splitValue;
+      if ( !chooseSplit (nodes.begin (), nodes.end (), splitDim, splitValue) ) {
+	return false;
       }
+      nodesMap_.clear();
+      bucket_ = 0;
+      this->divide (nodes.begin (), nodes.end (), splitDim, splitValue);
+      return true;
+    }
+
+    bool KDTree::chooseSplit (NodeVector_t::iterator begin,
+			      NodeVector_t::iterator end,
+			      int& splitDim, value_type& splitValue) const {
+      const WeighedDistance* weighedDistance =
+	dynamic_cast <const WeighedDistance*> (distance_.get ());
+      value_type maxSpread = 0.;
+      splitDim = 0;
+      for ( int i=0 ; i < dim_ ; i++ ) {
+	value_type lower = std::numeric_limits <value_type>::infinity ();
+	value_type upper = -std::numeric_limits <value_type>::infinity ();
+	for ( NodeVector_t::const_iterator it = begin ; it != end ; it++ ) {
+	  value_type x = (*((*it)->configuration ()))[i];
+	  lower = std::min (lower, x);
+	  upper = std::max (upper, x);
+	}
+	value_type spread = upper - lower;
+	if ( weighedDistance ) {
+	  spread *= weighedDistance->getWeight (root_->jointRanks_ [i]);
+	}
+	if ( spread > maxSpread ) {
+	  maxSpread = spread;
+	  splitDim = i;
+	}
+      }
+      if ( maxSpread <= 0. ) return false;
+      // The split value is between two consecutive distinct values, as
+      // close as possible to the median, so that both children get nodes.
+      std::vector <value_type> values;
+      values.reserve (end - begin);
+      for ( NodeVector_t::const_iterator it = begin ; it != end ; it++ ) {
+	values.push_back ((*((*it)->configuration ()))[splitDim]);
+      }
+      std::sort (values.begin (), values.end ());
+      std::size_t median = values.size () / 2;
+      std::size_t below = median, above = median;
+      while ( below > 0 && values [below - 1] == values [below] ) below--;
+      while ( above < values.size () && values [above - 1] == values [above] )
+	above++;
+      std::size_t index = below;
+      if ( below == 0 || (above < values.size () &&
+			  above - median < median - below) ) {
+	index = above;
+      }
+      splitValue = .5 * (values [index - 1] + values [index]);
+      return true;
+    }
+
+    void KDTree::divide (NodeVector_t::iterator begin,
+			 NodeVector_t::iterator end,
+			 int splitDim, value_type splitValue) {
+      infChild_ = new KDTree(this);
+      infChild_->splitDim_ = splitDim;
+      infChild_->upperBounds_[splitDim] = splitValue;
+      supChild_ = new KDTree(this);
+      supChild_->splitDim_ = splitDim;
+      supChild_->lowerBounds_[splitDim] = splitValue;
+      // Nodes of the superior child first, as in insert
+      NodeVector_t::iterator middle = begin;
+      for ( NodeVector_t::iterator it = begin ; it != end ; it++ ) {
+	if ( (*((*it)->configuration ()))[splitDim] > splitValue ) {
+	  std::swap (*it, *middle);
+	  middle++;
+	}
+      }
+      supChild_->build (begin, middle);
+      infChild_->build (middle, end);
+    }
+
+    void KDTree::build (NodeVector_t::iterator begin,
+			NodeVector_t::iterator end) {
+      size_ = end - begin;
+      for ( NodeVector_t::const_iterator it = begin ; it != end ; it++ ) {
+	insertComponent (components_, (*it)->connectedComponent ().get ());
+      }
+      int splitDim;
+      value_type splitValue;
+      if ( (std::size_t) (end - begin) > bucketSize_ &&
+	   chooseSplit (begin, end, splitDim, splitValue) ) {
+	this->divide (begin, end, splitDim, splitValue);
+	return;
+      }
+      for ( NodeVector_t::const_iterator it = begin ; it != end ; it++ ) {
+	nodesMap_[(*it)->connectedComponent ()].push_front (*it);
+	bucket_++;
+      }
+    }
+
+    void KDTree::collect (NodeVector_t& nodes) const {
+      if ( infChild_ != NULL && supChild_ != NULL ) {
+	infChild_->collect (nodes);
+	supChild_->collect (nodes);
+	return;
+      }
+      for ( NodesMap_t::const_iterator itMap = nodesMap_.begin ();
+	    itMap != nodesMap_.end (); itMap++ ) {
+	nodes.insert (nodes.end (), itMap->second.begin (),
+		      itMap->second.end ());
+      }
+    }
+
+    void KDTree::rebalance (const std::vector <KDTreePtr_t>& path) {
+      // A balanced tree with n nodes is about log2 (n/bucketSize) deep.
+      value_type balancedDepth = std::log
+	((value_type) root_->size_ / bucketSize_ + 1.) / std::log (2.);
+      if ( path.size () <= 2 * balancedDepth + 8 ) return;
+      // The deepest cell the larger child of which holds more than 70% of
+      // the nodes is rebuilt, scapegoat trees thus keep a logarithmic depth
+      // at an amortized logarithmic cost per insertion.
+      for ( std::size_t i = path.size () - 1 ; i > 0 ; i-- ) {
+	KDTreePtr_t cell = path [i - 1];
+	if ( std::max (cell->infChild_->size_, cell->supChild_->size_) >
+	     .7 * cell->size_ ) {
+	  hppDout (info, "Rebuild k-d tree cell of " << cell->size_
+		   << " nodes at depth " << cell->depth_);
+	  cell->rebuild ();
+	  return;
+	}
+      }
+    }
+
+    void KDTree::rebuild () {
+      NodeVector_t nodes;
+      nodes.reserve (size_);
+      this->collect (nodes);
+      nodesMap_.clear();
+      components_.clear();
+      bucket_ = 0;
+      if ( infChild_ != NULL ) { delete infChild_; infChild_ = NULL; }
+      if ( supChild_ != NULL ) { delete supChild_; supChild_ = NULL; }
+      this->build (nodes.begin (), nodes.end ());
+      ++root_->numberRebuilds_;
+    }
+
+    unsigned int KDTree::depth () const {
+      if ( infChild_ == NULL || supChild_ == NULL ) return 0;
+      return 1 + std::max (infChild_->depth (), supChild_->depth ());
     }
 
     // get joints limits
     void KDTree::findDeviceBounds() {
       JointVector_t jv = robot_->getJointVector ();
       int i=0;
+      // Weights of WeighedDistance are indexed over joints with dofs only.
+      std::size_t weightRank = 0;
       for (JointVector_t::const_iterator itJoint = jv.begin ();
 	   itJoint != jv.end (); itJoint++) {
 	for ( unsigned int rank=0 ; rank<(*itJoint)->configSize () ; rank++ ) {
 	  upperBounds_.conservativeResize(upperBounds_.innerSize() + 1 );
 	  lowerBounds_.conservativeResize(lowerBounds_.innerSize() + 1 );
 	  typeDims_.conservativeResize(typeDims_.innerSize() + 1 );
+	  jointRanks_.push_back(weightRank);
+	  firstDims_.push_back(i - rank);
 	  if ( (*itJoint)->configSize () == 4 ) {
 	    //We assume if configDize == 4, then the current joint is a SO3Joint
 	    upperBounds_[i] = 1.;
@@ -208,61 +340,86 @@ namespace hpp {
 	  }
 	  i++;
 	}
+	if ( (*itJoint)->numberDof () != 0 ) weightRank++;
       }
     }
 
 
     value_type KDTree::distanceToBox (const ConfigurationPtr_t& configuration) {
-      value_type minDistance;
-      value_type DistanceToUpperBound;
-      value_type DistanceToLowerBound;
+      const Configuration_t& q (*configuration);
+      if ( root_->typeDims_[splitDim_] == 2. )
+	return distanceToQuaternionBox (q);
+      // Bounded and looped dimensions: zero inside the interval, distance
+      // to the nearest bound otherwise. For looped dimensions, the nearest
+      // point of an arc outside of it is also one of its ends, the
+      // distance takes care of the wrap around.
+      if ( q[splitDim_] >= lowerBounds_[splitDim_] &&
+	   q[splitDim_] <= upperBounds_[splitDim_] ) return 0.;
       // Projection of the configuration on the box
-      Configuration_t confbox = *configuration;
-
-      if ( typeDims_[splitDim_] != 2.) {
-	// Use the "distance" function
-	confbox[splitDim_] = lowerBounds_[splitDim_];
-	DistanceToLowerBound = (*distance_) (*configuration, confbox);
-	confbox[splitDim_] = upperBounds_[splitDim_];
-	DistanceToUpperBound = (*distance_) (*configuration, confbox);
-	minDistance = std::min( DistanceToLowerBound, DistanceToUpperBound );
+      Configuration_t& confbox (root_->qBox_);
+      confbox = q;
+      confbox[splitDim_] = lowerBounds_[splitDim_];
+      value_type distanceToLowerBound = (*distance_) (q, confbox);
+      confbox[splitDim_] = upperBounds_[splitDim_];
+      value_type distanceToUpperBound = (*distance_) (q, confbox);
+      return std::min( distanceToLowerBound, distanceToUpperBound );
+    }
+
+    value_type KDTree::distanceToQuaternionBox (const Configuration_t& q) {
+      // Unit quaternions p of the box satisfy |q.p| <= 1 - e^2 / 2 where e
+      // is the euclidean distance of q or -q to the box, whichever is the
+      // smaller, so the angle between the rotations is at least
+      // 2 asin (e/2), whatever the sign convention of the joint distance.
+      int first = root_->firstDims_[splitDim_];
+      value_type squaredPlus = 0., squaredMinus = 0.;
+      for ( int i=first ; i<first+4 ; i++ ) {
+	value_type x = q[i];
+	if ( x < lowerBounds_[i] ) squaredPlus += pow (lowerBounds_[i] - x, 2);
+	else if ( x > upperBounds_[i] )
+	  squaredPlus += pow (x - upperBounds_[i], 2);
+	if ( -x < lowerBounds_[i] )
+	  squaredMinus += pow (lowerBounds_[i] + x, 2);
+	else if ( -x > upperBounds_[i] )
+	  squaredMinus += pow (-x - upperBounds_[i], 2);
       }
-      else {
-	try {
-	  WeighedDistance& weighedDistance = dynamic_cast<WeighedDistance&>
-	    ( (*distance_) );
-	  DistanceToLowerBound = fabs ( lowerBounds_[splitDim_] - 
-					(*configuration)[splitDim_] )
-	    * weighedDistance.getWeight(splitDim_);
-	  DistanceToUpperBound = fabs ( upperBounds_[splitDim_] -
-					(*configuration)[splitDim_] )
-	    * weighedDistance.getWeight(splitDim_);
-	  minDistance = std::min( DistanceToLowerBound, DistanceToUpperBound );
-
-	  //if ( typeDims_[splitDim_] == 1. ) {
-	  // Distance for looped dimentions 
-	  //(looped dimentions are assumed to be rotations)
-	  //	DistanceToLowerBound = fabs ( lowerBounds_[splitDim_] + M_PI ) +
-	  // fabs ( (*configuration)[splitDim_] - M_PI )
-	  //					* WeighedDistance.weights_[i];
-	  //	DistanceToUpperBound = fabs ( upperBounds_[splitDim_] - M_PI ) +
-	  //fabs ( (*configuration)[splitDim_] + M_PI )
-	  //					* WeighedDistance.weights_[i];
-	  //	minDistance = std::min( minDistance, DistanceToLowerBound);
-	  //	minDistance = std::min( minDistance, DistanceToUpperBound);
-	  //}
+      value_type e = sqrt (std::min (std::min (squaredPlus, squaredMinus), 2.));
+      if ( e == 0. ) return 0.;
+      value_type angle = 2 * asin (.5 * e);
+      // Let the distance weigh the angle: rotate q by the angle around an
+      // axis, v is a unit quaternion orthogonal to q.
+      Configuration_t& confbox (root_->qBox_);
+      confbox = q;
+      const value_type c = cos (angle), s = sin (angle);
+      confbox[first] = c * q[first] - s * q[first+1];
+      confbox[first+1] = c * q[first+1] + s * q[first];
+      confbox[first+2] = c * q[first+2] - s * q[first+3];
+      confbox[first+3] = c * q[first+3] + s * q[first+2];
+      return (*distance_) (q, confbox);
+    }
+
+    void KDTree::distanceToChildren (const ConfigurationPtr_t& configuration,
+				     value_type boxDistance,
+				     value_type& distanceToInfChild,
+				     value_type& distanceToSupChild) {
+      if ( boxDistance == 0. ) {
+	if ( (*configuration) [supChild_->splitDim_]
+	     > supChild_->lowerBounds_[supChild_->splitDim_])  {
+	  distanceToSupChild = 0.;
+	  distanceToInfChild = infChild_->distanceToBox(configuration);
 	}
-	catch (std::bad_cast& bc) {
-	  throw std::runtime_error ("KDTree::DistanceToBox : Distance for quaternions is only implemented for weighedDistance");
-	  hppDout (error, "KDTree::DistanceToBox : Distance for quaternions is only implemented for weighedDistance");
+	else {
+	  distanceToInfChild = 0.;
+	  distanceToSupChild = supChild_->distanceToBox(configuration);
 	}
       }
-      return minDistance;
+      else {
+	distanceToInfChild = infChild_->distanceToBox(configuration);
+	distanceToSupChild = supChild_->distanceToBox(configuration);
+      }
     }
 
-    NodePtr_t KDTree::search (const ConfigurationPtr_t& configuration,
-			      const ConnectedComponentPtr_t& connectedComponent,
-                              value_type& minDistance) {
+    void KDTree::checkRootBox (const ConfigurationPtr_t& configuration) const
+    {
       // Test if the configuration is in the root box
       for ( int i=0 ; i<dim_ ; i++ ) {
 	if ( (*configuration)[i] < lowerBounds_[i] || (*configuration)[i]
@@ -270,6 +427,13 @@ namespace hpp {
 	  throw std::runtime_error ("The Configuration isn't in the root box");
 	}
       }
+    }
+
+    NodePtr_t KDTree::search (const ConfigurationPtr_t& configuration,
+			      const ConnectedComponentPtr_t& connectedComponent,
+                              value_type& minDistance) {
+      checkRootBox (configuration);
+      startSearch (true);
       value_type boxDistance = 0.;
       NodePtr_t nearest = NULL;
       minDistance = std::numeric_limits <value_type>::infinity ();
@@ -282,17 +446,22 @@ namespace hpp {
 			 const ConfigurationPtr_t& configuration, 
 			 const ConnectedComponentPtr_t& connectedComponent,
 			 NodePtr_t& nearest) {
-      if ( boxDistance < minDistance*minDistance 
-	   && nodesMap_.count(connectedComponent) > 0 ) {
+      ++root_->numberVisits_;
+      if ( boxDistance * root_->pruneFactor_ < minDistance*minDistance
+	   && root_->leafBudget_ > 0
+	   && hasComponent (components_, connectedComponent.get ()) ) {
 	// minDistance^2 because boxDistance is a squared distance
 	if ( infChild_ == NULL || supChild_ == NULL ) {
+	  --root_->leafBudget_;
 	  value_type distance = std::numeric_limits <value_type>::infinity ();
-	  for (Nodes_t::iterator itNode = 
-		 nodesMap_[connectedComponent].begin ();
-	       itNode != nodesMap_[connectedComponent].end (); itNode ++) {
-	    distance = (*distance_) (*configuration, 
-				     *((*itNode)->configuration ()));
-	    if (distance < minDistance) {
+	  const Nodes_t& nodes (nodesMap_[connectedComponent]);
+	  for (Nodes_t::const_iterator itNode = nodes.begin ();
+	       itNode != nodes.end (); itNode ++) {
+	    ++root_->numberDistances_;
+	    if (distance_->distanceBelow (*configuration,
+					  *((*itNode)->configuration ()),
+					  minDistance, distance) &&
+		distance < minDistance) {
 	      minDistance = distance;
 	      nearest = (*itNode);
 	    }
@@ -302,21 +471,8 @@ namespace hpp {
 	  // find config to boxes distances
 	  value_type distanceToInfChild;
 	  value_type distanceToSupChild;
-	  if ( boxDistance == 0. ) {
-	    if ( (*configuration) [supChild_->splitDim_] 
-		 > supChild_->lowerBounds_[supChild_->splitDim_])  {
-	      distanceToSupChild = 0.;
-	      distanceToInfChild = infChild_->distanceToBox(configuration);
-	    }
-	    else {
-	      distanceToInfChild = 0.;
-	      distanceToSupChild = supChild_->distanceToBox(configuration);
-	    }
-	  }
-	  else {
-	    distanceToInfChild = infChild_->distanceToBox(configuration);
-	    distanceToSupChild = supChild_->distanceToBox(configuration);
-	  }
+	  distanceToChildren (configuration, boxDistance, distanceToInfChild,
+			      distanceToSupChild);
 	  // search in the children
 	  if ( distanceToInfChild < distanceToSupChild ) {
 	    infChild_->search(boxDistance, minDistance, 
@@ -340,15 +496,300 @@ namespace hpp {
       }
     }
 
+    void KDTree::search (const ConfigurationPtr_t& configuration,
+			 const ConnectedComponents_t& connectedComponents,
+			 NearestNodes_t& nearest) {
+      checkRootBox (configuration);
+      startSearch (true);
+      nearest.clear ();
+      for (ConnectedComponents_t::const_iterator itcc =
+	     connectedComponents.begin ();
+	   itcc != connectedComponents.end (); itcc++) {
+	nearest [*itcc] = std::make_pair
+	  (NodePtr_t (NULL), std::numeric_limits <value_type>::infinity ());
+      }
+      this->search (0., configuration, nearest);
+    }
+
+    void KDTree::search (value_type boxDistance,
+			 const ConfigurationPtr_t& configuration,
+			 NearestNodes_t& nearest) {
+      ++root_->numberVisits_;
+      // The box is explored only if it may improve the nearest node of one
+      // of the connected components it contains.
+      value_type maxDistance = 0.;
+      for (NearestNodes_t::const_iterator itNearest = nearest.begin ();
+	   itNearest != nearest.end (); itNearest++) {
+	if (itNearest->second.second > maxDistance &&
+	    hasComponent (components_, itNearest->first.get ())) {
+	  maxDistance = itNearest->second.second;
+	}
+      }
+      // maxDistance^2 because boxDistance is a squared distance
+      if ( boxDistance * root_->pruneFactor_ >= maxDistance*maxDistance ||
+	   root_->leafBudget_ == 0 ) return;
+      if ( infChild_ == NULL || supChild_ == NULL ) {
+	--root_->leafBudget_;
+	for (NodesMap_t::const_iterator itMap = nodesMap_.begin ();
+	     itMap != nodesMap_.end (); itMap++) {
+	  NearestNodes_t::iterator itNearest = nearest.find (itMap->first);
+	  if (itNearest == nearest.end ()) continue;
+	  value_type& minDistance = itNearest->second.second;
+	  for (Nodes_t::const_iterator itNode = itMap->second.begin ();
+	       itNode != itMap->second.end (); itNode ++) {
+	    value_type distance;
+	    ++root_->numberDistances_;
+	    if (distance_->distanceBelow (*configuration,
+					  *((*itNode)->configuration ()),
+					  minDistance, distance) &&
+		distance < minDistance) {
+	      minDistance = distance;
+	      itNearest->second.first = (*itNode);
+	    }
+	  }
+	}
+      }
+      else {
+	value_type distanceToInfChild;
+	value_type distanceToSupChild;
+	distanceToChildren (configuration, boxDistance, distanceToInfChild,
+			    distanceToSupChild);
+	// search in the children
+	if ( distanceToInfChild < distanceToSupChild ) {
+	  infChild_->search(boxDistance, configuration, nearest);
+	  supChild_->search(boxDistance -
+			    distanceToInfChild*distanceToInfChild +
+			    distanceToSupChild*distanceToSupChild,
+			    configuration, nearest);
+	}
+	else {
+	  supChild_->search(boxDistance, configuration, nearest);
+	  infChild_->search(boxDistance -
+			    distanceToSupChild*distanceToSupChild +
+			    distanceToInfChild*distanceToInfChild,
+			    configuration, nearest);
+	}
+      }
+    }
+
+    void KDTree::kNearest (const ConfigurationPtr_t& configuration,
+			   const ConnectedComponentPtr_t& connectedComponent,
+			   std::size_t k, Nodes_t& nodes) {
+      nodes.clear ();
+      if ( k == 0 ) return;
+      checkRootBox (configuration);
+      startSearch (true);
+      NodeQueue_t queue;
+      this->kNearest (0., configuration, connectedComponent, k, queue);
+      sort (queue, nodes);
+    }
+
+    void KDTree::kNearest (value_type boxDistance,
+			   const ConfigurationPtr_t& configuration,
+			   const ConnectedComponentPtr_t& connectedComponent,
+			   std::size_t k, NodeQueue_t& queue) {
+      ++root_->numberVisits_;
+      value_type maxDistance = bound (queue, k);
+      // maxDistance^2 because boxDistance is a squared distance
+      if ( boxDistance * root_->pruneFactor_ >= maxDistance*maxDistance ||
+	   root_->leafBudget_ == 0 ) return;
+      if ( connectedComponent ?
+	   !hasComponent (components_, connectedComponent.get ()) :
+	   components_.empty() ) return;
+      if ( infChild_ == NULL || supChild_ == NULL ) {
+	--root_->leafBudget_;
+	value_type distance;
+	for ( NodesMap_t::const_iterator itMap = nodesMap_.begin();
+	      itMap != nodesMap_.end(); itMap++ ) {
+	  if ( connectedComponent && itMap->first != connectedComponent )
+	    continue;
+	  for (Nodes_t::const_iterator itNode = itMap->second.begin ();
+	       itNode != itMap->second.end (); itNode ++) {
+	    ++root_->numberDistances_;
+	    if (distance_->distanceBelow (*configuration,
+					  *((*itNode)->configuration ()),
+					  bound (queue, k), distance)) {
+	      push (queue, k, distance, *itNode);
+	    }
+	  }
+	}
+      }
+      else {
+	value_type distanceToInfChild;
+	value_type distanceToSupChild;
+	distanceToChildren (configuration, boxDistance, distanceToInfChild,
+			    distanceToSupChild);
+	if ( distanceToInfChild < distanceToSupChild ) {
+	  infChild_->kNearest(boxDistance, configuration, connectedComponent,
+			      k, queue);
+	  supChild_->kNearest(boxDistance -
+			      distanceToInfChild*distanceToInfChild +
+			      distanceToSupChild*distanceToSupChild,
+			      configuration, connectedComponent, k, queue);
+	}
+	else {
+	  supChild_->kNearest(boxDistance, configuration, connectedComponent,
+			      k, queue);
+	  infChild_->kNearest(boxDistance -
+			      distanceToSupChild*distanceToSupChild +
+			      distanceToInfChild*distanceToInfChild,
+			      configuration, connectedComponent, k, queue);
+	}
+      }
+    }
+
+    void KDTree::withinRadius (const ConfigurationPtr_t& configuration,
+			       const ConnectedComponentPtr_t&
+			       connectedComponent,
+			       value_type radius, Nodes_t& nodes) {
+      nodes.clear ();
+      checkRootBox (configuration);
+      this->withinRadius (0., configuration, connectedComponent, radius,
+			  nodes);
+    }
+
+    void KDTree::withinRadius (value_type boxDistance,
+			       const ConfigurationPtr_t& configuration,
+			       const ConnectedComponentPtr_t&
+			       connectedComponent,
+			       value_type radius, Nodes_t& nodes) {
+      ++root_->numberVisits_;
+      // radius^2 because boxDistance is a squared distance
+      if ( boxDistance > radius*radius ) return;
+      if ( !hasComponent (components_, connectedComponent.get ()) ) return;
+      if ( infChild_ == NULL || supChild_ == NULL ) {
+	NodesMap_t::const_iterator itMap = nodesMap_.find (connectedComponent);
+	if ( itMap == nodesMap_.end () ) return;
+	for (Nodes_t::const_iterator itNode = itMap->second.begin ();
+	     itNode != itMap->second.end (); itNode ++) {
+	  value_type distance;
+	  ++root_->numberDistances_;
+	  if (distance_->distanceBelow (*configuration,
+					*((*itNode)->configuration ()),
+					radius, distance)) {
+	    nodes.push_back (*itNode);
+	  }
+	}
+      }
+      else {
+	value_type distanceToInfChild;
+	value_type distanceToSupChild;
+	distanceToChildren (configuration, boxDistance, distanceToInfChild,
+			    distanceToSupChild);
+	if ( distanceToInfChild < distanceToSupChild ) {
+	  infChild_->withinRadius (boxDistance, configuration,
+				   connectedComponent, radius, nodes);
+	  supChild_->withinRadius (boxDistance -
+				   distanceToInfChild*distanceToInfChild +
+				   distanceToSupChild*distanceToSupChild,
+				   configuration, connectedComponent, radius,
+				   nodes);
+	}
+	else {
+	  supChild_->withinRadius (boxDistance, configuration,
+				   connectedComponent, radius, nodes);
+	  infChild_->withinRadius (boxDistance -
+				   distanceToSupChild*distanceToSupChild +
+				   distanceToInfChild*distanceToInfChild,
+				   configuration, connectedComponent, radius,
+				   nodes);
+	}
+      }
+    }
+
+    NodePtr_t KDTree::nearestWithinRadius
+    (const ConfigurationPtr_t& configuration,
+     const ConnectedComponentPtr_t& connectedComponent, value_type radius,
+     value_type& minDistance) {
+      checkRootBox (configuration);
+      NodePtr_t nearest = NULL;
+      minDistance = radius;
+      this->nearestWithinRadius (0., minDistance, configuration,
+				 connectedComponent, nearest);
+      return nearest;
+    }
+
+    void KDTree::nearestWithinRadius (value_type boxDistance,
+				      value_type& minDistance,
+				      const ConfigurationPtr_t& configuration,
+				      const ConnectedComponentPtr_t&
+				      connectedComponent,
+				      NodePtr_t& nearest) {
+      ++root_->numberVisits_;
+      // minDistance^2 because boxDistance is a squared distance
+      if ( boxDistance >= minDistance*minDistance ) return;
+      if ( connectedComponent ?
+	   !hasComponent (components_, connectedComponent.get ()) :
+	   components_.empty() ) return;
+      if ( infChild_ == NULL || supChild_ == NULL ) {
+	for ( NodesMap_t::const_iterator itMap = nodesMap_.begin();
+	      itMap != nodesMap_.end(); itMap++ ) {
+	  if ( connectedComponent && itMap->first != connectedComponent )
+	    continue;
+	  for (Nodes_t::const_iterator itNode = itMap->second.begin ();
+	       itNode != itMap->second.end (); itNode ++) {
+	    value_type distance;
+	    ++root_->numberDistances_;
+	    if (distance_->distanceBelow (*configuration,
+					  *((*itNode)->configuration ()),
+					  minDistance, distance) &&
+		distance < minDistance) {
+	      minDistance = distance;
+	      nearest = (*itNode);
+	    }
+	  }
+	}
+      }
+      else {
+	value_type distanceToInfChild;
+	value_type distanceToSupChild;
+	distanceToChildren (configuration, boxDistance, distanceToInfChild,
+			    distanceToSupChild);
+	if ( distanceToInfChild < distanceToSupChild ) {
+	  infChild_->nearestWithinRadius (boxDistance, minDistance,
+					  configuration, connectedComponent,
+					  nearest);
+	  supChild_->nearestWithinRadius (boxDistance -
+					  distanceToInfChild*distanceToInfChild
+					  +
+					  distanceToSupChild*distanceToSupChild,
+					  minDistance, configuration,
+					  connectedComponent, nearest);
+	}
+	else {
+	  supChild_->nearestWithinRadius (boxDistance, minDistance,
+					  configuration, connectedComponent,
+					  nearest);
+	  infChild_->nearestWithinRadius (boxDistance -
+					  distanceToSupChild*distanceToSupChild
+					  +
+					  distanceToInfChild*distanceToInfChild,
+					  minDistance, configuration,
+					  connectedComponent, nearest);
+	}
+      }
+    }
+
     void KDTree::merge(ConnectedComponentPtr_t cc1,
 		       ConnectedComponentPtr_t cc2) {
-      nodesMap_[cc1].merge(nodesMap_[cc2]);
-      NodesMap_t::iterator it = nodesMap_.find (cc2);
-      nodesMap_.erase(it);
+      // Nodes of a cell are present in the parent cell: subtrees
+      // without cc2 are left untouched.
+      Components_t::iterator itcc = std::lower_bound
+	(components_.begin (), components_.end (), cc2.get ());
+      if (itcc == components_.end () || *itcc != cc2.get ()) return;
+      components_.erase (itcc);
+      insertComponent (components_, cc1.get ());
       if ( infChild_ != NULL || supChild_ != NULL ) {
 	infChild_->merge(cc1, cc2);
 	supChild_->merge(cc1, cc2);
       }
+      else {
+	NodesMap_t::iterator it = nodesMap_.find (cc2);
+	if (it == nodesMap_.end ()) return;
+	Nodes_t& nodes (nodesMap_[cc1]);
+	nodes.splice (nodes.end (), it->second);
+	nodesMap_.erase(it);
+      }
     }
   }
 }
@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/lazy-prm-planner.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method.hh>
+#include "astar.hh"
+#include "basic-configuration-shooter.hh"
+
+namespace hpp {
+  namespace core {
+    extern std::string displayConfig (ConfigurationIn_t q);
+
+    LazyPrmPlannerPtr_t LazyPrmPlanner::createWithRoadmap
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      LazyPrmPlanner* ptr = new LazyPrmPlanner (problem, roadmap);
+      return LazyPrmPlannerPtr_t (ptr);
+    }
+
+    LazyPrmPlannerPtr_t LazyPrmPlanner::create (const Problem& problem)
+    {
+      LazyPrmPlanner* ptr = new LazyPrmPlanner (problem);
+      return LazyPrmPlannerPtr_t (ptr);
+    }
+
+    LazyPrmPlanner::LazyPrmPlanner (const Problem& problem):
+      PathPlanner (problem),
+      configurationShooter_ (new BasicConfigurationShooter
+			     (problem.robot (),
+			      problem.randomGenerator ()->split ())),
+      numberNeighbors_ (10)
+    {
+    }
+
+    LazyPrmPlanner::LazyPrmPlanner (const Problem& problem,
+				    const RoadmapPtr_t& roadmap) :
+      PathPlanner (problem, roadmap),
+      configurationShooter_ (new BasicConfigurationShooter
+			     (problem.robot (),
+			      problem.randomGenerator ()->split ())),
+      numberNeighbors_ (10)
+    {
+    }
+
+    bool LazyPrmPlanner::isValid (const ConfigurationPtr_t& q)
+    {
+      PathPtr_t path ((*(problem ().steeringMethod ())) (*q, *q));
+      PathPtr_t validPart;
+      Statistics::Timer timer (timers (), Statistics::COLLISION_CHECKING);
+      return path &&
+	problem ().pathValidation ()->validate (path, false, validPart);
+    }
+
+    void LazyPrmPlanner::oneStep ()
+    {
+      const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
+      ConfigurationPtr_t q;
+      {
+	Statistics::Timer timer (timers (), Statistics::SHOOTING);
+	q = configurationShooter_->shoot ();
+      }
+      const ConstraintSetPtr_t& constraints (sm->constraints ());
+      if (constraints) {
+	Statistics::Timer timer (timers (), Statistics::PROJECTION);
+	if (!constraints->apply (*q)) return;
+      }
+      if (!isValid (q)) return;
+      hppDout (info, "q_new = " << displayConfig (*q));
+      // Nearest nodes of the roadmap, whatever their connected component,
+      // sorted by distance
+      Nodes_t neighbors;
+      {
+	Statistics::Timer timer (timers (), Statistics::NEAREST_NEIGHBOR);
+	roadmap ()->nearestNodes (q, ConnectedComponentPtr_t (),
+				  numberNeighbors_, neighbors);
+      }
+      // Too close to a node of the roadmap
+      if (!neighbors.empty ()) {
+	const Configuration_t& nearest
+	  (*(neighbors.front ()->configuration ()));
+	if ((*problem ().distance ()) (*q, nearest) < 1e-4) return;
+      }
+      NodePtr_t node = roadmap ()->addNode (q, false);
+      for (Nodes_t::const_iterator itNeighbor = neighbors.begin ();
+	   itNeighbor != neighbors.end (); ++itNeighbor) {
+	const NodePtr_t& neighbor (*itNeighbor);
+	PathPtr_t path;
+	{
+	  Statistics::Timer timer (timers (), Statistics::STEERING);
+	  path = (*sm) (*(neighbor->configuration ()), *q);
+	}
+	if (!path) continue;
+	roadmap ()->addLazyEdges (neighbor, node, path);
+      }
+      validateCandidates ();
+    }
+
+    void LazyPrmPlanner::validateCandidates ()
+    {
+      const PathValidationPtr_t& pathValidation
+	(problem ().pathValidation ());
+      Astar astar (roadmap (), problem ().distance (), true);
+      Astar::Edges_t edges;
+      // Each candidate has at least one edge of unknown status, otherwise
+      // its nodes are in the same connected component.
+      while (!pathExists ()) {
+	{
+	  Statistics::Timer timer (timers (), Statistics::GRAPH_SEARCH);
+	  if (!astar.edges (edges)) return;
+	}
+	for (Astar::Edges_t::const_iterator itEdge = edges.begin ();
+	     itEdge != edges.end (); ++itEdge) {
+	  if ((*itEdge)->status () == Edge::VALID) continue;
+	  bool valid;
+	  {
+	    Statistics::Timer timer (timers (), Statistics::COLLISION_CHECKING);
+	    valid = pathValidation->isValid ((*itEdge)->path ());
+	  }
+	  if (valid) {
+	    edgeStatus (*itEdge, Edge::VALID);
+	  } else {
+	    edgeStatus (*itEdge, Edge::INVALID);
+	    break;
+	  }
+	}
+      }
+    }
+
+    void LazyPrmPlanner::edgeStatus (const EdgePtr_t& edge,
+				     Edge::Status status)
+    {
+      roadmap ()->edgeStatus (edge, status);
+      const Node::Edges_t& edges (edge->to ()->outEdges ());
+      for (Node::Edges_t::const_iterator itEdge = edges.begin ();
+	   itEdge != edges.end (); ++itEdge) {
+	if ((*itEdge)->to () == edge->from () &&
+	    (*itEdge)->status () == Edge::UNKNOWN) {
+	  roadmap ()->edgeStatus (*itEdge, status);
+	}
+      }
+    }
+
+    PathVectorPtr_t LazyPrmPlanner::finishSolve (const PathVectorPtr_t& path)
+    {
+      return path;
+    }
+
+    void LazyPrmPlanner::configurationShooter
+    (const ConfigurationShooterPtr_t& shooter)
+    {
+      configurationShooter_ = shooter;
+    }
+  } // namespace core
+} // namespace hpp
@@ -97,8 +97,7 @@ namespace hpp {
       void nearest (const ConfigurationPtr_t& configuration, std::size_t k,
 		    Nodes_t& nearestNeighbors) const
       {
-	Nodes_t copy;
-	std::copy (nodes_.begin (), nodes_.end (), copy.begin ());
+	Nodes_t copy (nodes_);
 	nearestNeighbors.clear ();
 	while (nearestNeighbors.size () < k) {
 	  value_type minDistance = std::numeric_limits <value_type>::infinity ();
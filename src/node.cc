@@ -25,14 +25,16 @@ namespace hpp {
   namespace core {
     Node::Node (const ConfigurationPtr_t& configuration) :
       configuration_ (configuration),
-      connectedComponent_ (ConnectedComponent::create ())
+      connectedComponent_ (ConnectedComponent::create ()), index_ (0),
+      distanceToGoal_ (0), goalRevision_ (0)
     {
     }
 
     Node::Node (const ConfigurationPtr_t& configuration,
 		ConnectedComponentPtr_t connectedComponent) :
       configuration_ (configuration),
-      connectedComponent_ (connectedComponent)
+      connectedComponent_ (connectedComponent), index_ (0), distanceToGoal_ (0),
+      goalRevision_ (0)
     {
       assert (connectedComponent_);
     }
@@ -77,6 +79,18 @@ namespace hpp {
       inEdges_.push_back (edge);
     }
 
+    void Node::removeOutEdge (EdgePtr_t edge)
+    {
+      assert (edge->from () == this);
+      outEdges_.remove (edge);
+    }
+
+    void Node::removeInEdge (EdgePtr_t edge)
+    {
+      assert (edge->to () == this);
+      inEdges_.remove (edge);
+    }
+
     void Node::connectedComponent (const ConnectedComponentPtr_t& cc)
     {
       connectedComponent_ = cc;
@@ -84,7 +98,7 @@ namespace hpp {
 
     ConnectedComponentPtr_t Node::connectedComponent () const
     {
-      return connectedComponent_;
+      return connectedComponent_->representative ();
     }
 
     const Edges_t& Node::outEdges () const
@@ -0,0 +1,321 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/parallel-diffusing-planner.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method.hh>
+#include "basic-configuration-shooter.hh"
+
+namespace hpp {
+  namespace core {
+    // Defined in diffusing-planner.cc
+    extern bool belongs (const ConfigurationPtr_t& q, const Nodes_t& nodes);
+
+    ParallelDiffusingPlannerPtr_t ParallelDiffusingPlanner::createWithRoadmap
+    (const Problem& problem, const RoadmapPtr_t& roadmap,
+     std::size_t nbThreads)
+    {
+      ParallelDiffusingPlanner* ptr =
+	new ParallelDiffusingPlanner (problem, roadmap, nbThreads);
+      return ParallelDiffusingPlannerPtr_t (ptr);
+    }
+
+    ParallelDiffusingPlannerPtr_t ParallelDiffusingPlanner::create
+    (const Problem& problem, std::size_t nbThreads)
+    {
+      ParallelDiffusingPlanner* ptr =
+	new ParallelDiffusingPlanner (problem, nbThreads);
+      return ParallelDiffusingPlannerPtr_t (ptr);
+    }
+
+    ParallelDiffusingPlanner::ParallelDiffusingPlanner
+    (const Problem& problem, std::size_t nbThreads) :
+      PathPlanner (problem), workers_ (), sharedMutex_ (), mutex_ (),
+      stop_ (false), iterations_ (0), status_ (SUCCESS), error_ ()
+    {
+      if (nbThreads == 0) {
+	nbThreads = std::max (boost::thread::hardware_concurrency (), 1u);
+      }
+      // Shooters keep a reference to the robot of their worker: workers
+      // are never moved afterwards.
+      workers_.resize (nbThreads);
+    }
+
+    ParallelDiffusingPlanner::ParallelDiffusingPlanner
+    (const Problem& problem, const RoadmapPtr_t& roadmap,
+     std::size_t nbThreads) :
+      PathPlanner (problem, roadmap), workers_ (), sharedMutex_ (), mutex_ (),
+      stop_ (false), iterations_ (0), status_ (SUCCESS), error_ ()
+    {
+      if (nbThreads == 0) {
+	nbThreads = std::max (boost::thread::hardware_concurrency (), 1u);
+      }
+      workers_.resize (nbThreads);
+    }
+
+    void ParallelDiffusingPlanner::initWorkers ()
+    {
+      const DevicePtr_t& robot (problem ().robot ());
+      PathValidationPtr_t pathValidation (problem ().pathValidation ());
+      // Only numerical constraints use the robot of the problem
+      const ConstraintSetPtr_t& constraints
+	(problem ().steeringMethod ()->constraints ());
+      bool constrained = constraints && constraints->configProjector ();
+      for (Workers_t::iterator it = workers_.begin (); it != workers_.end ();
+	   ++it) {
+	it->robot = robot->clone ();
+	it->configurationShooter = ConfigurationShooterPtr_t
+	  (new BasicConfigurationShooter
+	   (it->robot, problem ().randomGenerator ()->split ()));
+	it->pathValidation = pathValidation->clone (it->robot);
+	it->shared = constrained || !it->pathValidation;
+	if (!it->pathValidation) it->pathValidation = pathValidation;
+	it->qProj.resize (robot->configSize ());
+	it->qRand = ConfigurationPtr_t (new Configuration_t
+					(robot->configSize ()));
+	it->statistics.reset ();
+      }
+    }
+
+    void ParallelDiffusingPlanner::startSolve ()
+    {
+      PathPlanner::startSolve ();
+      initWorkers ();
+    }
+
+    PathPlanner::Status ParallelDiffusingPlanner::plan (PathVectorPtr_t& path)
+    {
+      {
+	boost::mutex::scoped_lock lock (mutex_);
+	stop_ = false;
+	iterations_ = 0;
+	status_ = SUCCESS;
+	error_.clear ();
+      }
+      // The interruption flag is owned by PathPlanner: an interruption sent
+      // before the workers start is kept.
+      if (interrupted ()) return INTERRUPTED;
+      startSolve ();
+      boost::thread_group threads;
+      for (std::size_t rank = 0; rank < workers_.size (); ++rank) {
+	threads.create_thread
+	  (boost::bind (&ParallelDiffusingPlanner::work, this, rank));
+      }
+      // Workers return when a path is found, when the planner is
+      // interrupted, when the budget is exhausted or when one of them
+      // fails.
+      threads.join_all ();
+      if (interrupted ()) return INTERRUPTED;
+      if (!error_.empty ()) throw std::runtime_error (error_);
+      // A worker may connect the roadmap while another one stops on budget
+      if (!pathExists ()) return status_;
+      PathVectorPtr_t planned =  computePath ();
+      path = finishSolve (planned);
+      return SUCCESS;
+    }
+
+    bool ParallelDiffusingPlanner::stopped ()
+    {
+      if (interrupted ()) return true;
+      boost::mutex::scoped_lock lock (mutex_);
+      return stop_;
+    }
+
+    void ParallelDiffusingPlanner::work (std::size_t rank)
+    {
+      try {
+	while (!stopped ()) {
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    Status status = checkBudget (iterations_);
+	    if (status != SUCCESS) {
+	      status_ = status;
+	      stop_ = true;
+	      return;
+	    }
+	    ++iterations_;
+	  }
+	  step (workers_ [rank]);
+	  if (pathExists ()) {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    stop_ = true;
+	  }
+	}
+      } catch (const std::exception& exc) {
+	hppDout (error, "worker " << rank << ": " << exc.what ());
+	boost::mutex::scoped_lock lock (mutex_);
+	if (error_.empty ()) error_ = exc.what ();
+	stop_ = true;
+      }
+    }
+
+    const Statistics& ParallelDiffusingPlanner::statistics () const
+    {
+      statistics_ = PathPlanner::statistics ();
+      for (Workers_t::const_iterator it = workers_.begin ();
+	   it != workers_.end (); ++it) {
+	statistics_ += it->statistics;
+	// Samples of the path validation of the problem are already counted,
+	// copies are created with the workers.
+	if (it->pathValidation &&
+	    it->pathValidation != problem ().pathValidation ()) {
+	  statistics_.add (Statistics::COLLISION_SAMPLES,
+			   it->pathValidation->numberSamples ());
+	}
+      }
+      return statistics_;
+    }
+
+    void ParallelDiffusingPlanner::oneStep ()
+    {
+      if (!workers_ [0].robot) initWorkers ();
+      step (workers_ [0]);
+    }
+
+    PathPtr_t ParallelDiffusingPlanner::extend (Worker& worker,
+						const NodePtr_t& near,
+						ConfigurationIn_t target)
+    {
+      const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
+      const ConstraintSetPtr_t& constraints (sm->constraints ());
+      if (constraints) {
+	bool projected;
+	{
+	  Statistics::Timer timer (worker.statistics, Statistics::PROJECTION);
+	  ConfigProjectorPtr_t configProjector
+	    (constraints->configProjector ());
+	  if (configProjector) {
+	    configProjector->projectOnKernel (*(near->configuration ()),
+					      target, worker.qProj);
+	  } else {
+	    worker.qProj = target;
+	  }
+	  projected = constraints->apply (worker.qProj);
+	}
+	if (!projected) return PathPtr_t ();
+	Statistics::Timer timer (worker.statistics, Statistics::STEERING);
+	return (*sm) (*(near->configuration ()), worker.qProj);
+      }
+      Statistics::Timer timer (worker.statistics, Statistics::STEERING);
+      return (*sm) (*(near->configuration ()), target);
+    }
+
+    bool ParallelDiffusingPlanner::validate (Worker& worker,
+					     const PathPtr_t& path,
+					     PathPtr_t& validPart)
+    {
+      Statistics::Timer timer (worker.statistics,
+			       Statistics::COLLISION_CHECKING);
+      return worker.pathValidation->validate (path, false, validPart);
+    }
+
+    void ParallelDiffusingPlanner::step (Worker& worker)
+    {
+      Nodes_t newNodes;
+      PathPtr_t validPath, path;
+      const ConfigurationPtr_t& q_rand (worker.qRand);
+      {
+	Statistics::Timer timer (worker.statistics, Statistics::SHOOTING);
+	worker.configurationShooter->shoot (*q_rand);
+      }
+      //
+      // First extend each connected component toward q_rand
+      //
+      // Connected components may be merged by other workers meanwhile,
+      // only the nearest nodes are used.
+      NearestNodes_t nearestNodes;
+      {
+	Statistics::Timer timer (worker.statistics,
+				 Statistics::NEAREST_NEIGHBOR);
+	roadmap ()->nearestNodes (q_rand, nearestNodes);
+      }
+      for (NearestNodes_t::const_iterator itNearest = nearestNodes.begin ();
+	   itNearest != nearestNodes.end (); ++itNearest) {
+	if (stopped ()) return;
+	const NodePtr_t& near (itNearest->second.first);
+	if (!near) continue;
+	bool pathValid;
+	ConfigurationPtr_t q_new;
+	{
+	  boost::mutex::scoped_lock lock (sharedMutex_, boost::defer_lock);
+	  if (worker.shared) lock.lock ();
+	  path = extend (worker, near, *q_rand);
+	  if (!path) continue;
+	  pathValid = validate (worker, path, validPath);
+	  value_type t_final = validPath->timeRange ().second;
+	  if (t_final == path->timeRange ().first) continue;
+	  q_new = ConfigurationPtr_t (new Configuration_t
+				      ((*validPath) (t_final)));
+	}
+	// Insert new path to q_near in roadmap
+	if (!pathValid || !belongs (q_new, newNodes)) {
+	  // q_new is the random configuration or the end of the valid part
+	  // of the extension: it is not in the roadmap.
+	  newNodes.push_back (roadmap ()->addNodeAndEdge
+			      (near, q_new, validPath, false));
+	} else {
+	  NodePtr_t newNode = roadmap ()->addNode (q_new);
+	  roadmap ()->addEdges (near, newNode, validPath);
+	}
+      }
+      //
+      // Second, try to connect new nodes together
+      //
+      const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
+      for (Nodes_t::const_iterator itn1 = newNodes.begin ();
+	   itn1 != newNodes.end (); ++itn1) {
+	for (Nodes_t::const_iterator itn2 = boost::next (itn1);
+	     itn2 != newNodes.end (); ++itn2) {
+	  if (stopped ()) return;
+	  ConfigurationPtr_t q1 ((*itn1)->configuration ());
+	  ConfigurationPtr_t q2 ((*itn2)->configuration ());
+	  assert (*q1 != *q2);
+	  {
+	    boost::mutex::scoped_lock lock (sharedMutex_, boost::defer_lock);
+	    if (worker.shared) lock.lock ();
+	    {
+	      Statistics::Timer timer (worker.statistics,
+				       Statistics::STEERING);
+	      path = (*sm) (*q1, *q2);
+	    }
+	    if (!validate (worker, path, validPath)) continue;
+	  }
+	  roadmap ()->addEdges (*itn1, *itn2, path);
+	}
+      }
+    }
+
+    PathVectorPtr_t ParallelDiffusingPlanner::finishSolve
+    (const PathVectorPtr_t& path)
+    {
+      return path;
+    }
+  } // namespace core
+} // namespace hpp
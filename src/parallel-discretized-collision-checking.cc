@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <boost/bind.hpp>
+#include <hpp/model/device.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/discretized-collision-checking.hh>
+#include <hpp/core/parallel-discretized-collision-checking.hh>
+#include "discretization.hh"
+
+namespace hpp {
+  namespace core {
+
+    ParallelDiscretizedCollisionCheckingPtr_t
+    ParallelDiscretizedCollisionChecking::create (const DevicePtr_t& robot,
+						  const value_type& stepSize,
+						  std::size_t nbThreads)
+    {
+      ParallelDiscretizedCollisionChecking* ptr =
+	new ParallelDiscretizedCollisionChecking (robot, stepSize, nbThreads);
+      return ParallelDiscretizedCollisionCheckingPtr_t (ptr);
+    }
+
+    ParallelDiscretizedCollisionChecking::ParallelDiscretizedCollisionChecking
+    (const DevicePtr_t& robot, const value_type& stepSize,
+     std::size_t nbThreads) :
+      PathValidation (), robot_ (robot), stepSize_ (stepSize), devices_ (),
+      threads_ (), mutex_ (), constraintMutex_ (), jobCondition_ (),
+      doneCondition_ (), path_ (), times_ (), next_ (0), firstInvalid_ (0),
+      running_ (0), job_ (0), stop_ (false)
+    {
+      if (nbThreads == 0) {
+	nbThreads = std::max (boost::thread::hardware_concurrency (), 1u);
+      }
+      devices_.resize (nbThreads);
+      updateDevices ();
+      for (std::size_t rank = 0; rank < nbThreads; ++rank) {
+	threads_.create_thread
+	  (boost::bind (&ParallelDiscretizedCollisionChecking::work, this,
+			rank));
+      }
+    }
+
+    ParallelDiscretizedCollisionChecking::
+    ~ParallelDiscretizedCollisionChecking ()
+    {
+      {
+	boost::mutex::scoped_lock lock (mutex_);
+	stop_ = true;
+      }
+      jobCondition_.notify_all ();
+      threads_.join_all ();
+    }
+
+    void ParallelDiscretizedCollisionChecking::updateDevices ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      for (std::size_t rank = 0; rank < devices_.size (); ++rank) {
+	devices_ [rank] = robot_->clone ();
+      }
+    }
+
+    void ParallelDiscretizedCollisionChecking::obstaclesChanged ()
+    {
+      updateDevices ();
+    }
+
+    void ParallelDiscretizedCollisionChecking::work (std::size_t rank)
+    {
+      std::size_t job = 0;
+      Configuration_t q (robot_->configSize ());
+      boost::mutex::scoped_lock lock (mutex_);
+      while (true) {
+	while (!stop_ && job == job_) jobCondition_.wait (lock);
+	if (stop_) return;
+	job = job_;
+	DevicePtr_t robot (devices_ [rank]);
+	// Only numerical constraints use the robot of the problem
+	bool constrained = path_->constraints () &&
+	  path_->constraints ()->configProjector ();
+	// Samples are taken in increasing order, so that all samples before
+	// the first collision are checked.
+	while (next_ < firstInvalid_) {
+	  std::size_t i = next_++;
+	  lock.unlock ();
+	  if (constrained) {
+	    boost::mutex::scoped_lock constraintLock (constraintMutex_);
+	    (*path_) (q, times_ [i]);
+	  } else {
+	    (*path_) (q, times_ [i]);
+	  }
+	  robot->currentConfiguration (q);
+	  robot->computeForwardKinematics ();
+	  bool collision = robot->collisionTest ();
+	  lock.lock ();
+	  if (collision && i < firstInvalid_) firstInvalid_ = i;
+	}
+	if (--running_ == 0) doneCondition_.notify_one ();
+      }
+    }
+
+    bool ParallelDiscretizedCollisionChecking::validate
+    (const PathPtr_t& path, bool reverse, PathPtr_t& validPart)
+    {
+      value_type tmin = path->timeRange ().first;
+      value_type tmax = path->timeRange ().second;
+      boost::mutex::scoped_lock lock (mutex_);
+      sequentialParameters (path->timeRange (), stepSize_, reverse, times_);
+      check (path, lock);
+      if (firstInvalid_ == times_.size ()) {
+	validPart = path;
+	return true;
+      }
+      if (reverse) {
+	value_type lastValidTime =
+	  firstInvalid_ == 0 ? tmax : times_ [firstInvalid_ - 1];
+	validPart = path->extract (std::make_pair (lastValidTime, tmax));
+      } else {
+	value_type lastValidTime =
+	  firstInvalid_ == 0 ? tmin : times_ [firstInvalid_ - 1];
+	validPart = path->extract (std::make_pair (tmin, lastValidTime));
+      }
+      return false;
+    }
+
+    PathValidationPtr_t ParallelDiscretizedCollisionChecking::clone
+    (const DevicePtr_t& robot) const
+    {
+      return DiscretizedCollisionChecking::create (robot, stepSize_);
+    }
+
+    bool ParallelDiscretizedCollisionChecking::isValid (const PathPtr_t& path)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      bisectionParameters (path->timeRange (), stepSize_, times_);
+      check (path, lock);
+      return firstInvalid_ == times_.size ();
+    }
+
+    void ParallelDiscretizedCollisionChecking::check
+    (const PathPtr_t& path, boost::mutex::scoped_lock& lock)
+    {
+      path_ = path;
+      next_ = 0;
+      firstInvalid_ = times_.size ();
+      running_ = devices_.size ();
+      ++job_;
+      jobCondition_.notify_all ();
+      while (running_ != 0) doneCondition_.wait (lock);
+      numberSamples_ += next_;
+      path_.reset ();
+    }
+
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/parallel-random-shortcut.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/steering-method.hh>
+
+namespace hpp {
+  namespace core {
+    struct ParallelRandomShortcut::Candidate {
+      /// Bounds of the three parts, in increasing order
+      value_type t [4];
+      PathVectorPtr_t result;
+      value_type length;
+      /// Shortcuts checked by the path validation
+      Validity_t checked;
+      std::size_t hits;
+    }; // struct Candidate
+
+    ParallelRandomShortcutPtr_t
+    ParallelRandomShortcut::create (const Problem& problem,
+				    std::size_t nbThreads)
+    {
+      ParallelRandomShortcut* ptr =
+	new ParallelRandomShortcut (problem, nbThreads);
+      return ParallelRandomShortcutPtr_t (ptr);
+    }
+
+    ParallelRandomShortcut::ParallelRandomShortcut (const Problem& problem,
+						    std::size_t nbThreads) :
+      RandomShortcut (problem), nbThreads_ (nbThreads)
+    {
+      if (nbThreads_ == 0) {
+	nbThreads_ = std::max (boost::thread::hardware_concurrency (), 1u);
+      }
+    }
+
+    void ParallelRandomShortcut::evaluate
+    (const PathValidationPtr_t& pathValidation, const PathVectorPtr_t& path,
+     const Validity_t& validity, Candidate& candidate) const
+    {
+      using std::make_pair;
+      const SteeringMethodPtr_t& steeringMethod
+	(problem ().steeringMethod ());
+      candidate.result = PathVector::create (path->outputSize ());
+      candidate.checked.clear ();
+      candidate.hits = 0;
+      for (unsigned i=0; i<3; ++i) {
+	value_type ta = candidate.t [i], tb = candidate.t [i+1];
+	// Only validity matters here: shortcuts in collision are rejected.
+	PathPtr_t straight;
+	if (sameElement (path, ta, tb)) {
+	  ++candidate.hits;
+	} else {
+	  Configuration_t qa ((*path) (ta)), qb ((*path) (tb));
+	  std::vector <value_type> key (shortcutKey (qa, qb));
+	  Validity_t::const_iterator itValid = validity.find (key);
+	  straight = (*steeringMethod) (qa, qb);
+	  bool valid;
+	  if (itValid != validity.end ()) {
+	    ++candidate.hits;
+	    valid = itValid->second;
+	  } else {
+	    valid = pathValidation->isValid (straight);
+	    candidate.checked [key] = valid;
+	  }
+	  if (!valid) straight.reset ();
+	}
+	if (straight) {
+	  candidate.result->appendPath (straight);
+	} else {
+	  PathVectorPtr_t part
+	    (path->extract (make_pair (ta, tb))->as <PathVector> ());
+	  for (std::size_t j=0; j<part->numberPaths (); ++j) {
+	    candidate.result->appendPath (part->pathAtRank (j));
+	  }
+	}
+      }
+      candidate.length = pathLength (candidate.result, problem ().distance ());
+    }
+
+    PathVectorPtr_t
+    ParallelRandomShortcut::optimize (const PathVectorPtr_t& path) const
+    {
+      using std::numeric_limits;
+      // Copies of the robot and path validations used by the threads
+      std::vector <DevicePtr_t> robots (nbThreads_);
+      std::vector <PathValidationPtr_t> pathValidations (nbThreads_);
+      const ConstraintSetPtr_t& constraints (problem ().constraints ());
+      bool concurrent = nbThreads_ > 1 &&
+	!(constraints && constraints->configProjector ());
+      for (std::size_t i = 0; i < nbThreads_ && concurrent; ++i) {
+	robots [i] = problem ().robot ()->clone ();
+	pathValidations [i] = problem ().pathValidation ()->clone (robots [i]);
+	if (!pathValidations [i]) concurrent = false;
+      }
+      bool finished = false;
+      PathVectorPtr_t tmpPath = path;
+
+      // Maximal number of iterations without improvements
+      const std::size_t n = 10;
+      std::deque <value_type> length (n-1,
+				      numeric_limits <value_type>::infinity ());
+      length.push_back (pathLength (tmpPath, problem ().distance ()));
+      std::vector <Candidate> candidates (nbThreads_);
+      // Written between iterations only
+      Validity_t validity;
+      cacheHits_ = 0;
+      cacheMisses_ = 0;
+
+      while (!finished && !stopRequested ()) {
+	value_type t3 = tmpPath->timeRange ().second;
+	for (std::size_t i = 0; i < nbThreads_; ++i) {
+	  value_type u2 = generator_->uniform (0, t3);
+	  value_type u1 = generator_->uniform (0, t3);
+	  Candidate& candidate (candidates [i]);
+	  candidate.t [0] = 0;
+	  candidate.t [1] = std::min (u1, u2);
+	  candidate.t [2] = std::max (u1, u2);
+	  candidate.t [3] = t3;
+	}
+	if (concurrent) {
+	  boost::thread_group threads;
+	  for (std::size_t i = 0; i < nbThreads_; ++i) {
+	    threads.create_thread
+	      (boost::bind (&ParallelRandomShortcut::evaluate, this,
+			    pathValidations [i], tmpPath,
+			    boost::cref (validity),
+			    boost::ref (candidates [i])));
+	  }
+	  threads.join_all ();
+	} else {
+	  for (std::size_t i = 0; i < nbThreads_; ++i) {
+	    evaluate (problem ().pathValidation (), tmpPath, validity,
+		      candidates [i]);
+	  }
+	}
+	std::size_t best = 0;
+	for (std::size_t i = 0; i < nbThreads_; ++i) {
+	  if (candidates [i].length < candidates [best].length) best = i;
+	  cacheHits_ += candidates [i].hits;
+	  cacheMisses_ += candidates [i].checked.size ();
+	  validity.insert (candidates [i].checked.begin (),
+			   candidates [i].checked.end ());
+	}
+	length.push_back (candidates [best].length);
+	length.pop_front ();
+	finished = (length [0] <= length [n-1]);
+	hppDout (info, "length = " << length [n-1]);
+	tmpPath = candidates [best].result;
+      }
+      hppDout (info, "shortcut validity cache: " << cacheHits_ << " hits, "
+	       << cacheMisses_ << " misses");
+      return tmpPath;
+    }
+  } // namespace core
+} // namespace hpp
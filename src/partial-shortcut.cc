@@ -0,0 +1,225 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/partial-shortcut.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/steering-method.hh>
+
+namespace hpp {
+  namespace core {
+    const value_type PartialShortcut::minGain = 1e-3;
+
+    PartialShortcutPtr_t PartialShortcut::create (const Problem& problem)
+    {
+      PartialShortcut* ptr = new PartialShortcut (problem);
+      return PartialShortcutPtr_t (ptr);
+    }
+
+    PartialShortcut::PartialShortcut (const Problem& problem) :
+      RandomShortcut (problem), joints_ (), maxFailures_ (20)
+    {
+      const JointVector_t& jointVector (problem.robot ()->getJointVector ());
+      for (JointVector_t::const_iterator itJoint = jointVector.begin ();
+	   itJoint != jointVector.end (); ++itJoint) {
+	if ((*itJoint)->numberDof () != 0) joints_.push_back (*itJoint);
+      }
+    }
+
+    PathVectorPtr_t PartialShortcut::optimize (const PathVectorPtr_t& path)
+      const
+    {
+      cacheHits_ = 0;
+      cacheMisses_ = 0;
+      if (path->numberPaths () == 0) return path;
+      Waypoints_t waypoints;
+      Paths_t paths;
+      for (std::size_t i=0; i<path->numberPaths (); ++i) {
+	const PathPtr_t& element (path->pathAtRank (i));
+	if (i == 0) {
+	  waypoints.push_back ((*element) (element->timeRange ().first));
+	}
+	waypoints.push_back ((*element) (element->timeRange ().second));
+	paths.push_back (element);
+      }
+      Validity_t validity;
+      prune (waypoints, paths, validity, 0, paths.size ());
+      hppDout (info, "waypoints after pruning: " << waypoints.size ());
+      bool shortened = false;
+      for (std::size_t failures = 0;
+	   failures < maxFailures_ && !stopRequested ();) {
+	if (partialShortcut (waypoints, paths, validity)) {
+	  shortened = true;
+	  failures = 0;
+	} else {
+	  ++failures;
+	}
+      }
+      if (shortened) prune (waypoints, paths, validity, 0, paths.size ());
+      hppDout (info, "shortcut validity cache: " << cacheHits_ << " hits, "
+	       << cacheMisses_ << " misses");
+      PathVectorPtr_t result = PathVector::create (path->outputSize ());
+      for (std::size_t i=0; i<paths.size (); ++i) {
+	result->appendPath (paths [i]);
+      }
+      return result;
+    }
+
+    bool PartialShortcut::isValid (ConfigurationIn_t q1, ConfigurationIn_t q2,
+				   Validity_t& validity, PathPtr_t& path) const
+    {
+      path = (*problem ().steeringMethod ()) (q1, q2);
+      std::pair <Validity_t::iterator, bool> inserted =
+	validity.insert (std::make_pair (shortcutKey (q1, q2), false));
+      if (inserted.second) {
+	++cacheMisses_;
+	inserted.first->second = problem ().pathValidation ()->isValid (path);
+      } else {
+	++cacheHits_;
+      }
+      return inserted.first->second;
+    }
+
+    void PartialShortcut::prune (Waypoints_t& waypoints, Paths_t& paths,
+				 Validity_t& validity, std::size_t first,
+				 std::size_t last) const
+    {
+      Waypoints_t kept (waypoints.begin (), waypoints.begin () + first + 1);
+      Paths_t keptPaths (paths.begin (), paths.begin () + first);
+      // Path from the last waypoint kept to the current waypoint
+      PathPtr_t current = paths [first];
+      for (std::size_t i=first+1; i<last; ++i) {
+	// Waypoints from i are kept
+	if (stopRequested ()) {
+	  last = i;
+	  break;
+	}
+	PathPtr_t shortcut;
+	if (isValid (kept.back (), waypoints [i+1], validity, shortcut)) {
+	  current = shortcut;
+	} else {
+	  keptPaths.push_back (current);
+	  kept.push_back (waypoints [i]);
+	  current = paths [i];
+	}
+      }
+      keptPaths.push_back (current);
+      kept.insert (kept.end (), waypoints.begin () + last, waypoints.end ());
+      keptPaths.insert (keptPaths.end (), paths.begin () + last,
+			paths.end ());
+      waypoints.swap (kept);
+      paths.swap (keptPaths);
+    }
+
+    bool PartialShortcut::partialShortcut (Waypoints_t& waypoints,
+					   Paths_t& paths,
+					   Validity_t& validity) const
+    {
+      if (joints_.empty ()) return false;
+      const DistancePtr_t& distance (problem ().distance ());
+      // Distance along the path of each waypoint
+      std::vector <value_type> abscissa (waypoints.size (), 0);
+      for (std::size_t k=1; k<waypoints.size (); ++k) {
+	abscissa [k] = abscissa [k-1] +
+	  (*distance) (waypoints [k-1], waypoints [k]);
+      }
+      value_type u1 = generator_->uniform (0, abscissa.back ());
+      value_type u2 = generator_->uniform (0, abscissa.back ());
+      value_type s1, s2;
+      if (u1 < u2) {s1 = u1; s2 = u2;} else {s1 = u2; s2 = u1;}
+      // Shortcut from path a to path b, with waypoints a+1 to b in between
+      std::size_t a = std::upper_bound (abscissa.begin (), abscissa.end (),
+					s1) - abscissa.begin () - 1;
+      std::size_t b = std::lower_bound (abscissa.begin (), abscissa.end (),
+					s2) - abscissa.begin () - 1;
+      if (a >= b || b >= paths.size ()) return false;
+      // Subset of the joints the configuration of which is interpolated
+      std::vector <JointPtr_t> subset;
+      while (subset.empty ()) {
+	for (std::size_t k=0; k<joints_.size (); ++k) {
+	  if (generator_->index (2) == 0) subset.push_back (joints_ [k]);
+	}
+      }
+      // Parameters of the ends of the shortcut on paths a and b, assuming
+      // that the length of the paths is proportional to their time range
+      const interval_t& range1 (paths [a]->timeRange ());
+      const interval_t& range2 (paths [b]->timeRange ());
+      value_type t1 = range1.first + (range1.second - range1.first) *
+	(s1 - abscissa [a]) / (abscissa [a+1] - abscissa [a]);
+      value_type t2 = range2.first + (range2.second - range2.first) *
+	(s2 - abscissa [b]) / (abscissa [b+1] - abscissa [b]);
+      Waypoints_t candidate (b-a+2);
+      candidate.front () = (*paths [a]) (t1);
+      candidate.back () = (*paths [b]) (t2);
+      const ConstraintSetPtr_t& constraints (problem ().constraints ());
+      value_type newLength = 0;
+      for (std::size_t k=1; k<candidate.size (); ++k) {
+	if (k+1 < candidate.size ()) {
+	  candidate [k] = waypoints [a+k];
+	  value_type u = (abscissa [a+k] - s1) / (s2 - s1);
+	  for (std::size_t l=0; l<subset.size (); ++l) {
+	    subset [l]->configuration ()->interpolate
+	      (candidate.front (), candidate.back (), u,
+	       subset [l]->rankInConfiguration (), candidate [k]);
+	  }
+	  if (constraints && !constraints->apply (candidate [k])) return false;
+	}
+	newLength += (*distance) (candidate [k-1], candidate [k]);
+      }
+      if (newLength >= s2 - s1 - minGain * abscissa.back ()) return false;
+      Paths_t candidatePaths (candidate.size () - 1);
+      for (std::size_t k=0; k<candidatePaths.size (); ++k) {
+	if (!isValid (candidate [k], candidate [k+1], validity,
+		      candidatePaths [k])) return false;
+      }
+      // Parts of paths a and b out of the shortcut are kept
+      Waypoints_t newWaypoints (waypoints.begin (),
+				waypoints.begin () + a + 1);
+      newWaypoints.insert (newWaypoints.end (), candidate.begin (),
+			   candidate.end ());
+      newWaypoints.insert (newWaypoints.end (), waypoints.begin () + b + 1,
+			   waypoints.end ());
+      Paths_t newPaths (paths.begin (), paths.begin () + a);
+      newPaths.push_back (paths [a]->extract
+			  (interval_t (range1.first, t1)));
+      newPaths.insert (newPaths.end (), candidatePaths.begin (),
+		       candidatePaths.end ());
+      newPaths.push_back (paths [b]->extract
+			  (interval_t (t2, range2.second)));
+      newPaths.insert (newPaths.end (), paths.begin () + b + 1,
+		       paths.end ());
+      hppDout (info, "partial shortcut of " << subset.size ()
+	       << " joints between waypoints " << a << " and " << b + 1
+	       << ", length " << s2 - s1 << " -> " << newLength);
+      waypoints.swap (newWaypoints);
+      paths.swap (newPaths);
+      // Waypoints a and b+1 are the ends of the paths out of the shortcut
+      prune (waypoints, paths, validity, a, a + candidate.size () + 1);
+      return true;
+    }
+  } // namespace core
+} // namespace hpp
@@ -16,7 +16,15 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/nearest-neighbor-search.hh>
 #include <hpp/core/path-planner.hh>
+#include <hpp/core/path-validation.hh>
 #include <hpp/core/roadmap.hh>
 #include <hpp/core/problem.hh>
 #include "astar.hh"
@@ -26,14 +34,16 @@ namespace hpp {
 
     PathPlanner::PathPlanner (const Problem& problem) :
       problem_ (problem), roadmap_ (Roadmap::create (problem.distance (), problem.robot())),
-      interrupt_ (false)
+      interruptMutex_ (), interrupt_ (false),
+      deadline_ (std::numeric_limits <uint64_t>::max ()), maxIterations_ (0)
     {
     }
     
     PathPlanner::PathPlanner (const Problem& problem,
 			      const RoadmapPtr_t& roadmap) :
       problem_ (problem), roadmap_ (roadmap),
-      interrupt_ (false)
+      interruptMutex_ (), interrupt_ (false),
+      deadline_ (std::numeric_limits <uint64_t>::max ()), maxIterations_ (0)
     {
     }
     
@@ -50,6 +60,9 @@ namespace hpp {
     void PathPlanner::startSolve ()
     {
       problem_.checkProblem ();
+      timers_.reset ();
+      initialCounters_.reset ();
+      counters (initialCounters_);
       // Tag init and goal configurations in the roadmap
       roadmap_->resetGoalNodes ();
       roadmap_->initNode (problem_.initConfig ());
@@ -62,41 +75,149 @@ namespace hpp {
 
     PathVectorPtr_t PathPlanner::solve ()
     {
-      interrupt_ = false;
+      PathVectorPtr_t path;
+      if (solve (std::numeric_limits <value_type>::infinity (), 0, path) ==
+	  INTERRUPTED) {
+	throw std::runtime_error ("Interruption");
+      }
+      return path;
+    }
+
+    PathPlanner::Status PathPlanner::solve (value_type timeout,
+					    std::size_t maxIterations,
+					    PathVectorPtr_t& path)
+    {
+      deadline_ = std::numeric_limits <uint64_t>::max ();
+      if (timeout < std::numeric_limits <value_type>::infinity ()) {
+	deadline_ = Statistics::now () +
+	  (uint64_t) (std::max (timeout, (value_type) 0) * 1e9);
+      }
+      maxIterations_ = maxIterations;
+      path.reset ();
+      // An interruption received before the call is kept, so that it is
+      // not lost if it is sent while the resolution starts.
+      Status status;
+      try {
+	status = plan (path);
+      } catch (...) {
+	boost::mutex::scoped_lock lock (interruptMutex_);
+	interrupt_ = false;
+	throw;
+      }
+      {
+	boost::mutex::scoped_lock lock (interruptMutex_);
+	interrupt_ = false;
+      }
+      if (status != SUCCESS) path.reset ();
+      return status;
+    }
+
+    PathPlanner::Status PathPlanner::plan (PathVectorPtr_t& path)
+    {
       bool solved = false;
       startSolve ();
-      if (interrupt_) throw std::runtime_error ("Interruption");
-      while (!solved) {
+      if (interrupted ()) return INTERRUPTED;
+      for (std::size_t iterations = 0; !solved; ++iterations) {
+	Status status = checkBudget (iterations);
+	if (status != SUCCESS) return status;
 	oneStep ();
 	solved = pathExists ();
-	if (interrupt_) throw std::runtime_error ("Interruption");
+	if (interrupted ()) return INTERRUPTED;
       }
       PathVectorPtr_t planned =  computePath ();
-      return finishSolve (planned);
+      path = finishSolve (planned);
+      return SUCCESS;
+    }
+
+    PathPlanner::Status PathPlanner::checkBudget (std::size_t iterations)
+      const
+    {
+      if (maxIterations_ != 0 && iterations >= maxIterations_) {
+	return MAX_ITERATIONS;
+      }
+      if (!timeLeft ()) return TIMEOUT;
+      return SUCCESS;
+    }
+
+    bool PathPlanner::timeLeft () const
+    {
+      return !hasDeadline () || Statistics::now () < deadline_;
+    }
+
+    bool PathPlanner::hasDeadline () const
+    {
+      return deadline_ != std::numeric_limits <uint64_t>::max ();
+    }
+
+    value_type PathPlanner::remainingTime () const
+    {
+      if (!hasDeadline ()) {
+	return std::numeric_limits <value_type>::infinity ();
+      }
+      uint64_t now = Statistics::now ();
+      return now < deadline_ ? 1e-9 * (value_type) (deadline_ - now) : 0;
     }
 
     void PathPlanner::interrupt ()
     {
+      boost::mutex::scoped_lock lock (interruptMutex_);
       interrupt_ = true;
     }
 
+    bool PathPlanner::interrupted () const
+    {
+      boost::mutex::scoped_lock lock (interruptMutex_);
+      return interrupt_;
+    }
+
     bool PathPlanner::pathExists () const
     {
-      for (Nodes_t::const_iterator itGoal = roadmap_->goalNodes ().begin ();
-	   itGoal != roadmap_->goalNodes ().end (); itGoal++) {
-	if ((*itGoal)->connectedComponent () ==
-	    roadmap_->initNode ()->connectedComponent ()) {
-	  return true;
-	}
-      }
-      return false;
+      return roadmap_->pathExists ();
     }
 
     PathVectorPtr_t PathPlanner::computePath () const
     {
+      Statistics::Timer timer (timers_, Statistics::GRAPH_SEARCH);
       Astar astar (roadmap_, problem_.distance ());
       return astar.solution ();
     }
+
+    const Statistics& PathPlanner::statistics () const
+    {
+      Statistics current;
+      counters (current);
+      statistics_ = timers_;
+      for (std::size_t i = 0; i < Statistics::NB_COUNTERS; ++i) {
+	Statistics::Counter counter = (Statistics::Counter) i;
+	std::size_t initial = initialCounters_.count (counter);
+	std::size_t value = current.count (counter);
+	// Counters restart if an object is replaced meanwhile
+	statistics_.add (counter, value >= initial ? value - initial : value);
+      }
+      return statistics_;
+    }
+
+    void PathPlanner::counters (Statistics& statistics) const
+    {
+      const NearestNeighborSearchPtr_t& nearestNeighbor
+	(roadmap_->nearestNeighbor ());
+      statistics.add (Statistics::NEAREST_NEIGHBOR_VISITS,
+		      nearestNeighbor->numberVisits ());
+      statistics.add (Statistics::NEAREST_NEIGHBOR_DISTANCES,
+		      nearestNeighbor->numberDistances ());
+      const ConstraintSetPtr_t& constraints (problem_.constraints ());
+      if (constraints && constraints->configProjector ()) {
+	ConfigProjectorPtr_t configProjector (constraints->configProjector ());
+	statistics.add (Statistics::PROJECTION_ITERATIONS,
+			configProjector->numberIterations ());
+	statistics.add (Statistics::PROJECTION_FAILURES,
+			configProjector->numberFailures ());
+      }
+      if (problem_.pathValidation ()) {
+	statistics.add (Statistics::COLLISION_SAMPLES,
+			problem_.pathValidation ()->numberSamples ());
+      }
+    }
     
   } //   namespace core
 } // namespace hpp
@@ -16,34 +16,47 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <hpp/core/path-vector.hh>
+#include <hpp/core/constraint-set.hh>
 
 namespace hpp {
   namespace core {
 
+    value_type PathVector::localParameter (std::size_t rank,
+					   value_type param) const
+    {
+      value_type localParam = rank == 0 ? param : param - ends_ [rank - 1];
+      // Except for the last sub-path, param is not bigger than the end of
+      // the sub-path and the difference is a rounding error.
+      if (localParam > paths_ [rank]->length ()) {
+	localParam = paths_ [rank]->length ();
+      }
+      return localParam + paths_ [rank]->timeRange ().first;
+    }
+
     std::size_t PathVector::rankAtParam (const value_type& param,
 					 value_type& localParam) const
     {
-      std::size_t res = 0;
-      localParam = param;
-      bool finished = false;
+      assert (!paths_.empty ());
+      // First sub-path ending after param
+      std::size_t res = std::lower_bound (ends_.begin (), ends_.end () - 1,
+					  param) - ends_.begin ();
+      localParam = localParameter (res, param);
+      return res;
+    }
 
-      while (res < paths_.size () - 1 && !finished) {
-	if (localParam > paths_ [res]->length ()) {
-	  localParam -= paths_ [res]->length ();
-	  res ++;
-	}
-	else {
-	  finished = true;
-	}
-      }
-      if (localParam > paths_ [res]->length ()) {
-	if (res != paths_.size () -1) {
-	  throw std::runtime_error ("localparam out of range.");
-	}
-	localParam = paths_ [res]->timeRange ().second;
+    std::size_t PathVector::rankAtParam (const value_type& param,
+					 value_type& localParam,
+					 std::size_t hint) const
+    {
+      assert (!paths_.empty ());
+      if (hint >= paths_.size () || (hint > 0 && param <= ends_ [hint - 1])) {
+	return rankAtParam (param, localParam);
       }
-      localParam += paths_ [res]->timeRange ().first;
+      std::size_t res = hint;
+      while (res < paths_.size () - 1 && ends_ [res] < param) ++res;
+      localParam = localParameter (res, param);
       return res;
     }
 
@@ -51,15 +64,37 @@ namespace hpp {
     {
       paths_.push_back (path);
       timeRange_.second += path->length ();
+      ends_.push_back ((ends_.empty () ? 0 : ends_.back ()) + path->length ());
+    }
+
+    void PathVector::appendFlat (const PathPtr_t& path)
+    {
+      PathVectorPtr_t pathVector (HPP_DYNAMIC_PTR_CAST (PathVector, path));
+      if (!pathVector || pathVector->constraints ()) {
+	appendPath (path);
+	return;
+      }
+      for (std::size_t i=0; i<pathVector->numberPaths (); ++i) {
+	appendFlat (pathVector->pathAtRank (i));
+      }
     }
 
     void PathVector::concatenate (const PathVector& path)
     {
       for (std::size_t i=0; i<path.numberPaths (); ++i) {
-	appendPath (path.pathAtRank (i)->copy ());
-	timeRange_.second += path.pathAtRank (i)->length ();
+	appendFlat (path.pathAtRank (i)->copy ());
       }
     }
+    void PathVector::Iterator::operator () (ConfigurationOut_t result,
+					    const value_type& t)
+    {
+      value_type localParam;
+      rank_ = path_.rankAtParam (t, localParam, rank_);
+      (*path_.pathAtRank (rank_)) (result, localParam);
+      if (path_.constraints ())
+	path_.constraints ()->apply (result);
+    }
+
     void PathVector::impl_compute (ConfigurationOut_t result,
 				   value_type t) const
     {
@@ -82,7 +117,7 @@ namespace hpp {
 	value_type tmax = subInterval.first;
 	value_type localtmin, localtmax;
 	std::size_t imin = rankAtParam (tmin, localtmin);
-	std::size_t imax = rankAtParam (tmax, localtmax);
+	std::size_t imax = rankAtParam (tmax, localtmax, imin);
 	value_type t1min, t1max;
 	std::size_t i = imax;
 	do {
@@ -94,15 +129,14 @@ namespace hpp {
 	  if (i == imin) {
 	    t1max = localtmin;
 	  }
-	  path->appendPath (paths_ [i]->extract (make_pair (t1min, t1max)));
-	  --i;
-	} while (i >= imin);
+	  path->appendFlat (paths_ [i]->extract (make_pair (t1min, t1max)));
+	} while (i-- > imin);
       } else {
 	value_type tmin = subInterval.first;
 	value_type tmax = subInterval.second;
 	value_type localtmin, localtmax;
 	std::size_t imin = rankAtParam (tmin, localtmin);
-	std::size_t imax = rankAtParam (tmax, localtmax);
+	std::size_t imax = rankAtParam (tmax, localtmax, imin);
 	value_type t1min, t1max;
 	std::size_t i = imin;
 	do {
@@ -114,7 +148,7 @@ namespace hpp {
 	  if (i == imax) {
 	    t1max = localtmax;
 	  }
-	  path->appendPath (paths_ [i]->extract (make_pair (t1min, t1max)));
+	  path->appendFlat (paths_ [i]->extract (make_pair (t1min, t1max)));
 	  ++i;
 	} while (i <= imax);
       }
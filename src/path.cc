@@ -27,5 +27,35 @@ namespace hpp {
       return ExtractedPath::create (weak_.lock (), subInterval);
     }
 
+    bool Path::eval (const std::vector <value_type>& times,
+		     matrixOut_t result, std::size_t nbThreads) const
+    {
+      assert (result.cols () == (size_type) times.size ());
+      for (std::size_t i = 0; i < times.size (); ++i) {
+	impl_compute (result.col (i), times [i]);
+      }
+      if (!constraints_) return true;
+      if (warmStart_) {
+	// Warm started projections are sequential
+	bool success = true;
+	for (std::size_t i = 0; i < times.size (); ++i) {
+	  success = constraints_->apply (result.col (i), *warmStart_) &&
+	    success;
+	}
+	return success;
+      }
+      std::vector <bool> success;
+      return constraints_->applyBatch (result, success, nbThreads);
+    }
+
+    void Path::warmStart (bool warmStart)
+    {
+      if (!warmStart) {
+	warmStart_.reset ();
+      } else if (!warmStart_) {
+	warmStart_.reset (new ConfigProjector::WarmStart_t);
+      }
+    }
+
   } //   namespace core
 } // namespace hpp
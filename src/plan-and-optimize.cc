@@ -16,11 +16,35 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <boost/bind.hpp>
 #include <hpp/core/path-optimizer.hh>
+#include <hpp/core/path-vector.hh>
 #include <hpp/core/plan-and-optimize.hh>
 
 namespace hpp {
   namespace core {
+    namespace {
+      /// Set the stop condition of a path optimizer while in scope
+      struct StopConditionSetter {
+	StopConditionSetter (const PathOptimizerPtr_t& optimizer,
+			     const PathOptimizer::StopCondition_t& condition) :
+	  optimizer_ (optimizer)
+	{
+	  optimizer_->stopCondition (condition);
+	}
+	~StopConditionSetter ()
+	{
+	  optimizer_->stopCondition (PathOptimizer::StopCondition_t ());
+	}
+	const PathOptimizerPtr_t& optimizer_;
+      }; // struct StopConditionSetter
+    } // namespace
+
+    void PlanAndOptimize::startSolve ()
+    {
+      PathPlanner::startSolve ();
+      pathPlanner_->startSolve ();
+    }
 
     void PlanAndOptimize::oneStep ()
     {
@@ -29,14 +53,70 @@ namespace hpp {
 
     PathVectorPtr_t PlanAndOptimize::finishSolve (const PathVectorPtr_t& path)
     {
+      Statistics::Timer timer (timers (), Statistics::OPTIMIZATION);
       PathVectorPtr_t result = path;
-      for (Optimizers_t::iterator itOpt = optimizers_.begin ();
-	   itOpt != optimizers_.end (); itOpt++) {
-	result = (*itOpt)->optimize (result);
-      }
+      if (pathCallback_) pathCallback_ (result);
+      // Without timeout, the optimizers are applied once and each result
+      // is kept.
+      bool improved = hasDeadline ();
+      do {
+	value_type length = result->length ();
+	for (Optimizers_t::iterator itOpt = optimizers_.begin ();
+	     itOpt != optimizers_.end () && timeLeft () && !interrupted ();
+	     itOpt++) {
+	  StopConditionSetter setter
+	    (*itOpt, boost::bind (&PlanAndOptimize::stopOptimization, this));
+	  PathVectorPtr_t optimized = (*itOpt)->optimize (result);
+	  if (hasDeadline () && optimized->length () >= result->length ()) {
+	    continue;
+	  }
+	  result = optimized;
+	  if (pathCallback_) pathCallback_ (result);
+	}
+	improved = improved && result->length () < length;
+      } while (improved && timeLeft () && !interrupted ());
       return result;
     }
 
+    bool PlanAndOptimize::stopOptimization () const
+    {
+      return !timeLeft () || interrupted ();
+    }
+
+    PathPlanner::Status PlanAndOptimize::plan (PathVectorPtr_t& path)
+    {
+      // Tag init and goal nodes and reset the timers of the optimization
+      PathPlanner::startSolve ();
+      // interrupt is forwarded to the path planner, that keeps it until
+      // its resolution returns.
+      if (interrupted ()) return INTERRUPTED;
+      PathVectorPtr_t planned;
+      Status status = pathPlanner_->solve (remainingTime (), maxIterations (),
+					   planned);
+      if (status != SUCCESS) return status;
+      path = finishSolve (planned);
+      return SUCCESS;
+    }
+
+    void PlanAndOptimize::interrupt ()
+    {
+      PathPlanner::interrupt ();
+      pathPlanner_->interrupt ();
+    }
+
+    const Statistics& PlanAndOptimize::statistics () const
+    {
+      statistics_ = pathPlanner_->statistics ();
+      // Counters of the problem and of the roadmap are shared with the
+      // path planner.
+      const Statistics& own (PathPlanner::statistics ());
+      for (std::size_t i = 0; i < Statistics::NB_PHASES; ++i) {
+	Statistics::Phase phase = (Statistics::Phase) i;
+	statistics_.add (phase, own.nanoseconds (phase), own.calls (phase));
+      }
+      return statistics_;
+    }
+
     void PlanAndOptimize::addPathOptimizer
     (const PathOptimizerPtr_t& optimizer)
     {
@@ -52,7 +132,7 @@ namespace hpp {
 
     PlanAndOptimize::PlanAndOptimize (const PathPlannerPtr_t& pathPlanner) :
       PathPlanner (pathPlanner->problem (), pathPlanner->roadmap ()),
-      pathPlanner_ (pathPlanner), optimizers_ ()
+      pathPlanner_ (pathPlanner), optimizers_ (), pathCallback_ ()
     {
     }
 
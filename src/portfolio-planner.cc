@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/diffusing-planner.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/portfolio-planner.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/random-generator.hh>
+#include <hpp/core/roadmap.hh>
+
+namespace hpp {
+  namespace core {
+    PortfolioPlannerPtr_t PortfolioPlanner::create
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      PortfolioPlanner* ptr = new PortfolioPlanner (problem, roadmap);
+      return PortfolioPlannerPtr_t (ptr);
+    }
+
+    PortfolioPlanner::PortfolioPlanner (const Problem& problem,
+					const RoadmapPtr_t& roadmap) :
+      PathPlanner (problem, roadmap), builders_ (), instances_ (),
+      concurrent_ (false), winner_ (), mutex_ (), iterations_ (0), status_ (SUCCESS), error_ ()
+    {
+    }
+
+    void PortfolioPlanner::addPathPlanner (const PathPlannerBuilder_t& builder)
+    {
+      builders_.push_back (builder);
+    }
+
+    boost::shared_ptr <Problem> PortfolioPlanner::copyProblem () const
+    {
+      const Problem& p (problem ());
+      DevicePtr_t robot (p.robot ()->clone ());
+      PathValidationPtr_t pathValidation (p.pathValidation ()->clone (robot));
+      if (!pathValidation) return boost::shared_ptr <Problem> ();
+      boost::shared_ptr <Problem> copy (new Problem (robot));
+      copy->distance (p.distance ());
+      copy->steeringMethod (p.steeringMethod ());
+      copy->pathValidation (pathValidation);
+      // Instances built by the same builder would otherwise draw the same
+      // samples.
+      copy->randomGenerator (p.randomGenerator ()->split ());
+      if (p.constraints ()) copy->constraints (p.constraints ());
+      copy->initConfig (p.initConfig ());
+      for (Configurations_t::const_iterator itGoal = p.goalConfigs ().begin ();
+	   itGoal != p.goalConfigs ().end (); ++itGoal) {
+	copy->addGoalConfig (*itGoal);
+      }
+      return copy;
+    }
+
+    void PortfolioPlanner::startSolve ()
+    {
+      problem ().checkProblem ();
+      Builders_t builders (builders_);
+      if (builders.empty ()) {
+	builders.resize (std::max (boost::thread::hardware_concurrency (), 1u),
+			 DiffusingPlanner::createWithRoadmap);
+      }
+      // Only numerical constraints use the robot of the problem
+      const ConstraintSetPtr_t& constraints (problem ().constraints ());
+      concurrent_ = !(constraints && constraints->configProjector ());
+      instances_.clear ();
+      instances_.resize (builders.size ());
+      for (std::size_t i = 0; i < builders.size () && concurrent_; ++i) {
+	instances_ [i].problem = copyProblem ();
+	if (!instances_ [i].problem) concurrent_ = false;
+      }
+      for (std::size_t i = 0; i < builders.size (); ++i) {
+	Instance& instance (instances_ [i]);
+	if (!concurrent_) instance.problem.reset ();
+	const Problem& p (instance.problem ? *instance.problem : problem ());
+	instance.planner = builders [i]
+	  (p, Roadmap::create (p.distance (), p.robot ()));
+	instance.planner->startSolve ();
+      }
+      winner_.reset ();
+    }
+
+    void PortfolioPlanner::oneStep ()
+    {
+      for (Instances_t::iterator it = instances_.begin ();
+	   it != instances_.end (); ++it) {
+	it->planner->oneStep ();
+	if (it->planner->pathExists ()) {
+	  winner_ = it->planner;
+	  return;
+	}
+      }
+    }
+
+    PathPlanner::Status PortfolioPlanner::plan (PathVectorPtr_t& path)
+    {
+      {
+	boost::mutex::scoped_lock lock (mutex_);
+	iterations_ = 0;
+	status_ = SUCCESS;
+	error_.clear ();
+	startSolve ();
+      }
+      if (concurrent_) {
+	boost::thread_group threads;
+	for (std::size_t rank = 0; rank < instances_.size (); ++rank) {
+	  threads.create_thread
+	    (boost::bind (&PortfolioPlanner::run, this, rank));
+	}
+	threads.join_all ();
+      } else {
+	while (!winner_) {
+	  status_ = checkBudget (iterations_);
+	  if (status_ != SUCCESS) break;
+	  oneStep ();
+	  iterations_ += instances_.size ();
+	  if (interrupted ()) break;
+	}
+      }
+      if (interrupted ()) return INTERRUPTED;
+      if (!winner_) {
+	if (status_ != SUCCESS) return status_;
+	throw std::runtime_error (error_);
+      }
+      PathVectorPtr_t planned = winner_->finishSolve (winner_->computePath ());
+      path = finishSolve (planned);
+      return SUCCESS;
+    }
+
+    void PortfolioPlanner::run (std::size_t rank)
+    {
+      // Steps are performed here rather than by PathPlanner::plan, so
+      // that instances are stopped even if they are not yet started when
+      // the problem is solved.
+      const PathPlannerPtr_t& planner (instances_ [rank].planner);
+      try {
+	while (!planner->pathExists ()) {
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    if (winner_ || interrupted () || status_ != SUCCESS) return;
+	    status_ = checkBudget (iterations_);
+	    if (status_ != SUCCESS) return;
+	    ++iterations_;
+	  }
+	  planner->oneStep ();
+	}
+	boost::mutex::scoped_lock lock (mutex_);
+	if (!winner_) winner_ = planner;
+      } catch (const std::exception& exc) {
+	hppDout (error, "instance " << rank << ": " << exc.what ());
+	boost::mutex::scoped_lock lock (mutex_);
+	if (error_.empty ()) error_ = exc.what ();
+      }
+    }
+
+    const Statistics& PortfolioPlanner::statistics () const
+    {
+      statistics_.reset ();
+      for (Instances_t::const_iterator it = instances_.begin ();
+	   it != instances_.end (); ++it) {
+	const Statistics& instance (it->planner->statistics ());
+	if (concurrent_ || it == instances_.begin ()) {
+	  statistics_ += instance;
+	  continue;
+	}
+	// Instances share the config projector and the path validation of
+	// the problem, only their roadmaps are counted separately.
+	for (std::size_t i = 0; i < Statistics::NB_PHASES; ++i) {
+	  Statistics::Phase phase = (Statistics::Phase) i;
+	  statistics_.add (phase, instance.nanoseconds (phase),
+			   instance.calls (phase));
+	}
+	statistics_.add (Statistics::NEAREST_NEIGHBOR_VISITS,
+			 instance.count (Statistics::NEAREST_NEIGHBOR_VISITS));
+	statistics_.add (Statistics::NEAREST_NEIGHBOR_DISTANCES,
+			 instance.count
+			 (Statistics::NEAREST_NEIGHBOR_DISTANCES));
+      }
+      return statistics_;
+    }
+
+    PathVectorPtr_t PortfolioPlanner::finishSolve (const PathVectorPtr_t& path)
+    {
+      return path;
+    }
+  } // namespace core
+} // namespace hpp
@@ -16,14 +16,26 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <stdexcept>
+#include <boost/bind.hpp>
 #include <hpp/util/debug.hh>
 #include <hpp/model/collision-object.hh>
 #include <hpp/core/problem-solver.hh>
 #include <hpp/core/diffusing-planner.hh>
+#include <hpp/core/lazy-prm-planner.hh>
+#include <hpp/core/parallel-diffusing-planner.hh>
+#include <hpp/core/parallel-random-shortcut.hh>
+#include <hpp/core/partial-shortcut.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/plan-and-optimize.hh>
+#include <hpp/core/portfolio-planner.hh>
 #include <hpp/core/roadmap.hh>
+#include <hpp/core/solve-handle.hh>
 #include <hpp/core/discretized-collision-checking.hh>
 #include <hpp/core/random-shortcut.hh>
+#include <hpp/core/rrt-connect-planner.hh>
 #include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method.hh>
 #include <hpp/core/steering-method-straight.hh>
 #include <hpp/core/weighed-distance.hh>
 
@@ -32,14 +44,31 @@ namespace hpp {
     ProblemSolver::ProblemSolver () :
       robot_ (), robotChanged_ (false), problem_ (),
       initConf_ (), goalConfigurations_ (),
-      pathPlannerType_ ("DiffusingPlanner"),
-      pathOptimizerType_ ("RandomShortcut"), roadmap_ (), paths_ (),
-      pathPlannerFactory_ (), pathOptimizerFactory_ (), constraints_ (),
-      collisionObstacles_ (), distanceObstacles_ ()
+      pathPlannerType_ ("DiffusingPlanner"), portfolioPlannerTypes_ (),
+      pathOptimizerType_ ("RandomShortcut"), roadmap_ (), pathsMutex_ (),
+      paths_ (),
+      maxPaths_ (std::numeric_limits <std::size_t>::max ()),
+      maxArchivedPaths_ (std::numeric_limits <std::size_t>::max ()),
+      keepIntermediatePaths_ (true), solvePath_ (),
+      solvePathArchived_ (false), archivedPaths_ (), statistics_ (),
+      pathPlannerFactory_ (), pathOptimizerFactory_ (),
+      constraints_ (), collisionObstacles_ (), distanceObstacles_ (),
+      obstacleMap_ (), obstaclesChanged_ (false)
     {
       pathOptimizerFactory_ ["RandomShortcut"] = RandomShortcut::create;
+      pathOptimizerFactory_ ["ParallelRandomShortcut"] =
+	boost::bind (ParallelRandomShortcut::create, _1, 0);
+      pathOptimizerFactory_ ["PartialShortcut"] = PartialShortcut::create;
       pathPlannerFactory_ ["DiffusingPlanner"] =
 	DiffusingPlanner::createWithRoadmap;
+      pathPlannerFactory_ ["ParallelDiffusingPlanner"] =
+	boost::bind (ParallelDiffusingPlanner::createWithRoadmap, _1, _2, 0);
+      pathPlannerFactory_ ["LazyPrmPlanner"] =
+	LazyPrmPlanner::createWithRoadmap;
+      pathPlannerFactory_ ["RrtConnectPlanner"] =
+	RrtConnectPlanner::createWithRoadmap;
+      pathPlannerFactory_ ["PortfolioPlanner"] =
+	boost::bind (&ProblemSolver::createPortfolioPlanner, this, _1, _2);
     }
 
     ProblemSolver::~ProblemSolver ()
@@ -52,6 +81,28 @@ namespace hpp {
       pathPlannerType_ = type;
     }
 
+    void ProblemSolver::addPortfolioPlannerType (const std::string& type)
+    {
+      if (pathPlannerFactory_.find (type) == pathPlannerFactory_.end () ||
+	  type == "PortfolioPlanner") {
+	throw std::runtime_error ("Invalid portfolio path planner type " + type);
+      }
+      portfolioPlannerTypes_.push_back (type);
+    }
+
+    PathPlannerPtr_t ProblemSolver::createPortfolioPlanner
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      PortfolioPlannerPtr_t planner (PortfolioPlanner::create (problem,
+							       roadmap));
+      for (std::vector <std::string>::const_iterator itType =
+	     portfolioPlannerTypes_.begin ();
+	   itType != portfolioPlannerTypes_.end (); ++itType) {
+	planner->addPathPlanner (pathPlannerFactory_ [*itType]);
+      }
+      return planner;
+    }
+
     void ProblemSolver::pathOptimizerType (const std::string& type)
     {
       pathOptimizerType_ = type;
@@ -110,10 +161,34 @@ namespace hpp {
       problem_ = new Problem (robot_);
       roadmap_ = Roadmap::create (problem_->distance (), problem_->robot());
       problem_->constraints ();
+      robotChanged_ = false;
+      obstaclesChanged_ = false;
     }
 
-    void ProblemSolver::solve ()
+    void ProblemSolver::saveRoadmap (const std::string& filename) const
+    {
+      if (!roadmap_) {
+	throw std::runtime_error ("No roadmap to save.");
+      }
+      roadmap_->save (filename);
+    }
+
+    void ProblemSolver::loadRoadmap (const std::string& filename)
+    {
+      if (robotChanged_ || !problem_) {
+	resetProblem ();
+      }
+      problem_->constraints (constraints_);
+      roadmap_->load (filename, problem_->steeringMethod ());
+    }
+
+    void ProblemSolver::initializeSolve ()
     {
+      {
+	boost::mutex::scoped_lock lock (pathsMutex_);
+	solvePath_.reset ();
+	solvePathArchived_ = false;
+      }
       if (robotChanged_) {
 	/// If robot has changed since last call, reset problem and roadmap
 	resetProblem ();
@@ -131,6 +206,11 @@ namespace hpp {
 	pathOptimizerFactory_ [pathOptimizerType_];
       pathOptimizer_ = createOptimizer (*problem_);
       robotChanged_ = false;
+      if (obstaclesChanged_) {
+	// Keep the roadmap built before the obstacles were added
+	roadmap_->revalidateEdges (problem_->pathValidation ());
+	obstaclesChanged_ = false;
+      }
       // Reset init and goal configurations
       problem_->initConfig (initConf_);
       problem_->resetGoalConfigs ();
@@ -139,18 +219,156 @@ namespace hpp {
 	   itConfig != goalConfigurations_.end (); itConfig++) {
 	problem_->addGoalConfig (*itConfig);
       }
+    }
+
+    void ProblemSolver::solve ()
+    {
+      initializeSolve ();
       PathVectorPtr_t path = pathPlanner_->solve ();
+      addSolvePath (path);
+      Statistics optimization;
+      {
+	Statistics::Timer timer (optimization, Statistics::OPTIMIZATION);
+	path = pathOptimizer_->optimize (path);
+      }
+      addSolvePath (path);
+      statistics_ = pathPlanner_->statistics ();
+      statistics_ += optimization;
+    }
+
+    PathPlanner::Status ProblemSolver::solve (value_type timeout,
+					      std::size_t maxIterations)
+    {
+      initializeSolve ();
+      PlanAndOptimizePtr_t planner (PlanAndOptimize::create (pathPlanner_));
+      planner->addPathOptimizer (pathOptimizer_);
+      planner->pathCallback (boost::bind (&ProblemSolver::addSolvePath, this,
+					  _1));
+      pathPlanner_ = planner;
+      PathVectorPtr_t path;
+      PathPlanner::Status status = planner->solve (timeout, maxIterations,
+						   path);
+      statistics_ = planner->statistics ();
+      return status;
+    }
+
+    void ProblemSolver::addPath (const PathVectorPtr_t& path)
+    {
+      boost::mutex::scoped_lock lock (pathsMutex_);
       paths_.push_back (path);
-      path = pathOptimizer_->optimize (path);
+      archivePaths ();
+    }
+
+    void ProblemSolver::addSolvePath (const PathVectorPtr_t& path)
+    {
+      boost::mutex::scoped_lock lock (pathsMutex_);
+      if (solvePath_ && !keepIntermediatePaths_) {
+	// The previous path of the call is replaced, even if it has already
+	// been archived.
+	if (!paths_.empty () && paths_.back () == solvePath_) {
+	  paths_.pop_back ();
+	} else if (solvePathArchived_) {
+	  archivedPaths_.pop_back ();
+	}
+      }
+      solvePath_ = path;
+      solvePathArchived_ = false;
       paths_.push_back (path);
+      archivePaths ();
+    }
+
+    PathVectors_t ProblemSolver::paths () const
+    {
+      boost::mutex::scoped_lock lock (pathsMutex_);
+      return paths_;
+    }
+
+    void ProblemSolver::maxPaths (std::size_t nbPaths)
+    {
+      boost::mutex::scoped_lock lock (pathsMutex_);
+      maxPaths_ = nbPaths;
+      archivePaths ();
+    }
+
+    void ProblemSolver::maxArchivedPaths (std::size_t nbPaths)
+    {
+      boost::mutex::scoped_lock lock (pathsMutex_);
+      maxArchivedPaths_ = nbPaths;
+      archivePaths ();
+    }
+
+    std::size_t ProblemSolver::numberArchivedPaths () const
+    {
+      boost::mutex::scoped_lock lock (pathsMutex_);
+      return archivedPaths_.size ();
+    }
+
+    void ProblemSolver::archivePaths ()
+    {
+      std::size_t nbArchived = paths_.size () > maxPaths_ ?
+	paths_.size () - maxPaths_ : 0;
+      for (std::size_t i = 0; i < nbArchived; ++i) {
+	const PathVectorPtr_t& path = paths_ [i];
+	std::size_t nbPaths = path->numberPaths ();
+	matrix_t waypoints (path->outputSize (), nbPaths == 0 ? 0 :
+			    nbPaths + 1);
+	for (std::size_t j = 0; j < nbPaths; ++j) {
+	  const PathPtr_t& subpath = path->pathAtRank (j);
+	  (*subpath) (waypoints.col (j), subpath->timeRange ().first);
+	  if (j + 1 == nbPaths) {
+	    (*subpath) (waypoints.col (j + 1), subpath->timeRange ().second);
+	  }
+	}
+	archivedPaths_.push_back (matrix_t ());
+	archivedPaths_.back ().swap (waypoints);
+	solvePathArchived_ = (path == solvePath_);
+      }
+      paths_.erase (paths_.begin (), paths_.begin () + nbArchived);
+      while (archivedPaths_.size () > maxArchivedPaths_) {
+	archivedPaths_.pop_front ();
+      }
+      if (archivedPaths_.empty ()) solvePathArchived_ = false;
+    }
+
+    PathVectorPtr_t ProblemSolver::archivedPath (std::size_t rank) const
+    {
+      if (!problem_) {
+	throw std::runtime_error ("No problem to rebuild archived path.");
+      }
+      matrix_t waypoints;
+      {
+	boost::mutex::scoped_lock lock (pathsMutex_);
+	waypoints = archivedPaths_.at (rank);
+      }
+      const SteeringMethod& steeringMethod = *(problem_->steeringMethod ());
+      PathVectorPtr_t path = PathVector::create (waypoints.rows ());
+      for (size_type i = 0; i + 1 < waypoints.cols (); ++i) {
+	path->appendPath (steeringMethod (waypoints.col (i),
+					  waypoints.col (i + 1)));
+      }
+      return path;
+    }
+
+    SolveHandlePtr_t ProblemSolver::solveAsync (value_type timeout,
+						std::size_t maxIterations)
+    {
+      initializeSolve ();
+      PlanAndOptimizePtr_t planner (PlanAndOptimize::create (pathPlanner_));
+      planner->addPathOptimizer (pathOptimizer_);
+      pathPlanner_ = planner;
+      return SolveHandle::create
+	(planner, timeout, maxIterations,
+	 boost::bind (&ProblemSolver::addSolvePath, this, _1));
     }
 
     void ProblemSolver::addObstacle (const CollisionObjectPtr_t& object,
 				     bool collision, bool distance)
     {
       
-      if (collision)
+      if (collision) {
 	collisionObstacles_.push_back (object);
+	obstaclesChanged_ = true;
+      }
       if (distance)
 	distanceObstacles_.push_back (object);
       if (problem ())
@@ -21,6 +21,7 @@
 #include <hpp/util/debug.hh>
 #include <hpp/model/device.hh>
 #include <hpp/core/problem.hh>
+#include <hpp/core/random-generator.hh>
 #include <hpp/core/steering-method-straight.hh>
 #include <hpp/core/weighed-distance.hh>
 #include <hpp/core/discretized-collision-checking.hh>
@@ -38,7 +39,8 @@ namespace hpp {
       initConf_ (), goalConfigurations_ (),
       steeringMethod_ (new core::SteeringMethodStraight (robot)),
       pathValidation_ (DiscretizedCollisionChecking ::create (robot, 5e-2)),
-      collisionObstacles_ (), distanceObstacles_ (), constraints_ ()
+      collisionObstacles_ (), distanceObstacles_ (), constraints_ (),
+      randomGenerator_ (RandomGenerator::create ())
     {
     }
 
@@ -100,6 +102,7 @@ namespace hpp {
 	robot_->removeOuterObject (*itObj, true, false);
       }
       collisionObstacles_.clear ();
+      if (pathValidation_) pathValidation_->obstaclesChanged ();
       // pass the local vector of collisions object to the problem
       for (ObjectVector_t::const_iterator itObj = collisionObstacles.begin();
 	   itObj != collisionObstacles.end(); ++itObj) {
@@ -137,6 +140,7 @@ namespace hpp {
 	distanceObstacles_.push_back (object);
       // Add obstacle to robot
       robot_->addOuterObject (object, collision, distance);
+      if (collision && pathValidation_) pathValidation_->obstaclesChanged ();
     }
 
     // ======================================================================
@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <cmath>
+#include <hpp/core/random-generator.hh>
+
+namespace hpp {
+  namespace core {
+    const unsigned int RandomGenerator::defaultSeed = 5489u;
+
+    RandomGeneratorPtr_t RandomGenerator::create (unsigned int seed)
+    {
+      RandomGenerator* ptr = new RandomGenerator (seed);
+      return RandomGeneratorPtr_t (ptr);
+    }
+
+    RandomGenerator::RandomGenerator (unsigned int seed) :
+      engine_ (seed), seed_ (seed)
+    {
+    }
+
+    void RandomGenerator::seed (unsigned int seed)
+    {
+      engine_.seed (seed);
+      seed_ = seed;
+    }
+
+    std::size_t RandomGenerator::index (std::size_t n)
+    {
+      std::size_t res = (std::size_t) (uniform () * n);
+      // Rounding may give n for very big n
+      return res < n ? res : n - 1;
+    }
+
+    value_type RandomGenerator::normal ()
+    {
+      // Box-Muller transform, 1 - uniform () is in (0, 1]
+      value_type u1 = 1 - uniform ();
+      value_type u2 = uniform ();
+      return sqrt (-2 * log (u1)) * cos (2 * M_PI * u2);
+    }
+
+    RandomGeneratorPtr_t RandomGenerator::split ()
+    {
+      return create (engine_ ());
+    }
+  } //   namespace core
+} // namespace hpp
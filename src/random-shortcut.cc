@@ -18,22 +18,20 @@
 
 #include <limits>
 #include <deque>
-#include <cstdlib>
 #include <hpp/util/assertion.hh>
 #include <hpp/util/debug.hh>
 #include <hpp/core/distance.hh>
 #include <hpp/core/path-validation.hh>
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/problem.hh>
+#include <hpp/core/random-generator.hh>
 #include <hpp/core/random-shortcut.hh>
 #include <hpp/core/steering-method.hh>
 
 namespace hpp {
   namespace core {
-    // Compute the length of a vector of paths assuming that each element
-    // is optimal for the given distance.
-    static value_type pathLength (const PathVectorPtr_t& path,
-				  const DistancePtr_t& distance)
+    value_type RandomShortcut::pathLength (const PathVectorPtr_t& path,
+					   const DistancePtr_t& distance)
     {
       value_type result = 0;
       for (std::size_t i=0; i<path->numberPaths (); ++i) {
@@ -47,6 +45,22 @@ namespace hpp {
       return result;
     }
 
+    std::vector <value_type> RandomShortcut::shortcutKey (ConfigurationIn_t q1,
+							  ConfigurationIn_t q2)
+    {
+      std::vector <value_type> key (q1.size () + q2.size ());
+      Eigen::Map <vector_t> (&key [0], q1.size ()) = q1;
+      Eigen::Map <vector_t> (&key [q1.size ()], q2.size ()) = q2;
+      return key;
+    }
+
+    bool RandomShortcut::sameElement (const PathVectorPtr_t& path,
+				      value_type t1, value_type t2)
+    {
+      value_type local;
+      return path->rankAtParam (t1, local) == path->rankAtParam (t2, local);
+    }
+
     RandomShortcutPtr_t
     RandomShortcut::create (const Problem& problem)
     {
@@ -55,7 +69,9 @@ namespace hpp {
     }
 
     RandomShortcut::RandomShortcut (const Problem& problem) :
-      PathOptimizer (problem)
+      PathOptimizer (problem),
+      generator_ (problem.randomGenerator ()->split ()),
+      cacheHits_ (0), cacheMisses_ (0)
     {
     }
 
@@ -75,27 +91,47 @@ namespace hpp {
 				      numeric_limits <value_type>::infinity ());
       length.push_back (pathLength (tmpPath, problem ().distance ()));
       PathVectorPtr_t result;
+      Validity_t validity;
+      cacheHits_ = 0;
+      cacheMisses_ = 0;
+      Configuration_t q1 (path->outputSize ()), q2 (path->outputSize ());
 
-      while (!finished) {
+      while (!finished && !stopRequested ()) {
 	t3 = tmpPath->timeRange ().second;
-	value_type u2 = t3 * rand ()/RAND_MAX;
-	value_type u1 = t3 * rand ()/RAND_MAX;
+	value_type u2 = generator_->uniform (0, t3);
+	value_type u1 = generator_->uniform (0, t3);
 	value_type t1, t2;
 	if (u1 < u2) {t1 = u1; t2 = u2;} else {t1 = u2; t2 = u1;}
-	Configuration_t q1 = (*tmpPath) (t1);
-	Configuration_t q2 = (*tmpPath) (t2);
+	(*tmpPath) (q1, t1);
+	(*tmpPath) (q2, t2);
 	// Validate sub parts
 	bool valid [3];
 	PathPtr_t straight [3];
 	const SteeringMethodPtr_t& steeringMethod
 	  (problem ().steeringMethod ());
-	straight [0] = (*steeringMethod) (q0, q1);
-	straight [1] = (*steeringMethod) (q1, q2);
-	straight [2] = (*steeringMethod) (q2, q3);
+	const value_type t [4] = {0, t1, t2, t3};
+	const Configuration_t* q [4] = {&q0, &q1, &q2, &q3};
+	// Only validity matters here: shortcuts in collision are rejected.
 	for (unsigned i=0; i<3; ++i) {
-	  PathPtr_t validPart;
-	  valid [i] = problem ().pathValidation ()->validate
-	    (straight [i], false, validPart);
+	  if (sameElement (tmpPath, t [i], t [i+1])) {
+	    // The part of the element is kept as it is: a new path from the
+	    // steering method may differ from the element and is not checked.
+	    ++cacheHits_;
+	    valid [i] = false;
+	    continue;
+	  }
+	  straight [i] = (*steeringMethod) (*q [i], *q [i+1]);
+	  std::pair <Validity_t::iterator, bool> inserted =
+	    validity.insert (std::make_pair (shortcutKey (*q [i], *q [i+1]),
+					     false));
+	  if (inserted.second) {
+	    ++cacheMisses_;
+	    inserted.first->second =
+	      problem ().pathValidation ()->isValid (straight [i]);
+	  } else {
+	    ++cacheHits_;
+	  }
+	  valid [i] = inserted.first->second;
 	}
 	// Replace valid parts
 	result = PathVector::create (path->outputSize ());
@@ -123,7 +159,9 @@ namespace hpp {
 	hppDout (info, "length = " << length [n-1]);
 	tmpPath = result;
       }
-      return result;
+      hppDout (info, "shortcut validity cache: " << cacheHits_ << " hits, "
+	       << cacheMisses_ << " misses");
+      return tmpPath;
     }
 
   } // namespace core
@@ -17,12 +17,25 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
 #include <hpp/core/connected-component.hh>
 #include <hpp/core/edge.hh>
 #include <hpp/core/node.hh>
 #include <hpp/core/path.hh>
+#include <hpp/core/path-validation.hh>
 #include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method.hh>
+#include <hpp/core/straight-path.hh>
 #include "nearest-neighbor.hh"
 #include <hpp/core/k-d-tree.hh>
 
@@ -38,6 +51,65 @@ namespace hpp {
       return oss.str ();
     }
 
+    namespace {
+      /// \name Roadmap file format
+      ///
+      /// Header, then configurations of the nodes (configSize doubles per
+      /// node), connected component index of each node and edges. Numbers
+      /// are stored in the byte order of the machine.
+      /// \{
+      const char roadmapMagic [8] = {'H', 'P', 'P', 'R', 'M', 'A', 'P', '\0'};
+      const uint32_t roadmapVersion = 1;
+
+      struct RoadmapHeader {
+	char magic [8];
+	uint32_t version;
+	uint32_t configSize;
+	uint64_t nbNodes;
+	uint64_t nbComponents;
+	uint64_t nbEdges;
+      };
+
+      struct EdgeRecord {
+	uint32_t from;
+	uint32_t to;
+	uint32_t status;
+      };
+      /// \}
+
+      /// Read-only memory mapping of a file, unmapped at destruction
+      struct MappedFile {
+	MappedFile (const std::string& filename) : data (0), size (0)
+	{
+	  int fd = open (filename.c_str (), O_RDONLY);
+	  if (fd < 0) {
+	    throw std::runtime_error ("Cannot open roadmap file " + filename);
+	  }
+	  struct stat st;
+	  if (fstat (fd, &st) != 0) {
+	    close (fd);
+	    throw std::runtime_error ("Cannot read roadmap file " + filename);
+	  }
+	  size = st.st_size;
+	  if (size > 0) {
+	    void* ptr = mmap (0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	    if (ptr == MAP_FAILED) {
+	      close (fd);
+	      throw std::runtime_error ("Cannot map roadmap file " + filename);
+	    }
+	    data = static_cast <const char*> (ptr);
+	  }
+	  close (fd);
+	}
+	~MappedFile ()
+	{
+	  if (data) munmap (const_cast <char*> (data), size);
+	}
+	const char* data;
+	std::size_t size;
+      }; // struct MappedFile
+    } // namespace
+
     RoadmapPtr_t Roadmap::create (const DistancePtr_t& distance, const DevicePtr_t& robot)
     {
       Roadmap* ptr = new Roadmap (distance, robot);
@@ -45,10 +117,11 @@ namespace hpp {
     }
 
     Roadmap::Roadmap (const DistancePtr_t& distance, const DevicePtr_t& robot) :
-      distance_ (distance), connectedComponents_ (), nodes_ (), edges_ (),
-      initNode_ (), goalNodes_ (),
-      //nearestNeighbor_ (),
-      kdTree_(robot, distance, 30)
+      distance_ (distance), robot_ (robot), nodePool_ (new NodePool_t),
+      edgePool_ (new EdgePool_t), connectedComponents_ (), nodes_ (), edges_ (),
+      initNode_ (), goalNodes_ (), goalRevision_ (1),
+      nearestNeighbor_ (new KDTree (robot, distance, 30)),
+      nearestNeighborOutdated_ (false)
     {
     }
 
@@ -59,38 +132,48 @@ namespace hpp {
 
     void Roadmap::clear ()
     {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
       connectedComponents_.clear ();
 
-      for (Nodes_t::iterator it = nodes_.begin (); it != nodes_.end (); it++) {
-	delete *it;
-      }
+      // Destroy nodes and edges and release memory by chunks
       nodes_.clear ();
-
-      for (Edges_t::iterator it = edges_.begin (); it != edges_.end (); it++) {
-	delete *it;
-      }
+      nodePool_.reset (new NodePool_t);
       edges_.clear ();
+      edgePool_.reset (new EdgePool_t);
 
       goalNodes_.clear ();
+      ++goalRevision_;
       initNode_ = 0x0;
-      //nearestNeighbor_.clear ();
-      kdTree_.clear();
+      nearestNeighbor_->clear ();
+      nearestNeighborOutdated_ = false;
     }
 
-    NodePtr_t Roadmap::addNode (const ConfigurationPtr_t& configuration)
+    NodePtr_t Roadmap::findDuplicate (const ConfigurationPtr_t& configuration,
+				      const ConnectedComponentPtr_t&
+				      connectedComponent)
     {
+      if (nodes_.empty ()) return 0x0;
       value_type distance;
-      if (nodes_.size () != 0) {
-	NodePtr_t nearest = nearestNode (configuration, distance);
-	if (*(nearest->configuration ()) == *configuration) {
-	  return nearest;
-	}
-	if (distance < 1e-4) {
-	  throw std::runtime_error ("distance to nearest node too small");
-	}
+      NodePtr_t nearest = nearestNeighbor ()->nearestWithinRadius
+	(configuration, connectedComponent, 1e-4, distance);
+      if (nearest && *(nearest->configuration ()) != *configuration) {
+	throw std::runtime_error ("distance to nearest node too small");
+      }
+      return nearest;
+    }
+
+    NodePtr_t Roadmap::addNode (const ConfigurationPtr_t& configuration,
+				bool checkDuplicate)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      if (checkDuplicate) {
+	NodePtr_t duplicate = findDuplicate (configuration,
+					     ConnectedComponentPtr_t ());
+	if (duplicate) return duplicate;
       }
-      NodePtr_t node = new Node (configuration);
+      NodePtr_t node = nodePool_->construct (configuration);
       hppDout (info, "Added node: " << displayConfig (*configuration));
+      node->index (nodes_.size ());
       nodes_.push_back (node);
       // Node constructor creates a new connected component. This new
       // connected component needs to be added in the roadmap and the
@@ -100,40 +183,37 @@ namespace hpp {
     }
 
     NodePtr_t Roadmap::addNode (const ConfigurationPtr_t& configuration,
-				ConnectedComponentPtr_t connectedComponent)
+				ConnectedComponentPtr_t connectedComponent,
+				bool checkDuplicate)
     {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
       assert (connectedComponent);
-      value_type distance;
-      if (nodes_.size () != 0) {
-	NodePtr_t nearest = nearestNode (configuration, connectedComponent,
-					 distance);
-	if (*(nearest->configuration ()) == *configuration) {
-	  return nearest;
-	}
-	if (distance < 1e-4) {
-	  throw std::runtime_error ("distance to nearest node too small");
-	}
+      if (checkDuplicate) {
+	NodePtr_t duplicate = findDuplicate (configuration,
+					     connectedComponent);
+	if (duplicate) return duplicate;
       }
-      NodePtr_t node = new Node (configuration, connectedComponent);
+      NodePtr_t node = nodePool_->construct (configuration,
+						 connectedComponent);
       hppDout (info, "Added node: " << displayConfig (*configuration));
+      node->index (nodes_.size ());
       nodes_.push_back (node);
       // The new node needs to be registered in the connected
       // component.
       connectedComponent->addNode (node);
-	//nearestNeighbor_ [connectedComponent]->add (node);
-	kdTree_.addNode(node);
+      nearestNeighbor ()->addNode (node);
       return node;
     }
 
     NodePtr_t Roadmap::addNodeAndEdge (const NodePtr_t from,
 				       const ConfigurationPtr_t& to,
-				       const PathPtr_t path)
+				       const PathPtr_t path,
+				       bool checkDuplicate)
     {
-      interval_t timeRange = path->timeRange ();
-      NodePtr_t nodeTo = addNode (to, from->connectedComponent ());
-      addEdge (from, nodeTo, path);
-      addEdge (nodeTo, from, path->extract
-	       (interval_t (timeRange.second, timeRange.first)));
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      NodePtr_t nodeTo = addNode (to, from->connectedComponent (),
+				  checkDuplicate);
+      addEdges (from, nodeTo, path);
       return nodeTo;
     }
 
@@ -141,21 +221,18 @@ namespace hpp {
     Roadmap::nearestNode (const ConfigurationPtr_t& configuration,
 			  value_type& minDistance)
     {
-	NodePtr_t closest;
-	minDistance = std::numeric_limits<value_type>::infinity ();
-	for (ConnectedComponents_t::const_iterator itcc =
-	       connectedComponents_.begin ();
-	     itcc != connectedComponents_.end (); itcc++) {
-	  value_type distance;
-	  NodePtr_t node;
-	  //node = nearestNeighbor_ [*itcc]->nearest (configuration, distance);
-	  node = kdTree_.search(configuration, *itcc, distance);
-	  if (distance < minDistance) {
-	    minDistance = distance;
-	    closest = node;
-	  }
-
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      NodePtr_t closest = 0x0;
+      NearestNodes_t nearest;
+      minDistance = std::numeric_limits<value_type>::infinity ();
+      nearestNodes (configuration, nearest);
+      for (NearestNodes_t::const_iterator itNearest = nearest.begin ();
+	   itNearest != nearest.end (); itNearest++) {
+	if (itNearest->second.second < minDistance) {
+	  minDistance = itNearest->second.second;
+	  closest = itNearest->second.first;
 	}
+      }
       return closest;
     }
 
@@ -164,16 +241,58 @@ namespace hpp {
 			  const ConnectedComponentPtr_t& connectedComponent,
 			  value_type& minDistance)
     {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      assert (connectedComponent);
+      return nearestNeighbor ()->search (configuration, connectedComponent,
+				       minDistance);
+    }
+
+    void Roadmap::nearestNodes (const ConfigurationPtr_t& configuration,
+				NearestNodes_t& nearest)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      nearestNeighbor ()->search (configuration, connectedComponents_, nearest);
+    }
+
+    void Roadmap::nearestNodes (const ConfigurationPtr_t& configuration,
+				const ConnectedComponentPtr_t&
+				connectedComponent,
+				std::size_t k, Nodes_t& nodes)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      nearestNeighbor ()->kNearest (configuration, connectedComponent, k, nodes);
+    }
+
+    void Roadmap::nodesWithinBall (const ConfigurationPtr_t& configuration,
+				   const ConnectedComponentPtr_t&
+				   connectedComponent,
+				   value_type radius, Nodes_t& nodes)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
       assert (connectedComponent);
-      //return nearestNeighbor_ [connectedComponent]->nearest (configuration,
-	//						     minDistance);
-      return kdTree_.search(configuration, connectedComponent, minDistance);
+      nearestNeighbor ()->withinRadius (configuration, connectedComponent,
+				      radius, nodes);
     }
 
     void Roadmap::addGoalNode (const ConfigurationPtr_t& config)
     {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
       NodePtr_t node = addNode (config);
       goalNodes_.push_back (node);
+      ++goalRevision_;
+    }
+
+    bool Roadmap::pathExists () const
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      const ConnectedComponentPtr_t cc (initNode_->connectedComponent ());
+      for (Nodes_t::const_iterator itGoal = goalNodes_.begin ();
+	   itGoal != goalNodes_.end (); itGoal++) {
+	if ((*itGoal)->connectedComponent () == cc) {
+	  return true;
+	}
+      }
+      return false;
     }
 
     const DistancePtr_t& Roadmap::distance () const
@@ -184,7 +303,8 @@ namespace hpp {
     EdgePtr_t Roadmap::addEdge (const NodePtr_t& n1, const NodePtr_t& n2,
 				const PathPtr_t& path)
     {
-      EdgePtr_t edge = new Edge (n1, n2, path);
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      EdgePtr_t edge = edgePool_->construct (n1, n2, path);
       n1->addOutEdge (edge);
       n2->addInEdge (edge);
       edges_.push_back (edge);
@@ -192,13 +312,186 @@ namespace hpp {
 	       displayConfig (*(n1->configuration ())));
       hppDout (info, "               and: " <<
 	       displayConfig (*(n2->configuration ())));
+      merge (edge);
+      return edge;
+    }
+
+    EdgePtr_t Roadmap::addEdges (const NodePtr_t& n1, const NodePtr_t& n2,
+				 const PathPtr_t& path)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      EdgePtr_t edge = addEdge (n1, n2, path);
+      EdgePtr_t reverse = edgePool_->construct (edge);
+      n2->addOutEdge (reverse);
+      n1->addInEdge (reverse);
+      edges_.push_back (reverse);
+      return edge;
+    }
+
+    EdgePtr_t Roadmap::addLazyEdge (const NodePtr_t& n1, const NodePtr_t& n2,
+				    const PathPtr_t& path)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      EdgePtr_t edge = edgePool_->construct (n1, n2, path);
+      edge->status (Edge::UNKNOWN);
+      n1->addOutEdge (edge);
+      n2->addInEdge (edge);
+      edges_.push_back (edge);
+      return edge;
+    }
+
+    EdgePtr_t Roadmap::addLazyEdges (const NodePtr_t& n1, const NodePtr_t& n2,
+				     const PathPtr_t& path)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      EdgePtr_t edge = addLazyEdge (n1, n2, path);
+      EdgePtr_t reverse = edgePool_->construct (edge);
+      n2->addOutEdge (reverse);
+      n1->addInEdge (reverse);
+      edges_.push_back (reverse);
+      return edge;
+    }
+
+    void Roadmap::edgeStatus (const EdgePtr_t& edge, Edge::Status status)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      edge->status (status);
+      if (status == Edge::VALID) merge (edge);
+    }
+
+    std::size_t Roadmap::revalidateEdges
+    (const PathValidationPtr_t& validation)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      // Path validation does not check the beginning of paths: nodes are
+      // checked as paths of length 0.
+      std::vector <bool> colliding (nodes_.size (), false);
+      std::size_t nbColliding = 0;
+      for (Nodes_t::const_iterator itNode = nodes_.begin ();
+	   itNode != nodes_.end (); ++itNode) {
+	const Configuration_t& q (*(*itNode)->configuration ());
+	if (!validation->isValid (StraightPath::create (robot_, q, q, 0))) {
+	  colliding [(*itNode)->index ()] = true;
+	  ++nbColliding;
+	}
+      }
+      hppDout (info, nbColliding << " nodes removed");
+      std::size_t nbInvalid = 0;
+      if (nbColliding > 0) nbInvalid = removeNodes (colliding);
+      for (Edges_t::const_iterator itEdge = edges_.begin ();
+	   itEdge != edges_.end (); ++itEdge) {
+	const EdgePtr_t& edge (*itEdge);
+	if (edge->status () != Edge::VALID) continue;
+	NodePtr_t from = edge->from (), to = edge->to ();
+	EdgePtr_t reverse = 0x0;
+	for (Node::Edges_t::const_iterator itOut = to->outEdges ().begin ();
+	     itOut != to->outEdges ().end (); ++itOut) {
+	  if ((*itOut)->to () == from) {
+	    reverse = *itOut;
+	    break;
+	  }
+	}
+	// Pairs of edges are checked when visiting the edge that starts
+	// from the node of lower index.
+	if (reverse && reverse->status () == Edge::VALID &&
+	    from->index () > to->index ()) continue;
+	if (!validation->isValid (edge->path ())) {
+	  edge->status (Edge::INVALID);
+	  ++nbInvalid;
+	  if (reverse && reverse->status () == Edge::VALID) {
+	    reverse->status (Edge::INVALID);
+	    ++nbInvalid;
+	  }
+	}
+      }
+      hppDout (info, nbInvalid << " edges invalidated");
+      if (nbInvalid > 0 || nbColliding > 0) updateConnectedComponents ();
+      return nbInvalid;
+    }
+
+    std::size_t Roadmap::removeNodes (const std::vector <bool>& removed)
+    {
+      std::size_t nbValid = 0;
+      for (Edges_t::iterator itEdge = edges_.begin ();
+	   itEdge != edges_.end ();) {
+	const EdgePtr_t edge (*itEdge);
+	bool fromRemoved = removed [edge->from ()->index ()];
+	bool toRemoved = removed [edge->to ()->index ()];
+	if (!fromRemoved && !toRemoved) {
+	  ++itEdge;
+	  continue;
+	}
+	if (edge->status () == Edge::VALID) ++nbValid;
+	if (!fromRemoved) edge->from ()->removeOutEdge (edge);
+	if (!toRemoved) edge->to ()->removeInEdge (edge);
+	itEdge = edges_.erase (itEdge);
+      }
+      for (Nodes_t::iterator itGoal = goalNodes_.begin ();
+	   itGoal != goalNodes_.end ();) {
+	if (removed [(*itGoal)->index ()]) {
+	  itGoal = goalNodes_.erase (itGoal);
+	} else {
+	  ++itGoal;
+	}
+      }
+      if (initNode_ && removed [initNode_->index ()]) initNode_ = 0x0;
+      std::size_t index = 0;
+      for (Nodes_t::iterator itNode = nodes_.begin ();
+	   itNode != nodes_.end ();) {
+	if (removed [(*itNode)->index ()]) {
+	  itNode = nodes_.erase (itNode);
+	} else {
+	  (*itNode)->index (index++);
+	  ++itNode;
+	}
+      }
+      ++goalRevision_;
+      return nbValid;
+    }
+
+    void Roadmap::updateConnectedComponents ()
+    {
+      // Components are stored by the nearest neighbor data structure: it is
+      // emptied and filled again at the next request.
+      nearestNeighbor_->clear ();
+      nearestNeighborOutdated_ = !nodes_.empty ();
+      connectedComponents_.clear ();
+      for (Nodes_t::const_iterator itNode = nodes_.begin ();
+	   itNode != nodes_.end (); ++itNode) {
+	ConnectedComponentPtr_t cc (ConnectedComponent::create ());
+	(*itNode)->connectedComponent (cc);
+	cc->addNode (*itNode);
+	connectedComponents_.push_back (cc);
+      }
+      for (Edges_t::const_iterator itEdge = edges_.begin ();
+	   itEdge != edges_.end (); ++itEdge) {
+	if ((*itEdge)->status () != Edge::VALID) continue;
+	ConnectedComponentPtr_t cc1 = (*itEdge)->from ()->connectedComponent ();
+	ConnectedComponentPtr_t cc2 = (*itEdge)->to ()->connectedComponent ();
+	if (cc1 != cc2) cc1->merge (cc2);
+      }
+      // Keep the components that were not merged into another one
+      for (ConnectedComponents_t::iterator itcc =
+	     connectedComponents_.begin ();
+	   itcc != connectedComponents_.end ();) {
+	if ((*itcc)->representative () != *itcc) {
+	  itcc = connectedComponents_.erase (itcc);
+	} else {
+	  ++itcc;
+	}
+      }
+      ++goalRevision_;
+    }
+
+    void Roadmap::merge (const EdgePtr_t& edge)
+    {
       // If node connected components are different, merge them
-      ConnectedComponentPtr_t cc1 = n1->connectedComponent ();
-      ConnectedComponentPtr_t cc2 = n2->connectedComponent ();
+      ConnectedComponentPtr_t cc1 = edge->from ()->connectedComponent ();
+      ConnectedComponentPtr_t cc2 = edge->to ()->connectedComponent ();
       if (cc1 != cc2) {
 	cc1->merge (cc2);
-	//nearestNeighbor_ [cc1]->merge (nearestNeighbor_ [cc2]);
-	kdTree_.merge(cc1, cc2);
+	nearestNeighbor ()->merge (cc1, cc2);
+	++goalRevision_;
 	// Remove cc2 from list of connected components
 	ConnectedComponents_t::iterator itcc =
 	  std::find (connectedComponents_.begin (), connectedComponents_.end (),
@@ -210,7 +503,6 @@ namespace hpp {
 	//assert (itnear != nearestNeighbor_.end ());
 	//nearestNeighbor_.erase (itnear);
       }
-      return edge;
     }
 
     void Roadmap::addConnectedComponent (const NodePtr_t& node)
@@ -219,9 +511,254 @@ namespace hpp {
       //nearestNeighbor_ [node->connectedComponent ()] =
 	//NearestNeighborPtr_t (new NearestNeighbor (distance_));
       node->connectedComponent ()->addNode (node);
-      //nearestNeighbor_ [node->connectedComponent ()]->add (node);
-      kdTree_.addNode(node);
+      nearestNeighbor ()->addNode (node);
+    }
+
+    void Roadmap::nearestNeighbor
+    (const NearestNeighborSearchPtr_t& nearestNeighbor)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      nearestNeighbor->clear ();
+      nearestNeighbor->addNodes (nodes_);
+      nearestNeighbor_ = nearestNeighbor;
+      nearestNeighborOutdated_ = false;
+    }
+
+    void Roadmap::updateNearestNeighbor () const
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      if (!nearestNeighborOutdated_) return;
+      nearestNeighbor_->clear ();
+      nearestNeighbor_->addNodes (nodes_);
+      nearestNeighborOutdated_ = false;
+    }
+
+    void Roadmap::save (const std::string& filename) const
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      // Node and component indices are stored on 32 bits
+      const std::size_t maxIndex = std::numeric_limits <uint32_t>::max ();
+      if (nodes_.size () > maxIndex ||
+	  connectedComponents_.size () > maxIndex) {
+	throw std::runtime_error ("Too many nodes to save roadmap in " +
+				  filename);
+      }
+      RoadmapHeader header;
+      std::memcpy (header.magic, roadmapMagic, sizeof (roadmapMagic));
+      header.version = roadmapVersion;
+      header.configSize = robot_->configSize ();
+      header.nbNodes = nodes_.size ();
+      header.nbComponents = connectedComponents_.size ();
+      header.nbEdges = edges_.size ();
+      std::ofstream file (filename.c_str (),
+			  std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!file) {
+	throw std::runtime_error ("Cannot write roadmap file " + filename);
+      }
+      file.write (reinterpret_cast <const char*> (&header), sizeof (header));
+      for (Nodes_t::const_iterator itNode = nodes_.begin ();
+	   itNode != nodes_.end (); ++itNode) {
+	file.write (reinterpret_cast <const char*>
+		    ((*itNode)->configuration ()->data ()),
+		    header.configSize * sizeof (double));
+      }
+      std::map <ConnectedComponentPtr_t, uint32_t> componentIndex;
+      for (ConnectedComponents_t::const_iterator itcc =
+	     connectedComponents_.begin ();
+	   itcc != connectedComponents_.end (); ++itcc) {
+	uint32_t index = componentIndex.size ();
+	componentIndex [*itcc] = index;
+      }
+      for (Nodes_t::const_iterator itNode = nodes_.begin ();
+	   itNode != nodes_.end (); ++itNode) {
+	uint32_t index = componentIndex [(*itNode)->connectedComponent ()];
+	file.write (reinterpret_cast <const char*> (&index), sizeof (index));
+      }
+      for (Edges_t::const_iterator itEdge = edges_.begin ();
+	   itEdge != edges_.end (); ++itEdge) {
+	EdgeRecord record;
+	record.from = (*itEdge)->from ()->index ();
+	record.to = (*itEdge)->to ()->index ();
+	record.status = (*itEdge)->status ();
+	file.write (reinterpret_cast <const char*> (&record), sizeof (record));
+      }
+      if (!file) {
+	throw std::runtime_error ("Cannot write roadmap file " + filename);
+      }
     }
 
+    void Roadmap::load (const std::string& filename,
+			const SteeringMethodPtr_t& steeringMethod)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      Nodes_t newNodes;
+      read (filename, steeringMethod, true, newNodes);
+      nearestNeighborOutdated_ = !nodes_.empty ();
+    }
+
+    std::size_t Roadmap::merge (const std::string& filename,
+				const SteeringMethodPtr_t& steeringMethod,
+				const PathValidationPtr_t& pathValidation)
+    {
+      boost::recursive_mutex::scoped_lock lock (mutex_);
+      // Duplicates are looked for among the nodes of the other sources
+      updateNearestNeighbor ();
+      const std::size_t first = nodes_.size ();
+      Nodes_t newNodes;
+      read (filename, steeringMethod, false, newNodes);
+      // Valid edges of the file may link its nodes to nodes replacing
+      // duplicates: components are computed again and the nodes are
+      // inserted all together in the nearest neighbor data structure.
+      updateConnectedComponents ();
+      updateNearestNeighbor ();
+      std::size_t nbConnections = 0;
+      NearestNodes_t nearest;
+      for (Nodes_t::const_iterator itNode = newNodes.begin ();
+	   itNode != newNodes.end (); ++itNode) {
+	const NodePtr_t& node (*itNode);
+	nearestNodes (node->configuration (), nearest);
+	for (NearestNodes_t::const_iterator itNearest = nearest.begin ();
+	     itNearest != nearest.end (); ++itNearest) {
+	  NodePtr_t other = itNearest->second.first;
+	  // Connect to nodes of the other sources only, components merge
+	  // as connections are added.
+	  if (!other || other->index () >= first ||
+	      other->connectedComponent () == node->connectedComponent ())
+	    continue;
+	  PathPtr_t path = (*steeringMethod) (*(node->configuration ()),
+					      *(other->configuration ()));
+	  if (pathValidation->isValid (path)) {
+	    addEdges (node, other, path);
+	    ++nbConnections;
+	  }
+	}
+      }
+      hppDout (info, "merged " << newNodes.size () << " nodes from "
+	       << filename << ", " << nbConnections << " connections");
+      return nbConnections;
+    }
+
+    void Roadmap::read (const std::string& filename,
+			const SteeringMethodPtr_t& steeringMethod,
+			bool replace, Nodes_t& newNodes)
+    {
+      MappedFile mapping (filename);
+      if (mapping.size < sizeof (RoadmapHeader)) {
+	throw std::runtime_error ("Invalid roadmap file " + filename);
+      }
+      RoadmapHeader header;
+      std::memcpy (&header, mapping.data, sizeof (header));
+      if (std::memcmp (header.magic, roadmapMagic, sizeof (roadmapMagic)) != 0
+	  || header.version != roadmapVersion) {
+	throw std::runtime_error ("Invalid roadmap file " + filename);
+      }
+      if ((size_type) header.configSize != robot_->configSize ()) {
+	throw std::runtime_error ("Roadmap file " + filename +
+				  " does not match robot configuration size");
+      }
+      // Counts are compared to the size of the file before being
+      // multiplied, so that products cannot overflow.
+      std::size_t remaining = mapping.size - sizeof (header);
+      const std::size_t nodeBytes =
+	header.configSize * sizeof (double) + sizeof (uint32_t);
+      if (header.nbNodes > remaining / nodeBytes ||
+	  header.nbComponents > header.nbNodes) {
+	throw std::runtime_error ("Invalid roadmap file " + filename);
+      }
+      const std::size_t configBytes =
+	header.nbNodes * header.configSize * sizeof (double);
+      const std::size_t componentBytes = header.nbNodes * sizeof (uint32_t);
+      remaining -= configBytes + componentBytes;
+      if (header.nbEdges > remaining / sizeof (EdgeRecord) ||
+	  remaining != header.nbEdges * sizeof (EdgeRecord)) {
+	throw std::runtime_error ("Invalid roadmap file " + filename);
+      }
+      const std::size_t edgeBytes = header.nbEdges * sizeof (EdgeRecord);
+      const char* configs = mapping.data + sizeof (header);
+      const char* components = configs + configBytes;
+      const char* edges = components + componentBytes;
+      // Indices are checked before the roadmap is modified
+      for (std::size_t i=0; i < header.nbNodes; ++i) {
+	uint32_t cc;
+	std::memcpy (&cc, components + i * sizeof (cc), sizeof (cc));
+	if (cc >= header.nbComponents) {
+	  throw std::runtime_error ("Invalid roadmap file " + filename);
+	}
+      }
+      for (std::size_t i=0; i < header.nbEdges; ++i) {
+	EdgeRecord record;
+	std::memcpy (&record, edges + i * sizeof (record), sizeof (record));
+	if (record.from >= header.nbNodes || record.to >= header.nbNodes ||
+	    record.status > Edge::INVALID) {
+	  throw std::runtime_error ("Invalid roadmap file " + filename);
+	}
+      }
+
+      if (replace) clear ();
+      // Nodes of lower index were in the roadmap before
+      const std::size_t first = nodes_.size ();
+      std::vector <ConnectedComponentPtr_t> ccs (header.nbComponents);
+      for (std::size_t i=0; i < ccs.size (); ++i) {
+	ccs [i] = ConnectedComponent::create ();
+	connectedComponents_.push_back (ccs [i]);
+      }
+      // Nodes are also stored by index to create edges
+      std::vector <NodePtr_t> nodes (header.nbNodes);
+      for (std::size_t i=0; i < nodes.size (); ++i) {
+	uint32_t cc;
+	std::memcpy (&cc, components + i * sizeof (cc), sizeof (cc));
+	ConfigurationPtr_t config (new Configuration_t (header.configSize));
+	std::memcpy (config->data (),
+		     configs + i * header.configSize * sizeof (double),
+		     header.configSize * sizeof (double));
+	if (!replace) {
+	  // Nodes of the file already in the roadmap, as the initial node
+	  // of several sources, are replaced by the node of the roadmap.
+	  value_type distance;
+	  nodes [i] = nearestNeighbor_->nearestWithinRadius
+	    (config, ConnectedComponentPtr_t (), 1e-4, distance);
+	  if (nodes [i]) continue;
+	}
+	nodes [i] = nodePool_->construct (config, ccs [cc]);
+	nodes [i]->index (nodes_.size ());
+	nodes_.push_back (nodes [i]);
+	ccs [cc]->addNode (nodes [i]);
+	newNodes.push_back (nodes [i]);
+      }
+      EdgePtr_t previous = 0x0;
+      for (std::size_t i=0; i < header.nbEdges; ++i) {
+	EdgeRecord record;
+	std::memcpy (&record, edges + i * sizeof (record), sizeof (record));
+	NodePtr_t n1 = nodes [record.from];
+	NodePtr_t n2 = nodes [record.to];
+	// Both nodes may have been replaced by the same node, or by nodes
+	// already linked
+	if (n1 == n2) continue;
+	if (n1->index () < first && n2->index () < first) {
+	  bool linked = false;
+	  for (Node::Edges_t::const_iterator itOut = n1->outEdges ().begin ();
+	       itOut != n1->outEdges ().end () && !linked; ++itOut) {
+	    linked = (*itOut)->to () == n2;
+	  }
+	  if (linked) continue;
+	}
+	EdgePtr_t edge;
+	// Pairs of edges are saved consecutively, the second one shares the
+	// path of the first one.
+	if (previous && !previous->reversed () &&
+	    previous->from () == n2 && previous->to () == n1) {
+	  edge = edgePool_->construct (previous);
+	} else {
+	  PathPtr_t path = (*steeringMethod) (*(n1->configuration ()),
+					      *(n2->configuration ()));
+	  edge = edgePool_->construct (n1, n2, path);
+	}
+	edge->status ((Edge::Status) record.status);
+	n1->addOutEdge (edge);
+	n2->addInEdge (edge);
+	edges_.push_back (edge);
+	previous = edge;
+      }
+    }
   } //   namespace core
 } // namespace hpp
@@ -0,0 +1,205 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <hpp/util/debug.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/rrt-connect-planner.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method.hh>
+#include "basic-configuration-shooter.hh"
+
+namespace hpp {
+  namespace core {
+    extern std::string displayConfig (ConfigurationIn_t q);
+
+    RrtConnectPlannerPtr_t RrtConnectPlanner::createWithRoadmap
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      RrtConnectPlanner* ptr = new RrtConnectPlanner (problem, roadmap);
+      return RrtConnectPlannerPtr_t (ptr);
+    }
+
+    RrtConnectPlannerPtr_t RrtConnectPlanner::create (const Problem& problem)
+    {
+      RrtConnectPlanner* ptr = new RrtConnectPlanner (problem);
+      return RrtConnectPlannerPtr_t (ptr);
+    }
+
+    RrtConnectPlanner::RrtConnectPlanner (const Problem& problem):
+      PathPlanner (problem),
+      configurationShooter_ (new BasicConfigurationShooter
+			     (problem.robot (),
+			      problem.randomGenerator ()->split ())),
+      qProj_ (problem.robot ()->configSize ()),
+      qRand_ (new Configuration_t (problem.robot ()->configSize ())),
+      growStart_ (true), goalIndex_ (0)
+    {
+    }
+
+    RrtConnectPlanner::RrtConnectPlanner (const Problem& problem,
+					  const RoadmapPtr_t& roadmap) :
+      PathPlanner (problem, roadmap),
+      configurationShooter_ (new BasicConfigurationShooter
+			     (problem.robot (),
+			      problem.randomGenerator ()->split ())),
+      qProj_ (problem.robot ()->configSize ()),
+      qRand_ (new Configuration_t (problem.robot ()->configSize ())),
+      growStart_ (true), goalIndex_ (0)
+    {
+    }
+
+    PathPtr_t RrtConnectPlanner::extend (const NodePtr_t& near,
+					 const ConfigurationPtr_t& target)
+    {
+      const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
+      const ConstraintSetPtr_t& constraints (sm->constraints ());
+      if (constraints) {
+	bool projected;
+	{
+	  Statistics::Timer timer (timers (), Statistics::PROJECTION);
+	  ConfigProjectorPtr_t configProjector
+	    (constraints->configProjector ());
+	  if (configProjector) {
+	    configProjector->projectOnKernel (*(near->configuration ()),
+					      *target, qProj_);
+	  } else {
+	    qProj_ = *target;
+	  }
+	  projected = constraints->apply (qProj_);
+	}
+	if (!projected) return PathPtr_t ();
+	Statistics::Timer timer (timers (), Statistics::STEERING);
+	return (*sm) (*(near->configuration ()), qProj_);
+      }
+      Statistics::Timer timer (timers (), Statistics::STEERING);
+      return (*sm) (*(near->configuration ()), *target);
+    }
+
+    NodePtr_t RrtConnectPlanner::connect (const ConnectedComponentPtr_t& cc,
+					  const ConfigurationPtr_t& target,
+					  const NodePtr_t& targetNode,
+					  bool& reached)
+    {
+      reached = false;
+      value_type distance;
+      NodePtr_t near;
+      {
+	Statistics::Timer timer (timers (), Statistics::NEAREST_NEIGHBOR);
+	near = roadmap ()->nearestNode (target, cc, distance);
+      }
+      if (!near) return 0x0;
+      PathPtr_t path;
+      if (targetNode) {
+	// The target node satisfies the constraints, if any
+	Statistics::Timer timer (timers (), Statistics::STEERING);
+	path = (*(problem ().steeringMethod ())) (*(near->configuration ()),
+						  *target);
+      } else {
+	path = extend (near, target);
+      }
+      if (!path) return 0x0;
+      PathPtr_t validPath;
+      bool pathValid;
+      {
+	Statistics::Timer timer (timers (), Statistics::COLLISION_CHECKING);
+	pathValid = problem ().pathValidation ()->validate
+	  (path, false, validPath);
+      }
+      if (pathValid && targetNode) {
+	roadmap ()->addEdges (near, targetNode, path);
+	reached = true;
+	return targetNode;
+      }
+      value_type t_final = validPath->timeRange ().second;
+      if (t_final == path->timeRange ().first) return 0x0;
+      ConfigurationPtr_t q_new (new Configuration_t ((*validPath) (t_final)));
+      reached = pathValid;
+      // Nodes of the roadmap reached by the extension are handled above:
+      // q_new is not in the roadmap.
+      return roadmap ()->addNodeAndEdge (near, q_new, validPath, false);
+    }
+
+    void RrtConnectPlanner::oneStep ()
+    {
+      {
+	Statistics::Timer timer (timers (), Statistics::SHOOTING);
+	configurationShooter_->shoot (*qRand_);
+      }
+      hppDout (info, "q_rand = " << displayConfig (*qRand_));
+      const Nodes_t& goalNodes (roadmap ()->goalNodes ());
+      if (goalNodes.empty ()) return;
+      NodePtr_t initNode (roadmap ()->initNode ());
+      // Tree grown toward the random configuration
+      ConnectedComponentPtr_t grown;
+      if (growStart_) {
+	grown = initNode->connectedComponent ();
+      } else {
+	goalIndex_ = goalIndex_ % goalNodes.size ();
+	Nodes_t::const_iterator itGoal = goalNodes.begin ();
+	std::advance (itGoal, goalIndex_);
+	grown = (*itGoal)->connectedComponent ();
+	++goalIndex_;
+      }
+      const bool startGrown = growStart_;
+      growStart_ = !growStart_;
+      bool reached;
+      NodePtr_t newNode = connect (grown, qRand_, 0x0, reached);
+      if (!newNode) return;
+      // Extend the other trees toward the new node
+      if (!startGrown) {
+	connect (initNode->connectedComponent (), newNode->configuration (),
+		 newNode, reached);
+	return;
+      }
+      std::vector <ConnectedComponentPtr_t> visited;
+      for (Nodes_t::const_iterator itGoal = goalNodes.begin ();
+	   itGoal != goalNodes.end (); ++itGoal) {
+	ConnectedComponentPtr_t cc ((*itGoal)->connectedComponent ());
+	if (cc == newNode->connectedComponent () ||
+	    std::find (visited.begin (), visited.end (), cc) != visited.end ()) {
+	  continue;
+	}
+	visited.push_back (cc);
+	connect (cc, newNode->configuration (), newNode, reached);
+	if (reached) return;
+      }
+    }
+
+    PathVectorPtr_t RrtConnectPlanner::finishSolve
+    (const PathVectorPtr_t& path)
+    {
+      return path;
+    }
+
+    void RrtConnectPlanner::configurationShooter
+    (const ConfigurationShooterPtr_t& shooter)
+    {
+      configurationShooter_ = shooter;
+    }
+  } // namespace core
+} // namespace hpp
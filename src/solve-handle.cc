@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <hpp/util/debug.hh>
+#include <hpp/core/plan-and-optimize.hh>
+#include <hpp/core/solve-handle.hh>
+
+namespace hpp {
+  namespace core {
+    SolveHandlePtr_t SolveHandle::create
+    (const PlanAndOptimizePtr_t& planner, value_type timeout,
+     std::size_t maxIterations,
+     const PlanAndOptimize::PathCallback_t& callback)
+    {
+      SolveHandle* ptr = new SolveHandle (planner, timeout, maxIterations,
+					  callback);
+      SolveHandlePtr_t shPtr (ptr);
+      ptr->start ();
+      return shPtr;
+    }
+
+    SolveHandle::SolveHandle (const PlanAndOptimizePtr_t& planner,
+			      value_type timeout,
+			      std::size_t maxIterations,
+			      const PlanAndOptimize::PathCallback_t&
+			      callback) :
+      planner_ (planner), timeout_ (timeout), maxIterations_ (maxIterations),
+      callback_ (callback), thread_ (), mutex_ (), finished_ (), state_ (PLANNING),
+      status_ (PathPlanner::SUCCESS), paths_ (),
+      error_ (),
+      start_ (Statistics::now ()), end_ (0), statistics_ ()
+    {
+      planner_->pathCallback (boost::bind (&SolveHandle::publish, this, _1));
+    }
+
+    SolveHandle::~SolveHandle ()
+    {
+      if (thread_.joinable ()) {
+	cancel ();
+	thread_.join ();
+      }
+      planner_->pathCallback (PlanAndOptimize::PathCallback_t ());
+    }
+
+    void SolveHandle::start ()
+    {
+      thread_ = boost::thread (boost::bind (&SolveHandle::run, this));
+    }
+
+    void SolveHandle::run ()
+    {
+      PathPlanner::Status status = PathPlanner::INTERRUPTED;
+      std::string error;
+      // The planner keeps an interruption sent before the resolution starts.
+      try {
+	PathVectorPtr_t path;
+	status = planner_->solve (timeout_, maxIterations_, path);
+      } catch (const std::exception& exc) {
+	hppDout (error, exc.what ());
+	error = exc.what ();
+      }
+      Statistics statistics (planner_->statistics ());
+      boost::mutex::scoped_lock lock (mutex_);
+      status_ = status;
+      error_ = error;
+      statistics_ = statistics;
+      end_ = Statistics::now ();
+      state_ = FINISHED;
+      finished_.notify_all ();
+    }
+
+    void SolveHandle::publish (const PathVectorPtr_t& path)
+    {
+      if (callback_) callback_ (path);
+      boost::mutex::scoped_lock lock (mutex_);
+      paths_.push_back (path);
+      state_ = OPTIMIZING;
+    }
+
+    SolveHandle::State SolveHandle::state () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return state_;
+    }
+
+    PathPlanner::Status SolveHandle::wait ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      while (state_ != FINISHED) {
+	finished_.wait (lock);
+      }
+      if (!error_.empty ()) throw std::runtime_error (error_);
+      return status_;
+    }
+
+    bool SolveHandle::waitFor (value_type timeout)
+    {
+      boost::system_time deadline = boost::get_system_time () +
+	boost::posix_time::microseconds ((long) (timeout * 1e6));
+      boost::mutex::scoped_lock lock (mutex_);
+      while (state_ != FINISHED) {
+	if (!finished_.timed_wait (lock, deadline)) break;
+      }
+      return state_ == FINISHED;
+    }
+
+    void SolveHandle::cancel ()
+    {
+      planner_->interrupt ();
+    }
+
+    PathVectorPtr_t SolveHandle::plannedPath () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      if (paths_.empty ()) return PathVectorPtr_t ();
+      return paths_.front ();
+    }
+
+    PathVectorPtr_t SolveHandle::bestPath () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      if (paths_.empty ()) return PathVectorPtr_t ();
+      return paths_.back ();
+    }
+
+    PathVectors_t SolveHandle::paths () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return paths_;
+    }
+
+    value_type SolveHandle::elapsed () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      uint64_t end = state_ == FINISHED ? end_ : Statistics::now ();
+      return 1e-9 * (value_type) (end - start_);
+    }
+
+    const Statistics& SolveHandle::statistics () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      if (state_ != FINISHED) {
+	throw std::runtime_error ("Resolution is not finished.");
+      }
+      return statistics_;
+    }
+  } // namespace core
+} // namespace hpp
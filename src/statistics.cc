@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <ostream>
+#include <time.h>
+#include <hpp/core/statistics.hh>
+
+namespace hpp {
+  namespace core {
+    void Statistics::reset ()
+    {
+      for (std::size_t i = 0; i < NB_PHASES; ++i) {
+	nanoseconds_ [i] = 0;
+	calls_ [i] = 0;
+      }
+      for (std::size_t i = 0; i < NB_COUNTERS; ++i) {
+	counts_ [i] = 0;
+      }
+    }
+
+    Statistics& Statistics::operator+= (const Statistics& other)
+    {
+      for (std::size_t i = 0; i < NB_PHASES; ++i) {
+	nanoseconds_ [i] += other.nanoseconds_ [i];
+	calls_ [i] += other.calls_ [i];
+      }
+      for (std::size_t i = 0; i < NB_COUNTERS; ++i) {
+	counts_ [i] += other.counts_ [i];
+      }
+      return *this;
+    }
+
+    const char* Statistics::name (Phase phase)
+    {
+      static const char* names [NB_PHASES] = {
+	"shooting", "nearest neighbor", "steering", "projection",
+	"collision checking", "graph search", "optimization"
+      };
+      return names [phase];
+    }
+
+    const char* Statistics::name (Counter counter)
+    {
+      static const char* names [NB_COUNTERS] = {
+	"nearest neighbor visits", "nearest neighbor distances",
+	"projection iterations", "projection failures", "collision samples"
+      };
+      return names [counter];
+    }
+
+    uint64_t Statistics::now ()
+    {
+      timespec time;
+      clock_gettime (CLOCK_MONOTONIC, &time);
+      return (uint64_t) time.tv_sec * 1000000000u + time.tv_nsec;
+    }
+
+    std::ostream& operator<< (std::ostream& os, const Statistics& statistics)
+    {
+      for (std::size_t i = 0; i < Statistics::NB_PHASES; ++i) {
+	Statistics::Phase phase = (Statistics::Phase) i;
+	os << Statistics::name (phase) << ": "
+	   << statistics.nanoseconds (phase) * 1e-9 << "s, "
+	   << statistics.calls (phase) << " calls" << std::endl;
+      }
+      for (std::size_t i = 0; i < Statistics::NB_COUNTERS; ++i) {
+	Statistics::Counter counter = (Statistics::Counter) i;
+	os << Statistics::name (counter) << ": "
+	   << statistics.count (counter) << std::endl;
+      }
+      return os;
+    }
+  } // namespace core
+} // namespace hpp
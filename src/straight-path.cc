@@ -33,13 +33,37 @@ namespace hpp {
       device_ (device), initial_ (init), end_ (end)
     {
       assert (length >= 0);
+      computeInterpolation ();
     }
 
     StraightPath::StraightPath (const StraightPath& path) :
-      parent_t (path), initial_ (path.initial_), end_ (path.end_)
+      parent_t (path), device_ (path.device_), initial_ (path.initial_),
+      end_ (path.end_), delta_ (path.delta_), joints_ (path.joints_)
     {
     }
 
+    void StraightPath::computeInterpolation ()
+    {
+      delta_ = vector_t::Zero (initial_.size ());
+      joints_.clear ();
+      const JointVector_t& jv (device_->getJointVector ());
+      for (model::JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); itJoint++) {
+	size_type rank = (*itJoint)->rankInConfiguration ();
+	size_type size = (*itJoint)->configSize ();
+	if (size == 0) continue;
+	// Translations and bounded rotations are interpolated linearly
+	if (dynamic_cast <model::JointTranslation*> (*itJoint) ||
+	    (size == 1 && (*itJoint)->numberDof () == 1 &&
+	     (*itJoint)->isBounded (0))) {
+	  delta_.segment (rank, size) =
+	    end_.segment (rank, size) - initial_.segment (rank, size);
+	} else {
+	  joints_.push_back (std::make_pair (*itJoint, rank));
+	}
+      }
+    }
+
     void StraightPath::impl_compute (ConfigurationOut_t result,
 				     value_type param) const
     {
@@ -54,13 +78,12 @@ namespace hpp {
       value_type u = param/timeRange ().second;
       if (timeRange ().second == 0)
 	u = 0;
-      // Loop over device joint and interpolate
-      const JointVector_t& jv (device_->getJointVector ());
-      for (model::JointVector_t::const_iterator itJoint = jv.begin ();
-	   itJoint != jv.end (); itJoint++) {
-	std::size_t rank = (*itJoint)->rankInConfiguration ();
-	(*itJoint)->configuration ()->interpolate
-	  (initial_, end_, u, rank, result);
+      // Linear degrees of freedom, then other joints
+      result = initial_ + u * delta_;
+      for (JointInterpolations_t::const_iterator itJoint = joints_.begin ();
+	   itJoint != joints_.end (); itJoint++) {
+	itJoint->first->configuration ()->interpolate
+	  (initial_, end_, u, itJoint->second, result);
       }
     }
     PathPtr_t StraightPath::extract (const interval_t& subInterval) const
@@ -72,6 +95,7 @@ namespace hpp {
       Configuration_t q2 ((*this) (subInterval.second));
       PathPtr_t result = StraightPath::create (device_, q1, q2, l);
       result->constraints (this->constraints ());
+      result->warmStart (warmStart ());
       return result;
     }
 
@@ -22,6 +22,7 @@
 #include <hpp/model/joint-configuration.hh>
 #include <hpp/core/weighed-distance.hh>
 #include <Eigen/SVD>
+#include "fixed-size-kernels.hh"
 
 namespace hpp {
   namespace core {
@@ -67,6 +68,7 @@ namespace hpp {
 
     value_type WeighedDistance::getWeight( int rank ) const
     {
+      assert (rank >= 0 && (std::size_t) rank < weights_.size ());
       return weights_[rank];
     }
 
@@ -75,6 +77,7 @@ namespace hpp {
       if ( rank < weights_.size() ) 
       {
 	weights_[rank] = weight;
+	computeDistanceTable ();
       }
       else { throw std::runtime_error("Distance::setWeight : rank is out of range"); }
     } 
@@ -118,20 +121,52 @@ namespace hpp {
 	}
       }
       hppDout (info, "weight_ " << weights_);
+      computeDistanceTable ();
     }
 
     WeighedDistance::WeighedDistance (const DevicePtr_t& robot,
 				      const std::vector <value_type>& weights) :
       robot_ (robot), weights_ (weights)
     {
+      computeDistanceTable ();
     }
 
     WeighedDistance::WeighedDistance (const WeighedDistance& distance) :
       robot_ (distance.robot_),
-      weights_ (distance.weights_)
+      weights_ (distance.weights_),
+      squaredWeights_ (distance.squaredWeights_),
+      fixedSize_ (distance.fixedSize_),
+      joints_ (distance.joints_)
     {
     }
 
+    void WeighedDistance::computeDistanceTable ()
+    {
+      squaredWeights_ = vector_t::Zero (robot_->configSize ());
+      fixedSize_ = fixedSize (robot_->configSize ());
+      joints_.clear ();
+      std::size_t i=0;
+      const JointVector_t& jointVector (robot_->getJointVector ());
+      for (JointVector_t::const_iterator itJoint = jointVector.begin ();
+	   itJoint != jointVector.end (); itJoint++) {
+	if ((*itJoint)->numberDof () != 0) {
+	  size_type rank = (*itJoint)->rankInConfiguration ();
+	  // Same test as KDTree for linear dimensions
+	  if ((*itJoint)->configSize () == 1 &&
+	      (*itJoint)->numberDof () == 1 && (*itJoint)->isBounded (0)) {
+	    squaredWeights_ [rank] = weights_ [i] * weights_ [i];
+	  } else {
+	    JointDistance_t joint;
+	    joint.joint = *itJoint;
+	    joint.rank = rank;
+	    joint.weight = i;
+	    joints_.push_back (joint);
+	  }
+	  ++i;
+	}
+      }
+    }
+
     void WeighedDistance::init (WeighedDistanceWkPtr_t self)
     {
       weak_ = self;
@@ -140,22 +175,62 @@ namespace hpp {
     value_type WeighedDistance::impl_distance (ConfigurationIn_t q1,
 					       ConfigurationIn_t q2)
     {
-      // Loop over robot joint and interpolate
-      value_type res = 0;
-      std::size_t i=0;
-      const JointVector_t jointVector (robot_->getJointVector ());
-      for (JointVector_t::const_iterator itJoint = jointVector.begin ();
-	   itJoint != jointVector.end (); itJoint++) {
-	if ((*itJoint)->numberDof () != 0) {
-	  value_type length = weights_ [i];
-	  value_type distance =
-	    (*itJoint)->configuration ()->distance
-	    (q1, q2, (*itJoint)->rankInConfiguration ());
-	  res += length * length * distance * distance;
-	  ++i;
+      return sqrt (impl_squaredDistance (q1, q2));
+    }
+
+    value_type WeighedDistance::impl_squaredDistance (ConfigurationIn_t q1,
+						      ConfigurationIn_t q2)
+    {
+      value_type res = weighedSquaredNorm ((FixedSize_t) fixedSize_,
+					   squaredWeights_, q1, q2);
+      for (JointDistances_t::const_iterator itJoint = joints_.begin ();
+	   itJoint != joints_.end (); itJoint++) {
+	value_type length = weights_ [itJoint->weight];
+	value_type distance =
+	  itJoint->joint->configuration ()->distance (q1, q2, itJoint->rank);
+	res += length * length * distance * distance;
+      }
+      return res;
+    }
+
+    bool WeighedDistance::impl_distanceBelow (ConfigurationIn_t q1,
+					      ConfigurationIn_t q2,
+					      value_type bound,
+					      value_type& distance)
+    {
+      // Partial sums are lower bounds of the squared distance
+      value_type squaredBound = bound * bound;
+      value_type res = weighedSquaredNorm ((FixedSize_t) fixedSize_,
+					   squaredWeights_, q1, q2);
+      if (res > squaredBound) return false;
+      for (JointDistances_t::const_iterator itJoint = joints_.begin ();
+	   itJoint != joints_.end (); itJoint++) {
+	value_type length = weights_ [itJoint->weight];
+	value_type d =
+	  itJoint->joint->configuration ()->distance (q1, q2, itJoint->rank);
+	res += length * length * d * d;
+	if (res > squaredBound) return false;
+      }
+      distance = sqrt (res);
+      return distance <= bound;
+    }
+
+    void WeighedDistance::impl_distances (ConfigurationIn_t q,
+					  matrixIn_t configurations,
+					  vectorOut_t distances)
+    {
+      weighedSquaredNorms ((FixedSize_t) fixedSize_, squaredWeights_, q,
+			   configurations, distances);
+      for (JointDistances_t::const_iterator itJoint = joints_.begin ();
+	   itJoint != joints_.end (); itJoint++) {
+	value_type length = weights_ [itJoint->weight];
+	for (size_type j=0; j < configurations.cols (); ++j) {
+	  value_type distance = itJoint->joint->configuration ()->distance
+	    (q, configurations.col (j), itJoint->rank);
+	  distances [j] += length * length * distance * distance;
 	}
       }
-      return sqrt (res);
+      distances = distances.array ().sqrt ();
     }
   } //   namespace core
 } // namespace hpp
@@ -0,0 +1,214 @@
+// Copyright (C) 2014 LAAS-CNRS
+// Author: Florent Lamiraux
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+// Robot and worlds shared by the tests of the planners. Each test includes
+// this file once, after the sources it tests.
+
+#ifndef HPP_CORE_TESTS_PLANE_WORLD_HH
+# define HPP_CORE_TESTS_PLANE_WORLD_HH
+
+# include <cmath>
+# include <vector>
+
+# include <hpp/model/device.hh>
+# include <hpp/model/joint.hh>
+# include <hpp/core/path.hh>
+# include <hpp/core/path-validation.hh>
+# include <hpp/core/path-vector.hh>
+# include <hpp/core/problem.hh>
+# include <hpp/core/random-generator.hh>
+# include <hpp/core/statistics.hh>
+# include "../src/discretization.hh"
+
+namespace hpp {
+  namespace core {
+    namespace test {
+      using model::Device;
+      using model::JointTranslation;
+      using model::Transform3f;
+
+      /// Build a robot with bounded translations in [-3,3]
+      inline DevicePtr_t createRobot (std::size_t nbTranslations = 2)
+      {
+	DevicePtr_t robot = Device::create("robot");
+	for (std::size_t i=0; i<nbTranslations; ++i) {
+	  JointPtr_t joint = new JointTranslation(Transform3f());
+	  joint->isBounded(0,1);
+	  joint->lowerBound(0,-3.);
+	  joint->upperBound(0,3.);
+	  if (i == 0) robot->rootJoint(joint);
+	  else robot->registerJoint(joint);
+	}
+	return robot;
+      }
+
+      /// Plane worlds of [-3,3]x[-3,3]: an open world with a square
+      /// obstacle in the middle and a world with two walls forming a zigzag
+      /// between the initial and goal configurations.
+      inline bool& zigzag ()
+      {
+	static bool value = false;
+	return value;
+      }
+
+      inline bool inCollision (ConfigurationIn_t q)
+      {
+	if (!zigzag ()) return q.cwiseAbs ().maxCoeff () < 1;
+	return (fabs (q [0] + 1) < .2 && q [1] > -2) ||
+	  (fabs (q [0] - 1) < .2 && q [1] < 2);
+      }
+
+      /// Validation of paths by discretization in a plane world, counting
+      /// collision tests. Whole paths are checked in bisection order as
+      /// DiscretizedCollisionChecking.
+      class WorldValidation : public PathValidation
+      {
+      public:
+	typedef bool (*InCollision_t) (ConfigurationIn_t q);
+
+	WorldValidation (InCollision_t collision = inCollision) :
+	  nbTests (0), collision_ (collision)
+	{
+	}
+	virtual bool validate (const PathPtr_t& path, bool reverse,
+			       PathPtr_t& validPart)
+	{
+	  const value_type step = 1e-2;
+	  interval_t range = path->timeRange ();
+	  if (reverse) std::swap (range.first, range.second);
+	  value_type sign = range.second > range.first ? 1 : -1;
+	  value_type length = fabs (range.second - range.first);
+	  value_type valid = range.first;
+	  for (value_type s = 0; ; s += step) {
+	    if (s > length) s = length;
+	    value_type t = range.first + sign * s;
+	    if (collides ((*path) (t))) {
+	      validPart = path->extract (interval_t (range.first, valid));
+	      return false;
+	    }
+	    valid = t;
+	    if (s == length) break;
+	  }
+	  validPart = path;
+	  return true;
+	}
+	virtual bool isValid (const PathPtr_t& path)
+	{
+	  std::vector <value_type> times;
+	  bisectionParameters (path->timeRange (), 1e-2, times);
+	  if (collides ((*path) (path->timeRange ().first))) return false;
+	  for (std::size_t i=0; i < times.size (); ++i) {
+	    if (collides ((*path) (times [i]))) return false;
+	  }
+	  return true;
+	}
+	/// Validation of the same world, counting its own collision tests
+	virtual PathValidationPtr_t clone (const DevicePtr_t&) const
+	{
+	  return PathValidationPtr_t (new WorldValidation (collision_));
+	}
+	std::size_t nbTests;
+      private:
+	/// Count and perform a collision test
+	bool collides (ConfigurationIn_t q)
+	{
+	  ++nbTests;
+	  ++numberSamples_;
+	  return collision_ (q);
+	}
+	InCollision_t collision_;
+      }; // class WorldValidation
+
+      typedef boost::shared_ptr <WorldValidation> WorldValidationPtr_t;
+
+      /// Resolution of the problem of the current plane world by steps
+      struct Resolution
+      {
+	/// Number of collision tests to solution, 0 if not solved
+	std::size_t nbTests;
+	/// Number of steps to solution
+	std::size_t nbSteps;
+	/// Whether the path links the initial and goal configurations and is
+	/// collision-free
+	bool validPath;
+	/// Statistics of the planner at solution
+	Statistics statistics;
+      }; // struct Resolution
+
+      /// Solve the problem of the current plane world by steps
+      /// \param seed seed of the random generator of the problem,
+      /// \param maxIterations number of steps after which the problem is
+      ///        not solved.
+      template <typename Planner>
+      Resolution solvePlaneWorld (unsigned int seed,
+				  std::size_t maxIterations = 20000)
+      {
+	DevicePtr_t robot = createRobot ();
+	Problem problem (robot);
+	problem.randomGenerator ()->seed (seed);
+	WorldValidationPtr_t validation (new WorldValidation);
+	problem.pathValidation (validation);
+	ConfigurationPtr_t qInit (new Configuration_t (2));
+	ConfigurationPtr_t qGoal (new Configuration_t (2));
+	*qInit << -2.5, 2.5;
+	*qGoal << 2.5, -2.5;
+	problem.initConfig (qInit);
+	problem.addGoalConfig (qGoal);
+	boost::shared_ptr <Planner> planner = Planner::create (problem);
+	Resolution result;
+	result.nbTests = 0;
+	result.nbSteps = 0;
+	result.validPath = false;
+	planner->startSolve ();
+	while (result.nbSteps < maxIterations) {
+	  planner->oneStep ();
+	  ++result.nbSteps;
+	  if (!planner->pathExists ()) continue;
+	  result.nbTests = validation->nbTests;
+	  PathVectorPtr_t path = planner->computePath ();
+	  result.statistics = planner->statistics ();
+	  PathPtr_t validPart;
+	  result.validPath =
+	    ((*path) (path->timeRange ().first) - *qInit).norm () < 1e-10 &&
+	    ((*path) (path->timeRange ().second) - *qGoal).norm () < 1e-10 &&
+	    validation->validate (path, false, validPart);
+	  break;
+	}
+	return result;
+      }
+
+      /// Number of collision tests to solution summed over resolutions of
+      /// the current plane world with seeds 0 to nbRuns - 1
+      /// \retval solved whether all the resolutions returned a valid path.
+      template <typename Planner>
+      std::size_t collisionTests (unsigned int nbRuns, bool& solved)
+      {
+	std::size_t result = 0;
+	solved = true;
+	for (unsigned int seed = 0; seed < nbRuns; ++seed) {
+	  Resolution resolution (solvePlaneWorld <Planner> (seed));
+	  solved = solved && resolution.nbTests > 0 && resolution.validPath;
+	  result += resolution.nbTests;
+	}
+	return result;
+      }
+    } // namespace test
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_TESTS_PLANE_WORLD_HH